@@ -0,0 +1,154 @@
+#include <nrEngine/nrEngine.h>
+#include <nrEngine/events/ResourceEvent.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace nrEngine;
+
+//----------------------------------------------------------------------
+// Resource loaded in the background by the publisher
+//----------------------------------------------------------------------
+class Tiny : public IResource{
+	public:
+		Tiny() { setResourceType("Tiny"); }
+
+		Result unloadRes(){
+			mResIsLoaded = false;
+			return OK;
+		}
+};
+
+class EmptyTiny : public Tiny{
+};
+
+class TinyLoader : public IResourceLoader{
+	public:
+		TinyLoader() { initialize(); }
+
+		Result initialize(){
+			declareSupportedResourceType("Tiny");
+			declareSupportedFileType("tiny");
+			return OK;
+		}
+
+		Result loadResource(IResource* res){
+			return OK;
+		}
+
+		IResource* createEmptyResource(const std::string& resourceType){
+			IResource* res = new EmptyTiny();
+			setResourceEmpty(res, true);
+			return res;
+		}
+
+		IResource* createResourceInstance(const std::string& resourceType, NameValuePairs* params) const{
+			return new Tiny();
+		}
+};
+
+//----------------------------------------------------------------------
+// Actor of the subscriber, does remember the first loaded event
+//----------------------------------------------------------------------
+class LoadedListener : public EventActor{
+	public:
+		LoadedListener() : EventActor("LoadedListener"), received(false) {}
+
+		void OnEvent(const EventChannel& channel, SharedPtr<Event> event){
+			if (received || !event->same_as<ResourceLoadedEvent>()) return;
+			ResourceLoadedEvent* loaded = event_cast<ResourceLoadedEvent>(event.get());
+			name = loaded->getResName();
+			result = loaded->getResult();
+			received = true;
+		}
+
+		bool received;
+		string name;
+		Result result;
+};
+
+//----------------------------------------------------------------------
+// Subscriber process, started before the publisher does exist
+//----------------------------------------------------------------------
+int subscriber(){
+	mkdir("subscriber", 0755);
+	Engine* root = new Engine();
+	root->initializeLog("subscriber/");
+	root->initializeEngine();
+
+	LoadedListener listener;
+	listener.connect(NR_RESOURCE_EVENT_CHANNEL);
+
+	SharedPtr<EventBridge> bridge(new EventBridge(NR_RESOURCE_EVENT_CHANNEL, EventBridge::SUBSCRIBE));
+	Kernel::GetSingleton().AddTask(bridge, ORDER_FIRST);
+
+	// wait at most 10 seconds
+	for (int i=0; i < 10000 && !listener.received; i++){
+		root->updateEngine();
+		usleep(1000);
+	}
+
+	bool ok = listener.received && listener.result == OK && listener.name.find("level_0/object_") == 0;
+	printf("%s: subscriber got %s\n", ok ? "OK  " : "FAIL", listener.received ? listener.name.c_str() : "nothing");
+
+	listener.disconnect(NR_RESOURCE_EVENT_CHANNEL);
+	Kernel::GetSingleton().RemoveTask(bridge->getTaskID());
+	delete root;
+	return ok ? 0 : 1;
+}
+
+//----------------------------------------------------------------------
+// Publisher process, sends the loaded events until the subscriber got one
+//----------------------------------------------------------------------
+int publisher(pid_t child){
+	Engine* root = new Engine();
+	root->initializeLog("./");
+	root->initializeEngine();
+
+	ResourceManager& rm = ResourceManager::GetSingleton();
+	rm.registerLoader("TinyLoader", ResourceLoader(new TinyLoader()));
+
+	// other geometry as the default one, the subscriber has to use it too
+	SharedPtr<EventBridge> bridge(new EventBridge(NR_RESOURCE_EVENT_CHANNEL, EventBridge::PUBLISH, 64, 256));
+	Kernel::GetSingleton().AddTask(bridge, ORDER_FIRST);
+
+	// the subscriber does only read events sent after it has mapped the ring
+	char name[64];
+	int status = -1;
+	for (int i=0; i < 10000; i++){
+		if (i % 50 == 0){
+			sprintf(name, "level_0/object_%d", i / 50);
+			rm.loadResourceAsync(name, "level_0", "Tiny", "object.tiny");
+		}
+		root->updateEngine();
+		usleep(1000);
+		if (waitpid(child, &status, WNOHANG) == child) break;
+	}
+
+	bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+	printf("%s: event was mirrored to the subscriber\n", ok ? "OK  " : "FAIL");
+
+	Kernel::GetSingleton().RemoveTask(bridge->getTaskID());
+	delete root;
+	return ok ? 0 : 1;
+}
+
+int main(){
+
+	// start with a new ring
+	shm_unlink((string("/nrEngine_") + NR_RESOURCE_EVENT_CHANNEL).c_str());
+
+	pid_t child = fork();
+	if (child == 0) return subscriber();
+
+	// let the subscriber wait for the ring
+	usleep(200000);
+	int ret = publisher(child);
+
+	shm_unlink((string("/nrEngine_") + NR_RESOURCE_EVENT_CHANNEL).c_str());
+	return ret;
+}
+
@@ -0,0 +1,142 @@
+#include <nrEngine/nrEngine.h>
+
+#include <fstream>
+
+using namespace std;
+using namespace nrEngine;
+
+//----------------------------------------------------------------------
+// Resource holding the file content in a shared payload
+//----------------------------------------------------------------------
+class Blob : public IResource{
+	public:
+		Blob() { setResourceType("Blob"); }
+
+		Result unloadRes(){
+			mData.reset();
+			mResIsLoaded = false;
+			return OK;
+		}
+
+		bool shareResPayload(IResource* source){
+			mData = dynamic_cast<Blob*>(source)->mData;
+			return true;
+		}
+
+		bool isResPayloadShareable() const { return true; }
+
+		//! Change one byte, the shared payload is copied before
+		void write(uint32 pos, byte value){
+			detachResPayload(mData);
+			(*mData)[pos] = value;
+		}
+
+		SharedPtr< vector<byte> > mData;
+};
+
+class EmptyBlob : public Blob{
+};
+
+class BlobLoader : public IResourceLoader{
+	public:
+		BlobLoader() { initialize(); }
+
+		Result initialize(){
+			declareSupportedResourceType("Blob");
+			declareSupportedFileType("blob");
+			return OK;
+		}
+
+		Result loadResource(IResource* res){
+			ifstream file(res->getResFileName().c_str(), ios::binary);
+			if (!file.good()) return FILE_NOT_FOUND;
+			Blob* blob = dynamic_cast<Blob*>(res);
+			blob->mData.reset(new vector<byte>((istreambuf_iterator<char>(file)), istreambuf_iterator<char>()));
+			return OK;
+		}
+
+		IResource* createEmptyResource(const std::string& resourceType){
+			IResource* res = new EmptyBlob();
+			setResourceEmpty(res, true);
+			return res;
+		}
+
+		IResource* createResourceInstance(const std::string& resourceType, NameValuePairs* params) const{
+			return new Blob();
+		}
+};
+
+//----------------------------------------------------------------------
+// Write a file with the given content
+//----------------------------------------------------------------------
+void writeFile(const char* name, const string& content){
+	ofstream file(name, ios::binary);
+	file << content;
+}
+
+//----------------------------------------------------------------------
+// Check a condition and count the failures
+//----------------------------------------------------------------------
+int failed = 0;
+void check(bool ok, const char* what){
+	printf("%s: %s\n", ok ? "OK  " : "FAIL", what);
+	if (!ok) failed++;
+}
+
+//----------------------------------------------------------------------
+// Two identical blobs share the payload until one of them is written
+//----------------------------------------------------------------------
+void test_blobs(ResourceManager& rm){
+	writeFile("share1.blob", "identical content");
+	writeFile("share2.blob", "identical content");
+
+	uint32 shared = rm.getCache()->getSharedCount();
+	ResourcePtr<Blob> b1 = rm.loadResource("blob1", "Share", "Blob", "share1.blob");
+	ResourcePtr<Blob> b2 = rm.loadResource("blob2", "Share", "Blob", "share2.blob");
+
+	check(rm.getCache()->getSharedCount() == shared + 1, "second blob is shared");
+	check(b1->mData == b2->mData, "blobs have the same payload");
+
+	b2->write(0, 'I');
+	check(b1->mData != b2->mData, "written blob got its own payload");
+	check((*b1->mData)[0] == 'i' && (*b2->mData)[0] == 'I', "other blob is not changed");
+}
+
+//----------------------------------------------------------------------
+// Two identical mapped files read from the same mapping
+//----------------------------------------------------------------------
+void test_mapped_files(ResourceManager& rm){
+	writeFile("share1.txt", "mapped content");
+	writeFile("share2.txt", "mapped content");
+
+	ResourcePtr<FileStream> f1 = rm.loadResource("mapped1", "Share", "MappedFile", "share1.txt");
+	ResourcePtr<FileStream> f2 = rm.loadResource("mapped2", "Share", "MappedFile", "share2.txt");
+
+	size_t c1 = 0, c2 = 0;
+	const byte* v1 = f1->getView(c1);
+	const byte* v2 = f2->getView(c2);
+	check(v1 != NULL && v1 == v2 && c1 == c2, "mapped files share the mapping");
+
+	// the mapping stays valid while it is used
+	rm.unload("mapped1");
+	v2 = f2->getView(c2);
+	check(v2 != NULL && string((const char*)v2, c2) == "mapped content", "mapping is kept after unloading the first file");
+}
+
+int main(){
+
+	Engine* root = new Engine();
+	root->initializeLog("./");
+	root->initializeEngine();
+
+	ResourceManager& rm = ResourceManager::GetSingleton();
+	rm.registerLoader("BlobLoader", ResourceLoader(new BlobLoader()));
+	rm.getCache()->setSharing(true);
+
+	test_blobs(rm);
+	test_mapped_files(rm);
+
+	delete root;
+	return failed > 0 ? 1 : 0;
+}
+
@@ -0,0 +1,92 @@
+#include <nrEngine/nrEngine.h>
+
+#include <malloc.h>
+
+using namespace std;
+using namespace nrEngine;
+
+//----------------------------------------------------------------------
+// Resource without any data, so only the bookkeeping is measured
+//----------------------------------------------------------------------
+class Tiny : public IResource{
+	public:
+		Tiny() { setResourceType("Tiny"); }
+
+		Result unloadRes(){
+			mResIsLoaded = false;
+			return OK;
+		}
+};
+
+class EmptyTiny : public Tiny{
+};
+
+class TinyLoader : public IResourceLoader{
+	public:
+		TinyLoader() { initialize(); }
+
+		Result initialize(){
+			declareSupportedResourceType("Tiny");
+			declareSupportedFileType("tiny");
+			return OK;
+		}
+
+		Result loadResource(IResource* res){
+			return OK;
+		}
+
+		IResource* createEmptyResource(const std::string& resourceType){
+			IResource* res = new EmptyTiny();
+			setResourceEmpty(res, true);
+			return res;
+		}
+
+		IResource* createResourceInstance(const std::string& resourceType, NameValuePairs* params) const{
+			return new Tiny();
+		}
+};
+
+//----------------------------------------------------------------------
+// Bytes allocated from the heap
+//----------------------------------------------------------------------
+size_t heapUsage(){
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	struct mallinfo2 info = mallinfo2();
+#else
+	struct mallinfo info = mallinfo();
+#endif
+	return info.uordblks + info.hblkhd;
+}
+
+int main(int argc, char** argv){
+
+	uint32 count = argc > 1 ? atoi(argv[1]) : 1000000;
+
+	Engine* root = new Engine();
+	root->initializeLog("./");
+	root->initializeEngine();
+
+	ResourceManager& rm = ResourceManager::GetSingleton();
+	rm.registerLoader("TinyLoader", ResourceLoader(new TinyLoader()));
+
+	// names, groups and files look like the ones of a real game
+	char name[64], group[32];
+	size_t before = heapUsage();
+	uint64 start = ResourceStatistics::getMicroseconds();
+	for (uint32 i=0; i < count; i++){
+		sprintf(name, "level_%d/object_%d", i / 1000, i);
+		sprintf(group, "level_%d", i / 1000);
+		rm.loadResource(name, group, "Tiny", "data/objects/object.tiny");
+	}
+	uint64 time = ResourceStatistics::getMicroseconds() - start;
+	size_t after = heapUsage();
+
+	printf("resources:               %d\n", count);
+	printf("size of ResourceHolder:  %d bytes\n", (int)sizeof(ResourceHolder));
+	printf("heap per resource:       %d bytes\n", (int)((after - before) / count));
+	printf("load time per resource:  %.2f us\n", (double)time / count);
+
+	delete root;
+	return 0;
+}
+
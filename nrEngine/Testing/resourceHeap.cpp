@@ -0,0 +1,190 @@
+#include <nrEngine/nrEngine.h>
+
+using namespace std;
+using namespace nrEngine;
+
+//! Blocks are big, so that one compaction step does always exceed a budget of 1us
+#define BLOCK (1024 * 1024)
+#define CHUNK (4 * BLOCK)
+
+//----------------------------------------------------------------------
+// Fill a block with a pattern depending on the seed
+//----------------------------------------------------------------------
+void fill(ResourceHeap& heap, HeapBlock block, int seed){
+	byte* data = (byte*)heap.lock(block);
+	for (size_t i=0; i < BLOCK; i++) data[i] = byte(i * 31 + seed);
+	heap.unlock(block);
+}
+
+//----------------------------------------------------------------------
+// Check the pattern of a block
+//----------------------------------------------------------------------
+bool check(ResourceHeap& heap, HeapBlock block, int seed){
+	byte* data = (byte*)heap.lock(block);
+	bool ok = data != NULL;
+	for (size_t i=0; ok && i < BLOCK; i++) ok = data[i] == byte(i * 31 + seed);
+	heap.unlock(block);
+	return ok;
+}
+
+//----------------------------------------------------------------------
+// Allocated blocks get their own memory, freed blocks are invalid
+//----------------------------------------------------------------------
+bool testAllocate(){
+	ResourceHeap heap(CHUNK);
+	HeapBlock b[4];
+	for (int i=0; i < 4; i++){
+		b[i] = heap.allocate(BLOCK);
+		fill(heap, b[i], i);
+	}
+
+	bool ok = heap.getFootprint() == CHUNK && heap.getUsedBytes() == CHUNK;
+	for (int i=0; i < 4; i++) ok = ok && check(heap, b[i], i) && heap.getSize(b[i]) == BLOCK;
+
+	// the next block does not fit into the first chunk
+	HeapBlock e = heap.allocate(1);
+	ok = ok && heap.getFootprint() == 2 * CHUNK;
+
+	heap.free(e);
+	heap.free(b[0]);
+	ok = ok && heap.lock(b[0]) == NULL && heap.getSize(b[0]) == 0;
+	ok = ok && heap.getUsedBytes() == 3 * BLOCK && heap.trim() == CHUNK && heap.getFootprint() == CHUNK;
+
+	for (int i=1; i < 4; i++) heap.free(b[i]);
+	printf("%s: allocate, free and trim\n", ok ? "OK  " : "FAIL");
+	return ok;
+}
+
+//----------------------------------------------------------------------
+// The last block of a chunk is moved into the free space of an other
+// chunk, the emptied chunk is released
+//----------------------------------------------------------------------
+bool testMoveBetweenChunks(){
+	ResourceHeap heap(CHUNK);
+	HeapBlock b[5];
+	for (int i=0; i < 5; i++){
+		b[i] = heap.allocate(BLOCK);
+		fill(heap, b[i], i);
+	}
+	for (int i=0; i < 3; i++) heap.free(b[i]);
+
+	bool ok = heap.getFootprint() == 2 * CHUNK && heap.getUsedBytes() == 2 * BLOCK;
+	heap.compact(0);
+	ok = ok && heap.getFootprint() == CHUNK && heap.getOverhead() == CHUNK - 2 * BLOCK;
+	ok = ok && check(heap, b[3], 3) && check(heap, b[4], 4);
+
+	// b[3] is placed behind b[4]
+	byte* p3 = (byte*)heap.lock(b[3]);
+	byte* p4 = (byte*)heap.lock(b[4]);
+	ok = ok && p3 == p4 + BLOCK;
+	heap.unlock(b[3]);
+	heap.unlock(b[4]);
+
+	heap.free(b[3]);
+	heap.free(b[4]);
+	printf("%s: move blocks between chunks\n", ok ? "OK  " : "FAIL");
+	return ok;
+}
+
+//----------------------------------------------------------------------
+// Locked blocks are not moved, after unlocking they are
+//----------------------------------------------------------------------
+bool testLocked(){
+	ResourceHeap heap(CHUNK);
+	HeapBlock b[4];
+	for (int i=0; i < 4; i++){
+		b[i] = heap.allocate(BLOCK);
+		fill(heap, b[i], i);
+	}
+	heap.free(b[0]);
+	heap.free(b[2]);
+
+	byte* base = (byte*)heap.lock(b[1]) - BLOCK;
+	heap.unlock(b[1]);
+	byte* locked = (byte*)heap.lock(b[3]);
+	heap.compact(0);
+
+	bool ok = heap.lock(b[1]) == base;
+	heap.unlock(b[1]);
+	ok = ok && heap.lock(b[3]) == locked && locked == base + 3 * BLOCK;
+	heap.unlock(b[3]);
+	ok = ok && check(heap, b[1], 1) && check(heap, b[3], 3);
+
+	// now the block is moved behind the other one
+	heap.unlock(b[3]);
+	heap.compact(0);
+	ok = ok && heap.lock(b[3]) == base + BLOCK;
+	heap.unlock(b[3]);
+	ok = ok && check(heap, b[1], 1) && check(heap, b[3], 3) && heap.getFootprint() == CHUNK;
+
+	heap.free(b[1]);
+	heap.free(b[3]);
+	printf("%s: locked blocks stay in place\n", ok ? "OK  " : "FAIL");
+	return ok;
+}
+
+//----------------------------------------------------------------------
+// Blocks before and behind the current position are freed while
+// the chunk is defragmented
+//----------------------------------------------------------------------
+bool testFreeDuringCompaction(){
+	ResourceHeap heap(CHUNK);
+	HeapBlock b[5];
+	for (int i=0; i < 5; i++){
+		b[i] = heap.allocate(BLOCK);
+		fill(heap, b[i], i);
+	}
+
+	// the chunk of b[4] is full, so blocks are moved inside of the first one
+	HeapBlock full = heap.allocate(3 * BLOCK);
+	heap.free(b[0]);
+
+	byte* base = (byte*)heap.lock(b[1]) - BLOCK;
+	heap.unlock(b[1]);
+	byte* p2 = (byte*)heap.lock(b[2]);
+	heap.unlock(b[2]);
+
+	// one step does move b[1] to the begin of the chunk
+	heap.compact(1);
+	bool paused = heap.lock(b[1]) == base && heap.lock(b[2]) == p2;
+	heap.unlock(b[1]);
+	heap.unlock(b[2]);
+
+	// b[1] is already kept, b[3] is not visited yet
+	heap.free(b[1]);
+	heap.free(b[3]);
+	heap.compact(0);
+
+	bool ok = paused && check(heap, b[2], 2) && check(heap, b[4], 4);
+	ok = ok && heap.lock(b[2]) == base;
+	heap.unlock(b[2]);
+	ok = ok && heap.getUsedBytes() == 5 * BLOCK && heap.getFootprint() == 2 * CHUNK;
+
+	// b[4] is moved now into the first chunk
+	heap.free(full);
+	heap.compact(0);
+	ok = ok && heap.getFootprint() == CHUNK && check(heap, b[2], 2) && check(heap, b[4], 4);
+	ok = ok && heap.lock(b[4]) == base + BLOCK;
+	heap.unlock(b[4]);
+
+	heap.free(b[2]);
+	heap.free(b[4]);
+	ok = ok && heap.getUsedBytes() == 0;
+	printf("%s: free blocks during the compaction\n", ok ? "OK  " : "FAIL");
+	return ok;
+}
+
+int main(){
+	Engine* root = new Engine();
+	root->initializeLog("./");
+	root->initializeEngine();
+
+	bool ok = testAllocate();
+	ok = testMoveBetweenChunks() && ok;
+	ok = testLocked() && ok;
+	ok = testFreeDuringCompaction() && ok;
+
+	delete root;
+	return ok ? 0 : 1;
+}
+
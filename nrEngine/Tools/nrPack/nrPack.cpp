@@ -0,0 +1,95 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/**
+ * nrPack - pack all files of a directory into an archive, which could be
+ * used by the ArchiveFileSystem of the engine. Files are compressed in
+ * blocks (see CompressedStream), so the engine does decompress only the
+ * parts of a file which are readed.
+ *
+ * Usage: nrPack [-n] archive directory
+ *		-n	do not compress the files
+ **/
+
+#include <nrEngine/nrEngine.h>
+#include <nrEngine/ArchiveFileSystem.h>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+using namespace std;
+using namespace nrEngine;
+
+//----------------------------------------------------------------------------------
+// Collect all files in the directory and its subdirectories
+//----------------------------------------------------------------------------------
+void collect(const string& root, const string& dir, vector<string>& files)
+{
+	string path = dir.length() ? root + "/" + dir : root;
+	DIR* d = opendir(path.c_str());
+	if (d == NULL){
+		printf("Can not read directory %s\n", path.c_str());
+		return;
+	}
+
+	struct dirent* ent;
+	while ((ent = readdir(d)) != NULL){
+		string name = ent->d_name;
+		if (name == "." || name == "..") continue;
+
+		string file = dir.length() ? dir + "/" + name : name;
+		struct stat st;
+		if (stat((root + "/" + file).c_str(), &st) != 0) continue;
+
+		if (S_ISDIR(st.st_mode))
+			collect(root, file, files);
+		else if (S_ISREG(st.st_mode))
+			files.push_back(file);
+	}
+
+	closedir(d);
+}
+
+//----------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+	bool compress = true;
+	int arg = 1;
+	if (arg < argc && string(argv[arg]) == "-n"){
+		compress = false;
+		arg++;
+	}
+
+	if (argc - arg != 2){
+		printf("Usage: %s [-n] archive directory\n", argv[0]);
+		printf("\t-n\tdo not compress the files\n");
+		return 1;
+	}
+
+	// the archive functions does log their errors
+	Engine* root = new Engine();
+	root->initializeLog("./");
+
+	vector<string> files;
+	collect(argv[arg + 1], "", files);
+
+	Result ret = ArchiveFileSystem::pack(argv[arg], argv[arg + 1], files, compress);
+	if (ret != OK){
+		printf("Can not pack %s, see engine.log\n", argv[arg]);
+	}else{
+		printf("%d files packed into %s\n", int(files.size()), argv[arg]);
+	}
+
+	delete root;
+	return ret == OK ? 0 : 1;
+}
+
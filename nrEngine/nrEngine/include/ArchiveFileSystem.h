@@ -0,0 +1,363 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef _NR_ARCHIVE_FILE_SYSTEM_H_
+#define _NR_ARCHIVE_FILE_SYSTEM_H_
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "Prerequisities.h"
+#include "IFileSystem.h"
+
+//! Magic bytes at the beginning of each archive
+#define NR_ARCHIVE_MAGIC "NRPK"
+
+//! Version of the archive format, 2 does store compressed files in blocks
+#define NR_ARCHIVE_VERSION 2
+
+//! Alignment of the file data in the archive
+#define NR_ARCHIVE_ALIGNMENT 4096
+
+//! Entry flag, file data is compressed in blocks, see CompressedStream
+#define NR_ARCHIVE_COMPRESSED (1 << 0)
+
+namespace nrEngine{
+
+	//! Header at the beginning of an archive
+	/**
+	 * The archive does begin with the header, followed by the directory
+	 * of all files (sorted by the hash and the name of the files) and the
+	 * names of the files. The data of each file begins at an offset
+	 * aligned to NR_ARCHIVE_ALIGNMENT.
+	 *
+	 * All numbers are stored in the byte order of the machine which has
+	 * packed the archive.
+	 *
+	 * \ingroup vfs
+	 **/
+	struct ArchiveHeader{
+		//! NR_ARCHIVE_MAGIC
+		char	magic[4];
+
+		//! Is 0x01020304 if the byte order of the archive is the one of the machine
+		uint32	byteOrder;
+
+		//! NR_ARCHIVE_VERSION
+		uint32	version;
+
+		//! Number of files in the archive
+		uint32	count;
+
+		//! Offset of the directory, the entries follow each other
+		uint32	dirOffset;
+
+		//! Offset of the names of the files
+		uint32	nameOffset;
+
+		//! Size of all names together
+		uint32	nameSize;
+
+		//! Not used yet, always 0
+		uint32	reserved;
+	};
+
+	//! One file in the archive directory
+	/**
+	 * \ingroup vfs
+	 **/
+	struct ArchiveEntry{
+		//! Hash value of the name, see ArchiveFileSystem::hash()
+		uint32	hash;
+
+		//! Offset of the name in the names block
+		uint32	nameOffset;
+
+		//! Length of the name without terminating zero
+		uint32	nameLength;
+
+		//! Combination of the NR_ARCHIVE_ flags
+		uint32	flags;
+
+		//! Offset of the file data in the archive
+		uint64	offset;
+
+		//! Size of the file
+		uint64	size;
+
+		//! Size of the file data in the archive (same as size if not compressed)
+		uint64	packedSize;
+	};
+
+	//! Memory mapped archive file
+	/**
+	 * The mapping is shared by the file system and all streams opened from
+	 * it, so the streams stay valid even if the file system is deinitialized.
+	 *
+	 * \ingroup vfs
+	 **/
+	class _NRExport ArchiveMapping{
+		public:
+			//! Map the given file into the memory
+			ArchiveMapping(const std::string& fileName);
+
+			//! Unmap the file
+			~ArchiveMapping();
+
+			//! Get pointer on the mapped data (NULL if the file could not be mapped)
+			const byte* getData() const { return mData; }
+
+			//! Get the size of the mapped file
+			size_t getSize() const { return mSize; }
+
+		private:
+			const byte* mData;
+			size_t mSize;
+
+			//! True if the data is mapped and not readed into the memory
+			bool mMapped;
+	};
+
+	//! Stream over one file of an archive
+	/**
+	 * The stream does read directly from the mapped archive, so no system
+	 * calls are needed to read the file. Compressed files are read through
+	 * a CompressedStream over the mapped data, so only the blocks which are
+	 * readed get decompressed.
+	 *
+	 * \ingroup vfs
+	 **/
+	class _NRExport ArchiveFileStream : public FileStream{
+		public:
+
+			/**
+			 * Create a stream over a region of the mapped archive.
+			 *
+			 * @param mapping Archive which contains the file
+			 * @param data Pointer on the file data in the mapping
+			 * @param size Size of the file
+			 **/
+			ArchiveFileStream(SharedPtr<ArchiveMapping> mapping, const byte* data, size_t size);
+
+			/**
+			 * Create a stream over a compressed file.
+			 *
+			 * @param stream Opened stream decompressing the file, all reading
+			 * is done through it
+			 **/
+			ArchiveFileStream(SharedPtr<CompressedStream> stream);
+
+			~ArchiveFileStream();
+
+			/**
+			 * Files of an archive are only opened through ArchiveFileSystem::open()
+			 *
+			 * @return always FILE_NOT_FOUND
+			 **/
+			Result open (const ::std::string& fileName);
+
+			//! @copydoc IStream::read()
+			size_t read(void *buf, size_t size, size_t nmemb);
+
+			//! @copydoc IStream::readDelim()
+			size_t readDelim(void* buf, size_t count, const ::std::string& delim = ::std::string("\n"));
+
+			//! @copydoc IStream::tell()
+			size_t tell() const;
+
+			//! @copydoc IStream::eof()
+			bool eof() const;
+
+			//! @copydoc IStream::getData()
+			byte* getData(size_t& count) const;
+
+			//! @copydoc IStream::seek()
+			bool seek(int32 offset, int32 whence = IStream::CURRENT);
+
+			//! @copydoc IStream::close()
+			void close ();
+
+			//! @copydoc FileStream::reclaim()
+			void reclaim (ResourceReclaimQueue& queue);
+
+			/**
+			 * The data of the stream is never changed, so streams over
+			 * identical files could read from the same data. Compressed
+			 * files are not shared, since their blocks are per stream.
+			 * @copydoc IResource::shareResPayload()
+			 **/
+			bool shareResPayload(IResource* source);
+
+			//! @copydoc IResource::isResPayloadShareable()
+			bool isResPayloadShareable() const { return true; }
+
+			//! @copydoc IStream::getView()
+			const byte* getView(size_t& count) const;
+
+			/**
+			 * Get pointer on the whole file data. The data is valid as long
+			 * as the stream is not closed. NULL for compressed files.
+			 **/
+			const byte* getMappedData() const { return mData; }
+
+		protected:
+
+			//! Set the data of the stream, the old one is closed
+			void setData(SharedPtr<ArchiveMapping> mapping, const byte* data, size_t size);
+
+		private:
+
+			//! Archive, if the data is in the mapping
+			SharedPtr<ArchiveMapping> mMapping;
+
+			//! Decompressing stream, if the file is compressed
+			SharedPtr<CompressedStream> mCompressed;
+
+			//! Data of the file
+			const byte* mData;
+
+			//! Current position in the file
+			mutable size_t mPos;
+
+			//! Set if a read did try to read behind the end
+			mutable bool mEof;
+	};
+
+	//! File system for files packed into one archive file
+	/**
+	 * Loading thousands of small files from the disk does need many system
+	 * calls and many disk seeks. So the files could be packed into one
+	 * archive by the nrPack tool (see Tools/nrPack). The archive file is
+	 * mapped into the memory by the initialization. The directory of the
+	 * archive is sorted by the hash values of the file names, so a file is
+	 * found by binary search directly in the mapped data. The files are
+	 * aligned to the page size, so each file does begin on its own page.
+	 *
+	 * open() does return a stream reading directly from the mapped data.
+	 * Files can be compressed with zlib in blocks, so they are decompressed
+	 * block by block while they are readed. This does need zlib support in
+	 * the engine, otherwise compressed files can not be opened.
+	 *
+	 * The type of this file system is "archive". File names are case
+	 * sensitive and relative to the directory which was packed, separated
+	 * by '/'.
+	 *
+	 * \ingroup vfs
+	 **/
+	class _NRExport ArchiveFileSystem : public IFileSystem{
+		public:
+
+			/**
+			 * Create the file system. The archive is opened by initialize().
+			 *
+			 * @param archiveName Name of the archive file
+			 **/
+			ArchiveFileSystem(const std::string& archiveName);
+
+			//! Release the archive
+			~ArchiveFileSystem();
+
+			//! @copydoc IFileSystem::exists()
+			bool exists(const std::string& fileName);
+
+			//! Archive file names are case sensitive
+			bool isCaseSensitive() const { return true; }
+
+			//! @copydoc IFileSystem::listFiles()
+			FileInfoListPtr listFiles(bool recursive = true);
+
+			//! @copydoc IFileSystem::findFiles()
+			FileInfoListPtr findFiles(const std::string& pattern, bool recursive = true);
+
+			/**
+			 * Map the archive into the memory and check its directory.
+			 *
+			 * @return either OK or:
+			 *		- VFS_ALREADY_OPEN if the archive is already opened
+			 *		- VFS_CANNOT_OPEN if the archive could not be mapped or is not valid
+			 **/
+			Result initialize();
+
+			/**
+			 * Release the archive. Opened streams are still valid.
+			 **/
+			Result deinitialize();
+
+			/**
+			 * Open a file in the archive.
+			 *
+			 * @param filename Name of the file in the archive
+			 * @return stream over the file or an empty pointer if there is
+			 * no such file or it could not be decompressed
+			 **/
+			SharedPtr<FileStream> open(const std::string& filename, NameValuePairs* = NULL);
+
+			/**
+			 * Get the name of the archive file
+			 **/
+			const std::string& getArchiveName() const { return mArchiveName; }
+
+			/**
+			 * Hash function used for the file names (FNV-1a)
+			 **/
+			static uint32 hash(const std::string& name);
+
+			/**
+			 * Pack files into a new archive.
+			 *
+			 * @param archiveName Name of the archive to write
+			 * @param root Directory to which the names of the files are relative
+			 * @param files Names of the files relative to the root
+			 * @param compress Compress the files in blocks, if it does reduce their size
+			 *
+			 * @return either OK or:
+			 *		- FILE_NOT_FOUND if a file could not be read
+			 *		- FILE_ERROR if the archive could not be written
+			 **/
+			static Result pack(const std::string& archiveName, const std::string& root,
+								const std::vector<std::string>& files, bool compress = true);
+
+		private:
+
+			//! Get the entry of the file or NULL if there is no such file
+			const ArchiveEntry* find(const std::string& fileName) const;
+
+			//! Get the file info of an entry
+			FileInfo getInfo(const ArchiveEntry& entry);
+
+			//! Normalize the file name, so that it can be found in the archive
+			static std::string normalize(const std::string& fileName);
+
+			//! Check whenever the name matches the pattern with the wildcard '*'
+			static bool match(const char* pattern, const char* name);
+
+			//! Name of the archive file
+			std::string mArchiveName;
+
+			//! Mapped archive
+			SharedPtr<ArchiveMapping> mMapping;
+
+			//! Header in the mapping
+			const ArchiveHeader* mHeader;
+
+			//! Directory in the mapping
+			const ArchiveEntry* mEntry;
+
+			//! Names in the mapping
+			const char* mName;
+	};
+
+};
+
+#endif
@@ -0,0 +1,227 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef _NR_COMPRESSED_STREAM_H_
+#define _NR_COMPRESSED_STREAM_H_
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "Prerequisities.h"
+#include "IStream.h"
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+//! Magic bytes at the beginning of each compressed stream
+#define NR_COMPRESSED_MAGIC "NRZB"
+
+//! Default size of the uncompressed blocks
+#define NR_COMPRESSED_BLOCK_SIZE (64 * 1024)
+
+namespace nrEngine{
+
+	//! Stream decompressing the data of another stream block by block
+	/**
+	 * CompressedStream is a decorator around any other stream, like a
+	 * FileStream or an ArchiveFileStream. The data of the underlying stream
+	 * has to be written by CompressedStream::compress(). It is split into
+	 * blocks of fixed size, each block is compressed with zlib on its own.
+	 * A table of the block offsets follows the header, so each block could
+	 * be found without reading the previous ones.
+	 *
+	 * So reading and seeking is possible without decompressing the whole
+	 * file. Only the block containing the current position is held in
+	 * the memory. While the data of a block is readed, the next block is
+	 * decompressed by a background thread, so sequential reading does
+	 * rarely wait for the decompression.
+	 *
+	 * Without zlib support in the engine such streams can not be opened.
+	 *
+	 * \ingroup filesys
+	 **/
+	class _NRExport CompressedStream : public IStream{
+		public:
+
+			/**
+			 * Create the stream. The data is not readed before open().
+			 *
+			 * @param source Stream containing the compressed data
+			 * @param prefetch If true, so the next block is decompressed
+			 * in the background
+			 **/
+			CompressedStream(SharedPtr<IStream> source, bool prefetch = true);
+
+			//! Stop the background decompression and close the stream
+			~CompressedStream();
+
+			/**
+			 * Read the header and the block table of the compressed data.
+			 * The block count and the block offsets are checked against the
+			 * size of the source, so damaged data is rejected here.
+			 *
+			 * @return either OK or:
+			 *		- VFS_FILE_READ_ERROR if the source does not contain compressed data
+			 *		- VFS_CANNOT_OPEN if the engine was compiled without zlib
+			 **/
+			Result open();
+
+			//! Get the name of the underlying stream
+			const ::std::string& getName() { return mSource ? mSource->getName() : mName; }
+
+			//! @copydoc IStream::read()
+			size_t read(void *buf, size_t size, size_t nmemb);
+
+			//! @copydoc IStream::readDelim()
+			size_t readDelim(void* buf, size_t count, const ::std::string& delim = ::std::string("\n"));
+
+			//! @copydoc IStream::tell()
+			size_t tell() const;
+
+			//! @copydoc IStream::eof()
+			bool eof() const;
+
+			//! @copydoc IStream::getData()
+			byte* getData(size_t& count) const;
+
+			//! @copydoc IStream::seek()
+			bool seek(int32 offset, int32 whence = IStream::CURRENT);
+
+			//! @copydoc IStream::close()
+			void close ();
+
+			/**
+			 * Get the size of the uncompressed blocks
+			 **/
+			uint32 getBlockSize() const { return mBlockSize; }
+
+			/**
+			 * Compress the data of a stream, so that it could be readed by a
+			 * CompressedStream. Blocks which does not get smaller are stored
+			 * uncompressed.
+			 *
+			 * @param source Stream with the data to compress, readed from the current position
+			 * @param fileName Name of the file to write
+			 * @param blockSize Size of the uncompressed blocks
+			 *
+			 * @return either OK or:
+			 *		- FILE_ERROR if the file could not be written
+			 *		- VFS_CANNOT_OPEN if the engine was compiled without zlib
+			 **/
+			static Result compress(IStream* source, const ::std::string& fileName, uint32 blockSize = NR_COMPRESSED_BLOCK_SIZE);
+
+			/**
+			 * Compress data in the memory, so that it could be readed by a
+			 * CompressedStream. Used to store compressed files in archives.
+			 *
+			 * @param data Data to compress
+			 * @param size Size of the data
+			 * @param result Is filled with the compressed data
+			 * @param blockSize Size of the uncompressed blocks
+			 *
+			 * @return either OK or VFS_CANNOT_OPEN if the engine was compiled without zlib
+			 **/
+			static Result compress(const byte* data, size_t size, ::std::vector<byte>& result, uint32 blockSize = NR_COMPRESSED_BLOCK_SIZE);
+
+		private:
+
+			//! One decompressed block
+			struct Block{
+				//! Index of the block (-1 if empty)
+				int32 index;
+
+				//! Decompressed data
+				::std::vector<byte> data;
+			};
+
+			//! Header at the beginning of the compressed data
+			struct Header{
+				char	magic[4];
+				uint32	byteOrder;
+				uint32	blockSize;
+				uint32	blockCount;
+				uint64	size;
+			};
+
+			//! Make the block containing the given position current
+			const Block& getBlock(size_t pos) const;
+
+			//! Read and decompress the block from the source
+			bool readBlock(int32 index, Block& block) const;
+
+			//! Seek the source to a 64 bit position, the source has to be locked
+			bool seekSource(uint64 pos) const;
+
+			//! Fill the header for data of the given size
+			static void initHeader(Header& h, uint64 size, uint32 blockSize);
+
+			//! Compress one block, the returned data is either the packed or the given block
+			static const byte* packBlock(const byte* block, size_t size, ::std::vector<byte>& packed, size_t& length);
+
+			//! Background decompression
+			void run();
+
+			//! Stop the background thread
+			void stopPrefetch();
+
+			//! Stream containing the compressed data
+			SharedPtr<IStream> mSource;
+
+			//! Offsets of the blocks in the source and the end of the last block
+			::std::vector<uint64> mOffset;
+
+			//! Size of the uncompressed blocks
+			uint32 mBlockSize;
+
+			//! Current position in the uncompressed data
+			mutable size_t mPos;
+
+			//! Set if a read did try to read behind the end
+			mutable bool mEof;
+
+			//! Block containing the current position
+			mutable Block mCurrent;
+
+			//! Block decompressed in the background
+			mutable Block mPrefetched;
+
+			//! Index of the block which has to be decompressed in the background (-1 if none)
+			mutable int32 mRequested;
+
+			//! Index of the block which is decompressed in the background at now (-1 if none)
+			mutable int32 mLoading;
+
+			//! True if the background decompression is used
+			bool mPrefetch;
+
+			//! True if the background thread has to stop
+			bool mStop;
+
+			//! Background thread, started by the first block
+			mutable SharedPtr<boost::thread> mThread;
+
+			//! Protects the blocks and the requests
+			mutable boost::mutex mMutex;
+
+			//! Protects the source stream
+			mutable boost::mutex mSourceMutex;
+
+			//! Signal for the background thread and for waiting on its block
+			mutable boost::condition_variable mSignal;
+	};
+
+};
+
+#endif
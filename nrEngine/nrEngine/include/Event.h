@@ -59,6 +59,40 @@ namespace nrEngine{
 				return true;
 			}
 
+			/**
+			 * Get the type name under which this event can be recreated
+			 * by the event factories. Only events returning a valid name here
+			 * do support flat serialisation and could be transfered to
+			 * other processes through an EventBridge. The name should be a
+			 * string constant, because the bridge does remember the type
+			 * by the address of the name.
+			 *
+			 * @return NULL by default, so the event is not flat
+			 **/
+			virtual const char* getFlatType() const;
+
+			/**
+			 * Write the event data into a flat memory block. The data must
+			 * not contain any pointers, because it will be read by another
+			 * process.
+			 *
+			 * @param buffer Memory where to write the data
+			 * @param size Size of the buffer in bytes
+			 * @return number of written bytes or 0 if the event could not
+			 * 			be written into the buffer
+			 **/
+			virtual uint32 writeFlat(byte* buffer, uint32 size) const;
+
+			/**
+			 * Fill the event from a flat memory block previously written
+			 * by writeFlat().
+			 *
+			 * @param buffer Memory containing the flat event data
+			 * @param size Size of the data in bytes
+			 * @return either OK or an error code
+			 **/
+			virtual Result readFlat(const byte* buffer, uint32 size);
+
 		protected:
 			/**
 			* Create new instance of a base class Event.
@@ -22,6 +22,21 @@
 
 namespace nrEngine{
 
+	//! Handle of an actor connection in a certain channel
+	/**
+	 * Each connection of an actor to a channel gets a handle. The handle
+	 * stays valid until the actor is disconnected from the channel and can
+	 * be used to access or disconnect the actor in constant time. The lower
+	 * 32 bits contain the slot of the connection, the upper 32 bits a generation
+	 * counter, so handles of old connections are not valid anymore. A slot
+	 * is not used anymore before its generation could wrap around.
+	 *
+	 * \ingroup event
+	 **/
+	typedef uint64 ActorHandle;
+
+	//! Handle which does never represent a valid connection
+	#define NR_INVALID_ACTOR_HANDLE 0xFFFFFFFFFFFFFFFFULL
 
 	//! Event actors could acts as a server and client on event communication channels
 	/**
@@ -88,8 +103,17 @@ namespace nrEngine{
 			//! The EventChannel is a friend so he is able to change default values
 			friend class EventChannel;
 
+			//! Connection of the actor to a channel
+			typedef struct _Connection{
+				//! Channel we are connected to
+				EventChannel* channel;
+
+				//! Handle of this actor in the channel
+				ActorHandle handle;
+			} Connection;
+
 			//! Here we store the all the channels we are connected to
-			std::list<std::string> mChannel;
+			std::vector<Connection> mChannel;
 
 			//! EventManager which this actor belongs to
 			//EventManager* mParentManager;
@@ -97,11 +121,17 @@ namespace nrEngine{
 			//! Check whenever we are already connected to a channel
 			bool isConnected (const std::string& name);
 
+			//! Check whenever we are already connected to a channel
+			bool isConnected (const EventChannel* channel) const;
+
+			//! Get the handle of this actor in the given channel
+			ActorHandle getHandle (const EventChannel* channel) const;
+
 			/**
 			 * This function will be called from the channel, to notice the actor,
 			 * that he is got now a new connection.
 			 **/
-			void _noticeConnected(EventChannel* channel);
+			void _noticeConnected(EventChannel* channel, ActorHandle handle);
 
 			/**
 			 * Notice an actor that he is disconnected now.
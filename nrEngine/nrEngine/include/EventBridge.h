@@ -0,0 +1,201 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef _NR_EVENT_BRIDGE_H_
+#define _NR_EVENT_BRIDGE_H_
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "Prerequisities.h"
+#include "EventActor.h"
+#include "ITask.h"
+#include "EventFactory.h"
+
+//! Maximal length of an event type name transfered through the bridge
+#define NR_EVENT_BRIDGE_TYPE_LENGTH 64
+
+//! Number of updates a subscriber does wait before it tries again to open the ring
+#define NR_EVENT_BRIDGE_RETRY 64
+
+//! Maximal number of type ids of the publisher cached by a subscriber
+#define NR_EVENT_BRIDGE_TYPE_CACHE 4096
+
+namespace nrEngine{
+
+	//! Mirror event channels between processes through shared memory
+	/**
+	 * \par
+	 * EventBridge does mirror a local event channel into a ring buffer in the
+	 * POSIX shared memory, so other engine processes on the same host can
+	 * recieve the events without any socket or system call per message.
+	 * The shared memory segment is named after the channel.
+	 *
+	 * \par
+	 * A bridge is either a publisher or a subscriber. The publisher is an
+	 * actor connected to the local channel. Each event which does support
+	 * flat serialisation (see Event::getFlatType()) is written into the
+	 * next slot of the ring. Other events are ignored. There should be only
+	 * one publisher per channel on the host.
+	 *
+	 * \par
+	 * The subscriber is a task which reads on each update all new slots of
+	 * the ring, recreates the events through EventManager::createEvent() and
+	 * emits them to the local channel of the same name. Each slot does also
+	 * contain the interned type id of the publisher, so the subscriber does
+	 * resolve the type name only once per type and not on every event.
+	 * Every subscriber has its own read position, so any number of processes
+	 * can consume the ring. The ring is lock-free: slots are protected by
+	 * sequence numbers, so if the publisher overruns a slow subscriber, the
+	 * lost events are just counted.
+	 *
+	 * \par
+	 * A subscriber can be started before the publisher. As long as the
+	 * segment does not exist or is not initialized by the publisher, it tries
+	 * again every NR_EVENT_BRIDGE_RETRY updates.
+	 *
+	 * \par
+	 * The bridge is a user task, so it must get a user order number.
+	 * Example for the subscriber:
+	 * \code
+	 * SharedPtr<ITask> bridge(new EventBridge("input", EventBridge::SUBSCRIBE));
+	 * Kernel::GetSingleton().AddTask(bridge, ORDER_FIRST);
+	 * \endcode
+	 *
+	 * \ingroup event
+	**/
+	class _NRExport EventBridge : public EventActor, public ITask{
+		public:
+
+			//! Role of the bridge on the shared ring
+			typedef enum _BridgeMode{
+				//! Write events of the local channel into the ring
+				PUBLISH,
+
+				//! Read events from the ring into the local channel
+				SUBSCRIBE
+			} BridgeMode;
+
+			/**
+			 * Create a new bridge for a certain channel.
+			 *
+			 * @param channel Name of the local channel to mirror
+			 * @param mode Either publisher or subscriber
+			 * @param slotCount Number of slots in the ring (only used by the publisher)
+			 * @param slotSize Maximal size of the flat event data in bytes (only used by the publisher)
+			 **/
+			EventBridge(const std::string& channel, BridgeMode mode, uint32 slotCount = 1024, uint32 slotSize = 512);
+
+			//! Unmap the shared memory and disconnect from the channel
+			~EventBridge();
+
+			/**
+			 * Create or map the shared memory segment. The publisher will also
+			 * be connected to the local channel. This method is called
+			 * automaticaly if the bridge is added to the kernel.
+			 *
+			 * @return either OK or EVENT_SHARED_MEMORY_ERROR
+			 **/
+			Result open();
+
+			/**
+			 * Unmap the shared memory segment. The segment itself stays
+			 * in the system, so other processes are still able to use it.
+			 **/
+			void close();
+
+			/**
+			 * Get number of events which were lost, because the publisher
+			 * was faster than the subscriber, or which could not be written
+			 * into the ring.
+			 **/
+			uint64 getLostCount() const { return mLostCount; }
+
+			//! Publisher does write each flat event into the ring
+			void OnEvent(const EventChannel& channel, SharedPtr<Event> event);
+
+			/**
+			 * Open the bridge when the task is started. A subscriber is also
+			 * started if the segment does not exist yet.
+			 **/
+			Result taskInit();
+
+			//! Subscriber does read all new events from the ring
+			Result taskUpdate();
+
+			//! Close the bridge when the task is stopped
+			Result taskStop();
+
+		private:
+
+			//! Name of the mirrored channel
+			std::string mChannelName;
+
+			//! Role of the bridge
+			BridgeMode mMode;
+
+			//! Number of slots in the ring
+			uint32 mSlotCount;
+
+			//! Maximal size of the flat event data
+			uint32 mSlotSize;
+
+			//! Mapped shared memory segment
+			byte* mMemory;
+
+			//! Size of the mapped segment
+			uint32 mMemorySize;
+
+			//! Next sequence number to be read by the subscriber
+			uint64 mReadSeq;
+
+			//! Number of lost events
+			uint64 mLostCount;
+
+			//! Updates until the subscriber tries again to open the segment
+			uint32 mRetryDelay;
+
+			//! Get the name of the shared memory segment
+			std::string getSegmentName() const;
+
+			//! Publisher's interned type ids by the address of the flat type name
+			typedef boost::unordered_map<const char*, EventTypeID> FlatTypeMap;
+
+			//! Ids of the flat types written by the publisher
+			FlatTypeMap mFlatType;
+
+			//! Local type of a type id of the publisher
+			struct RemoteType{
+				//! Local interned id
+				EventTypeID id;
+
+				//! Name of the type
+				std::string name;
+
+				RemoteType() : id(NR_EVENT_TYPE_INVALID) {}
+			};
+
+			//! Local types indexed by the type ids of the publisher
+			std::vector<RemoteType> mRemoteType;
+
+			//! Get the interned id of a flat type name written by the publisher
+			EventTypeID getFlatTypeId(const char* type);
+
+			//! Get the local id of a type read by the subscriber
+			EventTypeID getLocalTypeId(uint32 remoteId, const char* type);
+
+	};
+
+}; // end namespace
+
+#endif
@@ -37,6 +37,11 @@ namespace nrEngine{
 	 * if any state changes. This is also how we handle it in the nrEngine.
 	 *
 	 * \par
+	 * Connected actors are stored in a contiguous array, so emitting of events
+	 * does only walk through memory. Each connection gets a stable handle, through
+	 * which the actor can be accessed or disconnected in constant time.
+	 *
+	 * \par
 	 * The communication actors are connected to the channel by its name. Also
 	 * the lifetime of each actor is tracked. So if an actor is removed from the
 	 * memory, so it will be automaticaly disconnected from the database.
@@ -67,9 +72,12 @@ namespace nrEngine{
 			 * if the reactions to the default events are not implemented.
 			 * 
 			 * @param actor An actor to connect to the channel
-			 * @param notice Should channel let notice the actor that he is connected now (default YES)
+			 * @param notice Should channel let notice the actor that he is connected now (default YES).
+			 * 		Only noticed actors do know the handle of the connection, so they
+			 * 		can disconnect themself on destruction.
+			 * @param handle If not NULL, so the handle of the connection is returned here
 			 **/
-			Result add(EventActor* actor, bool notice = true);
+			Result add(EventActor* actor, bool notice = true, ActorHandle* handle = NULL);
 
 			/**
 			 * Disconnect an actor from the channel. It is a good coding style
@@ -87,6 +95,32 @@ namespace nrEngine{
 			 **/
 			Result del(EventActor* actor, bool notice = true);
 
+			/**
+			 * Same as del(EventActor*, bool) but the actor is given by
+			 * the handle of its connection. This does work in constant time.
+			 *
+			 * @param handle Handle of the connection returned by getHandle()
+			 * @param notice Should channel notice the actor, about disconnection (default YES)
+			 **/
+			Result del(ActorHandle handle, bool notice = true);
+
+			/**
+			 * Get an actor by the handle of its connection.
+			 * @return NULL if the handle is not valid
+			 **/
+			EventActor* getActor(ActorHandle handle) const;
+
+			/**
+			 * Get the handle of the connection of a certain actor.
+			 * @return NR_INVALID_ACTOR_HANDLE if the actor is not connected
+			 **/
+			ActorHandle getHandle(const EventActor* actor) const;
+
+			/**
+			 * Get number of actors connected to the channel
+			 **/
+			uint32 getActorCount() const { return mActorDb.size() - mRemovedCount; }
+
 			/**
 			 * Get the name of the channel
 			 **/
@@ -95,6 +129,8 @@ namespace nrEngine{
 			/**
 			 * Emit a certain event to a channel. This will send this event
 			 * to all connected actors, so they get noticed about new event.
+			 * Actors could connect and disconnect actors while handling the
+			 * event, actors which stay connected get the event anyway.
 			 *
 			 * @param event Smart pointer to an event object
 			 **/
@@ -124,8 +160,26 @@ namespace nrEngine{
 			//! The event manager system is a friend to this class
 			friend class EventManager;
 
-			//! Store here the mapping between actor names and their connections
-			typedef std::map<std::string, EventActor*> ActorDatabase;
+			//! Connected actor and the slot of its handle
+			typedef struct _ActorEntry{
+				//! Connected actor
+				EventActor* actor;
+
+				//! Slot of the handle pointing to this entry
+				uint32 slot;
+			} ActorEntry;
+
+			//! Slot of a handle pointing to an entry in the actor database
+			typedef struct _ActorSlot{
+				//! Index of the entry in the actor database or next free slot
+				uint32 index;
+
+				//! Generation of the slot, increased on each disconnection
+				uint32 generation;
+			} ActorSlot;
+
+			//! Contiguous storage of connected actors
+			typedef std::vector<ActorEntry> ActorDatabase;
 
 			//! Unique name of the communication channel
 			std::string mName;
@@ -135,6 +189,18 @@ namespace nrEngine{
 
 			//! Connected actor database
 			ActorDatabase mActorDb;
+
+			//! Handle slots pointing into the actor database
+			std::vector<ActorSlot> mActorSlot;
+
+			//! First free slot or NR_ACTOR_NO_SLOT if there is no
+			uint32 mFreeSlot;
+
+			//! Number of emit() calls currently running on this channel
+			uint32 mEmitDepth;
+
+			//! Number of disconnected entries, which are removed after emit()
+			uint32 mRemovedCount;
 			 
 			/**
 			 * This structure is used as a wrapper to define a way
@@ -161,6 +227,15 @@ namespace nrEngine{
 			//! Disconnect all actors from the channel
 			void _disconnectAll();
 
+			//! Build the handle of the given slot
+			ActorHandle makeHandle(uint32 slot) const;
+
+			//! Get the index of an actor in the database by searching it, or -1
+			int32 findActor(const EventActor* actor) const;
+
+			//! Remove the entries of disconnected actors from the database
+			void compact();
+
 	};
 	
 }; // end namespace
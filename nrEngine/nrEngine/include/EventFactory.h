@@ -22,6 +22,20 @@
 
 namespace nrEngine{
 
+	//! Interned identifier of an event type
+	/**
+	 * Each event type name known to the engine is mapped once by the
+	 * EventManager to a small unique integer. The id can be stored by the
+	 * user and used instead of the name to create events without any
+	 * string handling. Id 0 is never assigned to any type.
+	 *
+	 * \ingroup event
+	 **/
+	typedef uint32 EventTypeID;
+
+	//! Id which is never assigned to any event type
+	#define NR_EVENT_TYPE_INVALID 0
+
 	//! Event factories are used to create events of certain types
 	/**
 	 * EventFatory is an object which is able to create events of certain
@@ -56,6 +70,13 @@ namespace nrEngine{
 			 **/
 			bool isSupported(const std::string& eventType) const;
 
+			/**
+			 * Same as isSupported() but check by the interned type id.
+			 * This does only work if the factory was already registered
+			 * by the event manager.
+			 **/
+			bool isSupported(EventTypeID eventType) const;
+
 			/**
 			 * Create a new instance of an event of the given type
 			 *
@@ -65,6 +86,21 @@ namespace nrEngine{
 			 **/
 			virtual SharedPtr<Event> create(const std::string& eventType) = 0;
 
+			/**
+			 * Create a new instance of an event by its interned type id.
+			 * This is the method called by the event manager. Default
+			 * implementation resolves the type name and calls create(name).
+			 *
+			 * Derive this method if your factory does store its events in a
+			 * pool. Then you can return a recycled event object without any
+			 * name comparison or memory allocation.
+			 *
+			 * @param eventType Interned type id of the event to create
+			 * @return NULL if the event could not been created or
+			 * 				a valid smart pointer otherwise
+			 **/
+			virtual SharedPtr<Event> create(EventTypeID eventType);
+
 			/**
 			 * Get the name
 			 **/
@@ -80,9 +116,23 @@ namespace nrEngine{
 			//! Fill the list of supported event types
 			virtual void fillSupported() = 0;
 
+			//! Add a new event type to the list of supported types
+			void declareSupportedType(const std::string& eventType);
+
 			//! Name of the factory
 			std::string mName;
 
+		private:
+
+			//! Event manager does build the type id table
+			friend class EventManager;
+
+			//! Set of interned ids of all supported types
+			typedef boost::unordered_set<EventTypeID> TypeSet;
+
+			//! Ids of supported types, filled on registration
+			TypeSet mSupportedIds;
+
 	};
 
 }; // end namespace
@@ -181,12 +181,36 @@ namespace nrEngine{
 
 			/**
 			 * Call this function if you prefer to create a new event object
-			 * from all registerd factories. The function will go through all
-			 * registered factories and ask them which does support the given
-			 * event type. If one could be found, so create it.
+			 * from all registerd factories. The type name is resolved to its
+			 * interned id and the factory supporting the type is found
+			 * by a single lookup in the type table.
 			 **/
 			SharedPtr<Event> createEvent(const std::string& eventType);
 
+			/**
+			 * Same as createEvent(const std::string&) but the event type
+			 * is given by its interned id. No string handling is done here.
+			 * If the factory does pool its events, so no memory will be
+			 * allocated either.
+			 **/
+			SharedPtr<Event> createEvent(EventTypeID eventType);
+
+			/**
+			 * Get the interned id of an event type name.
+			 *
+			 * @param eventType Name of the event type
+			 * @param create If true, so a new id is assigned to unknown names
+			 * @return id of the type or NR_EVENT_TYPE_INVALID if the name is
+			 * unknown and no new id should be created
+			 **/
+			EventTypeID getEventType(const std::string& eventType, bool create = true);
+
+			/**
+			 * Get the name of an interned event type id. Empty string
+			 * is returned for unknown ids.
+			 **/
+			const std::string& getEventTypeName(EventTypeID eventType) const;
+
 			/**
 			 * Register a new event factory. The given event factory will be
 			 * stored in a list. The factory can later be used to create instancies
@@ -217,6 +241,21 @@ namespace nrEngine{
 			//! Variable to hold the data
 			FactoryDatabase mFactoryDb;
 
+			//! Hashed map of event type names to their interned ids
+			typedef boost::unordered_map<std::string, EventTypeID> TypeIdDatabase;
+
+			//! Interned event types
+			TypeIdDatabase mTypeIdDb;
+
+			//! Names of interned types, indexed by the type id
+			std::vector<std::string> mTypeName;
+
+			//! Factory responsible for each type, indexed by the type id
+			std::vector<EventFactory*> mTypeFactory;
+
+			//! Bind all types supported by the factory to it in the type table
+			void bindFactoryTypes(EventFactory* factory);
+
 	};
 
 }; // end namespace
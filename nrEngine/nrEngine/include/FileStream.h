@@ -151,6 +151,13 @@ namespace nrEngine{
 		**/
 		virtual void close ();
 
+		/**
+		* Close the stream like close(), but give the release of the data
+		* to the reclaim queue, so the caller does not wait for it.
+		* @param queue Queue releasing the data
+		**/
+		virtual void reclaim (ResourceReclaimQueue& queue);
+
 
 		//------------------------------------------------------------
 		//		IResource Interface
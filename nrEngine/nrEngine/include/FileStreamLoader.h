@@ -20,12 +20,23 @@
 #include "Prerequisities.h"
 #include "ResourceLoader.h"
 #include "FileStream.h"
+#include "MappedFileStream.h"
 
 
 namespace nrEngine{
 
 	//! File stream loader is able to instantiate file stream objects
 	/**
+	* The loader does support two resource types: "File" and "MappedFile".
+	* Files of the type "MappedFile", files with the parameter "mapped" and
+	* "File" resources which are at least as big as the mapped size are opened
+	* as MappedFileStream, all others as FileStream.
+	*
+	* While the ResourceFileWatcher is enabled, "File" resources are not mapped
+	* by their size. Tools does often rewrite a watched file in place, and
+	* reading a page of a mapping whose file was truncated does raise SIGBUS.
+	* Files mapped on request have to be replaced by renaming a new file.
+	*
 	* @see IResourceLoader
 	* \ingroup filesys
 	**/
@@ -55,6 +66,13 @@ namespace nrEngine{
 		**/
 		Result loadResource(IResource* resource);
 
+		/**
+		* File streams do only open the file, so they could be loaded
+		* by the loader threads.
+		* @copydoc IResourceLoader::isThreadSafe()
+		**/
+		bool isThreadSafe() const { return true; }
+
 		/**
 		* Instantiate empty file stream object.
 		* @param resourceType Unique name of the resource type to be created
@@ -69,12 +87,34 @@ namespace nrEngine{
 		**/
 		IResource* createResourceInstance(const ::std::string& resourceType, NameValuePairs* params = NULL) const;
 
+		/**
+		* Create an instance of file stream object. Big files are mapped.
+		* @copydoc IResourceLoader::createResourceInstance()
+		**/
+		IResource* createResourceInstance(const ::std::string& resourceType, const ::std::string& fileName, NameValuePairs* params) const;
+
+		/**
+		* Set the size from which on "File" resources are mapped into
+		* the memory. 0 does disable it. Default is NR_MAPPED_FILE_SIZE.
+		**/
+		void setMappedSize(size_t size) { mMappedSize = size; }
+
+		/**
+		* Get the size from which on files are mapped
+		**/
+		size_t getMappedSize() const { return mMappedSize; }
+
 		/**
 		* Unload the file stream.
 		* @copydoc IResourceLoader::unloadResource()
 		**/
 		Result unloadResource(IResource* resource);
 
+	private:
+
+		//! Files of at least this size are mapped
+		size_t mMappedSize;
+
 	};
 
 };
@@ -121,6 +121,9 @@ namespace nrEngine{
 			
 		protected:
 
+			//! Script loader does name the task by the resource name
+			friend class ScriptLoader;
+
 			//! Here we store the whole script as a string
 			std::string mContent;
 			
@@ -133,6 +133,15 @@ namespace nrEngine{
 		**/
 		virtual byte* getData(size_t& count) const = 0;
 
+		/**
+		* Get a read-only view on the whole data without copying it. Only
+		* streams which have their whole data in the memory could do this,
+		* all other return NULL. The view is valid until the stream is closed.
+		* The position of the stream is not changed.
+		* @param count Return count of bytes of the view
+		**/
+		virtual const byte* getView(size_t& count) const;
+
 		/**
 		* Only for text-only streams. You have the abbility to return the whole
 		* stream content as a string
@@ -20,6 +20,8 @@
 #include "Prerequisities.h"
 #include "ISingleton.h"
 
+#include <boost/thread/mutex.hpp>
+
 //----------------------------------------------------------------------------------
 // Some usefull macros which makes our life easear
 //----------------------------------------------------------------------------------
@@ -145,6 +147,7 @@ namespace nrEngine{
 			* @param to All messages will be echoed here
 			**/
 			void setEcho(LogTarget from, LogTarget to){
+				boost::mutex::scoped_lock lock(_mutex);
 				_echoMap[(int32)from] = (int32)to;	
 			}
 
@@ -176,8 +179,11 @@ namespace nrEngine{
 
 			// Log level information
 			LogLevel	_logLevel;
+
+			// the loader threads and the engine are logging at the same time
+			boost::mutex _mutex;
 			
-			// logging function
+			// logging function, called with the locked mutex
 			void logIt(int32 target, LogLevel level, const char *msg);
 
 			// get log level string
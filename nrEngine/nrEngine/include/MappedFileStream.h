@@ -0,0 +1,69 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef _NR_MAPPED_FILE_STREAM_H_
+#define _NR_MAPPED_FILE_STREAM_H_
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "Prerequisities.h"
+#include "ArchiveFileSystem.h"
+
+//! Files of at least this size are mapped by default
+#define NR_MAPPED_FILE_SIZE (1024 * 1024)
+
+namespace nrEngine{
+
+	//! File stream over a file mapped into the memory
+	/**
+	 * The whole file is mapped into the memory by opening, so reading does
+	 * only copy from the mapping and needs no system calls. With getView()
+	 * the data could be parsed directly from the mapping without any copy.
+	 * Pages which are not used are readed by the system on demand.
+	 *
+	 * The resource type of such streams is "MappedFile". The FileStreamLoader
+	 * does create them also for "File" resources which are at least
+	 * NR_MAPPED_FILE_SIZE bytes big while no file watcher is enabled, or if
+	 * the parameter "mapped" is given.
+	 *
+	 * The file must not be truncated or rewritten in place while it is
+	 * mapped, since reading a page behind the new end of the file does raise
+	 * SIGBUS. Write a new file and rename it over the old one instead, the
+	 * mapping does then keep the old content until the stream is reopened.
+	 *
+	 * On platforms without memory mapping the file is readed completely.
+	 *
+	 * \ingroup filesys
+	 **/
+	class _NRExport MappedFileStream : public ArchiveFileStream{
+		public:
+
+			//! Create a closed stream
+			MappedFileStream();
+
+			~MappedFileStream();
+
+			/**
+			 * Map the file into the memory.
+			 *
+			 * @param fileName Name of the file
+			 * @return either OK or FILE_NOT_FOUND
+			 **/
+			Result open (const ::std::string& fileName);
+	};
+
+};
+
+#endif
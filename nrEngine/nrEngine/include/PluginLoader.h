@@ -76,6 +76,12 @@ namespace nrEngine{
 		* @copydoc IResourceLoader::loadResource()
 		**/
 		Result loadResource(IResource* resource);
+
+		/**
+		* Plugins are initialized while loading, so they are always
+		* loaded in the main thread.
+		**/
+		bool isThreadSafe() const { return false; }
 	
 		/**
 		* Create an empty plugin resource. The resource represents a plugin
@@ -96,16 +102,18 @@ namespace nrEngine{
 		/**
 		* Unload the plugin library from the memory. This method is called
 		* from the Plugin object, so you do not have to do this by your self.
+		* Unloading of the library is given to the ResourceReclaimQueue of the
+		* manager, so it does not stall the unloading. The queue does unload it
+		* in the main thread. PLG_UNLOAD_ERROR is returned if the library was
+		* unloaded at once and this did fail, a failure later is only logged.
 		* @copydoc IResourceLoader::unloadResource()
 		**/
 		Result unloadResource(IResource* resource);
 		
-		
-	private:
 		/**
 		 * Returns the last error of the dynamic library
 		 **/
-		std::string getLastPluginError();
+		static std::string getLastPluginError();
 				
 	
 	};
@@ -38,6 +38,7 @@ namespace nrEngine{
 	#define NR_VERSION_PATCH 6
 	#define NR_VERSION_NAME "Akula"
 	#define NR_DEFAULT_EVENT_CHANNEL "nrEngine_default_channel"
+	#define NR_RESOURCE_EVENT_CHANNEL "nrEngine_resource_channel"
 	
 	//------------------------------------------------------------------------------
 	//	Version Information unsigned integer
@@ -115,6 +116,17 @@ namespace nrEngine{
 	class 										ResourceHolder;
 	template<class ResType> class 				ResourcePtr;
 	class 										IResourceLoader;
+	class										ResourceEvictionPolicy;
+	struct										ResourceEvictionCandidate;
+	struct										ResourceDependency;
+	class										ResourceLoadQueue;
+	class										ResourceFileWatcher;
+	class										ResourceStatistics;
+	class										ResourceCache;
+	class										ResourceReclaimQueue;
+	class										ResourcePreloader;
+	class										ResourceCollector;
+	class										ResourceHeap;
 	
 	class										TimeSource;
 	class 										Kernel;
@@ -123,9 +135,14 @@ namespace nrEngine{
 	class										Timer;	
 
 	class										IStream;
+	class										CompressedStream;
 
 	class										IFileSystem;
 	class										FileSystem;
+	class										ArchiveFileSystem;
+	class										ArchiveFileStream;
+	class										ArchiveMapping;
+	class										MappedFileStream;
 
 	class										ScriptEngine;
 	class										IScript;
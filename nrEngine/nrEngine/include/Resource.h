@@ -20,9 +20,31 @@
 //----------------------------------------------------------------------------------
 #include "Prerequisities.h"
 #include "ResourceSystem.h"
+#include "ResourceHolder.h"
 
 namespace nrEngine{
 
+	//! Description of a resource needed by another resource
+	/**
+	* Resources could declare other resources which they need, e.g. a script
+	* could need some plugins. The manager does use this description to find
+	* the resource by its name or to load it if it does not exist yet.
+	* \ingroup resource
+	**/
+	struct _NRExport ResourceDependency{
+		//! Unique name of the needed resource
+		std::string name;
+
+		//! Group of the resource, if it has to be loaded
+		std::string group;
+
+		//! Type of the resource, if it has to be loaded
+		std::string resourceType;
+
+		//! File of the resource, if it has to be loaded
+		std::string fileName;
+	};
+
 	//! General interface to hold any kind of resources
 	/**
 	* This is an interface which is describing how resource classes should looks like.
@@ -92,6 +114,29 @@ namespace nrEngine{
 		**/
 		virtual Result reloadRes();
 
+		/**
+		* Take the payload of a loaded resource of the same type, which was
+		* loaded from a file with the same content. This is called by the
+		* ResourceCache instead of loading, if sharing is enabled.
+		*
+		* Resources which does hold their data in a reference counted object,
+		* which is not changed after loading, could take a reference here and
+		* return true. The data size should count only the own data then, so
+		* the payload is counted once. Before the resource does change the
+		* payload it has to copy it, see detachResPayload().
+		*
+		* @param source Loaded resource with the same content
+		* @return true if the payload is shared, false to load as usual
+		**/
+		virtual bool shareResPayload(IResource* source) { return false; }
+
+		/**
+		* Return true if shareResPayload() could take the payload of other
+		* resources. Only then the cache does compute the content hash of the
+		* file, which is needed to find identical resources.
+		**/
+		virtual bool isResPayloadShareable() const { return false; }
+
 		/**
 		* This will add the resource to the resource manager.
 		*
@@ -146,6 +191,31 @@ namespace nrEngine{
 		**/
 		NR_FORCEINLINE void					setResPriority(Priority p){mResPriority = p;}
 
+		/**
+		* Get the resources which are needed by this one. The list is declared by
+		* the resource itself or by its loader while loading.
+		**/
+		NR_FORCEINLINE const std::vector<ResourceDependency>& getResDependencies() const { return mResDependency; }
+
+		/**
+		* Get the number of detail levels of this resource. Level 0 is the
+		* coarsest one, it is loaded through IResourceLoader::loadResource().
+		* Finer levels are streamed in the background afterwards through
+		* IResourceLoader::loadResourceLevel(). Resources without levels have 1.
+		**/
+		NR_FORCEINLINE uint32				getResLevelCount() const { return mResLevelCount; }
+
+		/**
+		* Get the finest detail level which is resident in the memory. All
+		* coarser levels are resident too. Only valid if the resource is loaded.
+		**/
+		NR_FORCEINLINE uint32				getResLevel() const { return mResLevel; }
+
+		/**
+		* Returns true if the resource is loaded with all its detail levels
+		**/
+		NR_FORCEINLINE bool					isResComplete() const { return mResIsLoaded && mResLevel + 1 >= mResLevelCount; }
+
 	protected:
 		friend class ResourceManager;
 		friend class IResourceLoader;
@@ -175,7 +245,7 @@ namespace nrEngine{
 		Priority		mResPriority;
 
 		//! Name of the resource type
-		std::string		mResType;
+		InternedString	mResType;
 
 		/**
 		 * Set the resource type for this resource.
@@ -185,15 +255,90 @@ namespace nrEngine{
 		 **/
 		void	setResourceType(const std::string& type) { mResType = type; }
 
+		//! Resources needed by this one
+		std::vector<ResourceDependency>	mResDependency;
+
+		/**
+		* Declare a resource which is needed by this one. If there is no resource
+		* with such a name, so the manager will load it from the given file.
+		* Dependencies has to be declared while loading, the manager does resolve
+		* them as soon as the resource is loaded.
+		*
+		* @param name Unique name of the needed resource
+		* @param resourceType Type of the needed resource
+		* @param fileName File from which the resource can be loaded
+		* @param group Group to which the loaded resource should belong
+		**/
+		void	declareResDependency(const std::string& name, const std::string& resourceType,
+									const std::string& fileName, const std::string& group = "");
+
+		//! Number of detail levels
+		uint32	mResLevelCount;
+
+		//! Finest resident detail level
+		uint32	mResLevel;
+
+		/**
+		* Declare the number of detail levels of this resource. This has to
+		* be done while loading, the manager does stream the levels above 0
+		* as soon as the resource is loaded.
+		*
+		* @param count Number of levels (at least 1)
+		**/
+		void	declareResLevels(uint32 count) { mResLevelCount = count > 0 ? count : 1; }
+
+		/**
+		* Copy a payload shared with other resources, so it could be changed.
+		* Call this before each change of the payload, also if it was not
+		* taken in shareResPayload(), since other resources could take it
+		* later. The payload type must be copy constructible.
+		*
+		* @param payload Payload of this resource
+		* @return true if the payload was copied
+		**/
+		template<class T>
+		bool detachResPayload(SharedPtr<T>& payload)
+		{
+			changeResPayload();
+			if (payload == NULL || payload.unique()) return false;
+			payload.reset(new T(*payload));
+			return true;
+		}
+
+		/**
+		* Tell the cache that the payload does not match the file anymore,
+		* so it is not shared with other resources.
+		**/
+		void	changeResPayload();
+
 	private:
-		//! Group name to which one this resource own
-		std::string mResGroup;
+		//! Group name to which one this resource own, the same for a lot of resources
+		InternedString mResGroup;
 
 		//! Name of the resource
 		std::string mResName;
 
 	};
 
+	//----------------------------------------------------------------------------------
+	// Inlined access of the holders, the resource has to be known here
+	//----------------------------------------------------------------------------------
+	NR_FORCEINLINE IResource* ResourceHolder::getResource(){
+		touchResource();
+		return selectResource();
+	}
+
+	//----------------------------------------------------------------------------------
+	NR_FORCEINLINE IResource* ResourceHolder::selectResource(){
+
+		// get resource only if it is exists and loaded or if it exists and locked
+		IResource* res = mResource.get();
+		if (res != NULL && (res->isResLoaded() || isLocked())){
+			return res;
+		}
+		return getEmpty();
+	}
+
 };
 
 #endif
@@ -0,0 +1,234 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef _NR_RESOURCE_CACHE_H_
+#define _NR_RESOURCE_CACHE_H_
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "Prerequisities.h"
+#include "ResourceSystem.h"
+
+#include <map>
+#include <boost/thread/mutex.hpp>
+
+//! Magic bytes at the beginning of each cooked file
+#define NR_COOKED_MAGIC "NRCK"
+
+namespace nrEngine{
+
+	//! On-disk cache of resources preprocessed by their loaders
+	/**
+	 * Many loaders does parse a text file each time a resource is loaded.
+	 * Loaders which can store the result in a binary form (cooked form)
+	 * return a version greater than 0 in IResourceLoader::getCookVersion().
+	 * After such a loader has loaded a resource, the cache asks it through
+	 * IResourceLoader::cookResource() for the cooked form and writes it
+	 * into the cache directory.
+	 *
+	 * The cooked files are found by the key of the resource file, which is
+	 * built from its path, size and modification time, the name of the
+	 * loader and its cook version. So the resource file is not readed to
+	 * find its cooked form. If the resource file or the loader are changed,
+	 * the cooked file is not used anymore. As long as they match, the cooked
+	 * file is mapped into the memory and given to
+	 * IResourceLoader::loadCookedResource() instead of loading the resource
+	 * file.
+	 *
+	 * If sharing is enabled, the cache does remember the loaded resources by
+	 * the hash of the content of their file, the resource type and the loader.
+	 * The content is hashed only if the key of the file has changed since it
+	 * was hashed the last time. A resource loaded from a file with the same
+	 * content is not loaded again, it takes the payload of the loaded one
+	 * through IResource::shareResPayload().
+	 * Resources which does not support this are loaded as usual.
+	 *
+	 * The cache is owned by the resource manager, all resources are loaded
+	 * through it. It is disabled until a directory is set, sharing is
+	 * disabled by default.
+	 *
+	 * \ingroup resource
+	 **/
+	class _NRExport ResourceCache{
+		public:
+
+			/**
+			 * Create a disabled cache.
+			 *
+			 * @param manager Manager which does know the loader names
+			 **/
+			ResourceCache(ResourceManager* manager);
+
+			~ResourceCache();
+
+			/**
+			 * Set the directory of the cooked files and enable the cache. The
+			 * directory is created if it does not exist. Empty name disables
+			 * the cache.
+			 *
+			 * @return either OK or FILE_ERROR if the directory could not be created
+			 **/
+			Result setDirectory(const ::std::string& directory);
+
+			/**
+			 * Get the directory of the cooked files (empty if disabled)
+			 **/
+			::std::string getDirectory();
+
+			/**
+			 * Load the resource through its loader. The cooked form is used if
+			 * there is a matching one, otherwise the resource is loaded from its
+			 * file and the cooked form is stored for the next time.
+			 *
+			 * Could be called from any thread.
+			 *
+			 * @param loader Loader of the resource
+			 * @param res Resource to load
+			 * @return result of the loader
+			 **/
+			Result load(ResourceLoader loader, IResource* res);
+
+			/**
+			 * Map the cooked file with the given key into the memory.
+			 *
+			 * @param loaderName Name of the loader
+			 * @param version Cook version of the loader
+			 * @param key Key of the resource file (see getFileKey())
+			 * @return mapping of the whole file, the cooked data does follow
+			 * the header, or an empty pointer if there is no such file
+			 **/
+			SharedPtr<ArchiveMapping> find(const ::std::string& loaderName, uint32 version, uint64 key);
+
+			/**
+			 * Write a cooked file. The file is written under a temporary name
+			 * and renamed then, so it is never readed half written.
+			 *
+			 * @return either OK or FILE_ERROR
+			 **/
+			Result store(const ::std::string& loaderName, uint32 version, uint64 key, const ::std::vector<byte>& data);
+
+			/**
+			 * Enable or disable the sharing of payloads between resources
+			 * loaded from files with the same content. Only resources which
+			 * support it (see IResource::isResPayloadShareable()), like
+			 * mapped file streams, are hashed and shared.
+			 **/
+			void setSharing(bool enable);
+
+			/**
+			 * Check whenever the payloads are shared
+			 **/
+			bool isSharing();
+
+			/**
+			 * Do not share the payload of the given resource anymore, since
+			 * it was changed. Called through IResource::changeResPayload().
+			 **/
+			void forget(ResourceHandle handle);
+
+			/**
+			 * Get the number of loadings which could share the payload
+			 * of an other resource
+			 **/
+			uint32 getSharedCount() const { return mSharedCount; }
+
+			/**
+			 * Get the number of loadings which could use the cooked form
+			 **/
+			uint32 getHitCount() const { return mHitCount; }
+
+			/**
+			 * Get the number of loadings which could not use the cooked form
+			 **/
+			uint32 getMissCount() const { return mMissCount; }
+
+			/**
+			 * Compute the 64 bit FNV-1a hash of the content of a file.
+			 *
+			 * @return false if the file could not be readed
+			 **/
+			static bool hashFile(const ::std::string& fileName, uint64& hash);
+
+			/**
+			 * Compute the key of a file from its path, size and modification
+			 * time. The content of the file is not readed.
+			 *
+			 * @return false if the file does not exist
+			 **/
+			static bool getFileKey(const ::std::string& fileName, uint64& key);
+
+		private:
+
+			//! Header at the beginning of a cooked file
+			struct Header{
+				char	magic[4];
+				uint32	byteOrder;
+				uint32	version;
+				uint32	reserved;
+				uint64	key;
+				uint64	size;
+			};
+
+			//! Get the name of the cooked file
+			::std::string getFileName(const ::std::string& dir, const ::std::string& loaderName, uint32 version, uint64 key);
+
+			//! Load through the cooked form or from the file and cook it
+			Result loadCooked(ResourceLoader loader, IResource* res, const ::std::string& loaderName, uint32 version, uint64 key);
+
+			//! Get the hash of the content of a file, it is only hashed again if the key of the file has changed
+			bool getFileHash(const ::std::string& fileName, uint64 key, uint64& hash);
+
+			//! Key of a payload: loader name and resource type, hash of the file
+			typedef ::std::pair< ::std::string, uint64> PayloadKey;
+
+			//! Take the payload of a loaded resource with the same key
+			bool share(IResource* res, const PayloadKey& key);
+
+			//! Remember the payload of a loaded resource
+			void remember(IResource* res, const PayloadKey& key);
+
+			//! Forget the payload of a resource, the cache has to be locked
+			void forgetPayload(ResourceHandle handle);
+
+			//! Loaded resources by their payload
+			::std::map<PayloadKey, ResourceHandle> mPayload;
+
+			//! Payloads by the resources
+			::std::map<ResourceHandle, PayloadKey> mPayloadKey;
+
+			//! Key and content hash of the files hashed so far
+			::std::map< ::std::string, ::std::pair<uint64, uint64> > mFileHash;
+
+			//! True if payloads are shared
+			bool mSharing;
+
+			uint32 mSharedCount;
+
+			//! Manager knowing the loader names
+			ResourceManager* mManager;
+
+			//! Directory of the cooked files
+			::std::string mDirectory;
+
+			uint32 mHitCount;
+			uint32 mMissCount;
+
+			//! Protects the directory, the payloads and the counters
+			boost::mutex mMutex;
+	};
+
+};
+
+#endif
@@ -0,0 +1,111 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef _NR_RESOURCE_COLLECTOR_H_
+#define _NR_RESOURCE_COLLECTOR_H_
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "Prerequisities.h"
+#include "ResourceSystem.h"
+#include "ITask.h"
+
+namespace nrEngine{
+
+	//! Unload resources which were not used for a long time
+	/**
+	 * Without a memory budget resources stay loaded until the application
+	 * does unload them, also if nobody does use them anymore. The collector
+	 * does find such resources step by step: on each update only a small
+	 * number of slots of the database is scanned. If the access count of a
+	 * resource did not change for the given number of frames, so it is
+	 * unloaded through ResourceManager::unload(). Locked resources, resources
+	 * beeing loaded and resources needed by loaded ones are skipped.
+	 *
+	 * Each update does begin the next frame of the manager, so the pins of
+	 * the last frame are released (see IResourcePtr::pin()). Pinned resources
+	 * are not unloaded. A resource has to be seen twice
+	 * by the collector with the same access count before it could be
+	 * unloaded, so the idle time is at least the given number of frames.
+	 *
+	 * The collector is owned by the resource manager. The engine does add
+	 * it to the kernel as system task with the lowest order. It is disabled
+	 * by default.
+	 *
+	 * \ingroup resource
+	 **/
+	class _NRExport ResourceCollector : public ITask{
+		public:
+
+			/**
+			 * Create a disabled collector. By default 64 slots are scanned
+			 * per update.
+			 *
+			 * @param manager Manager of the resources
+			 **/
+			ResourceCollector(ResourceManager* manager);
+
+			~ResourceCollector();
+
+			/**
+			 * Set the number of frames after which an unused resource is unloaded.
+			 * 0 does disable the collector.
+			 **/
+			void setIdleFrames(uint32 frames) { mIdleFrames = frames; }
+
+			/**
+			 * Get the number of frames after which an unused resource is unloaded
+			 **/
+			uint32 getIdleFrames() const { return mIdleFrames; }
+
+			/**
+			 * Set the number of database slots scanned on each update
+			 **/
+			void setScanCount(uint32 count) { mScanCount = count > 0 ? count : 1; }
+
+			/**
+			 * Get the number of database slots scanned on each update
+			 **/
+			uint32 getScanCount() const { return mScanCount; }
+
+			/**
+			 * Get the number of resources unloaded by the collector
+			 **/
+			uint32 getCollectedCount() const { return mCollected; }
+
+			//! Begin the next frame and scan the next slots
+			Result taskUpdate();
+
+		private:
+
+			//! Manager of the resources
+			ResourceManager* mManager;
+
+			//! Idle time in frames (0 if disabled)
+			uint32 mIdleFrames;
+
+			//! Slots scanned per update
+			uint32 mScanCount;
+
+			//! Next slot to scan
+			uint32 mCursor;
+
+			//! Number of unloaded resources
+			uint32 mCollected;
+	};
+
+};
+
+#endif
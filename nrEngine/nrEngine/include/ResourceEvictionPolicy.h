@@ -0,0 +1,186 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef _NR_RESOURCE_EVICTION_POLICY_H_
+#define _NR_RESOURCE_EVICTION_POLICY_H_
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "Prerequisities.h"
+#include "ResourceSystem.h"
+
+namespace nrEngine{
+
+	//! Information about a loaded resource which could be unloaded by the manager
+	/**
+	 * The resource manager does collect this information for each loaded
+	 * resource, if it has to free memory. Eviction policy decides then
+	 * which of them should be unloaded.
+	 *
+	 * \ingroup resource
+	 **/
+	struct _NRExport ResourceEvictionCandidate{
+		//! Handle of the resource
+		ResourceHandle	handle;
+
+		//! Bytes occupied by the resource
+		std::size_t		size;
+
+		//! How often the resource was accessed
+		uint64			accessCount;
+
+		//! Priority of the resource
+		Priority		priority;
+
+		//! Group of the resource
+		const std::string*	group;
+
+		//! Locked resources must not be unloaded
+		bool			locked;
+	};
+
+	//! Base class for the policies to choose resources which has to be unloaded
+	/**
+	 * If the memory used by the resources exceeds the budget given to
+	 * the ResourceManager, so the manager will ask the eviction policy which
+	 * resources has to be unloaded. Unloaded resources are replaced by their
+	 * empty resources, so the application can still use them. Locked resources
+	 * are never unloaded.
+	 *
+	 * Default implementation does sort the candidates through less() and
+	 * unloads them in this order until enough memory is freed. So derived
+	 * classes have only to define the order.
+	 *
+	 * \ingroup resource
+	 **/
+	class _NRExport ResourceEvictionPolicy{
+		public:
+
+			//! List of candidates
+			typedef std::vector<ResourceEvictionCandidate> CandidateList;
+
+			//! Virtual destructor
+			virtual ~ResourceEvictionPolicy() {}
+
+			/**
+			 * Choose resources which has to be unloaded.
+			 *
+			 * @param candidates All loaded resources, locked ones must not be choosen
+			 * @param bytesToFree Number of bytes which has to be freed to stay
+			 * 			in the budget (0 if the budget is not exceeded)
+			 * @param victims Put here handles of resources to unload
+			 **/
+			virtual void selectVictims(CandidateList& candidates, std::size_t bytesToFree, std::vector<ResourceHandle>& victims);
+
+			/**
+			 * Return true if the policy wants to unload resources even
+			 * if the memory budget is not exceeded. This is asked on each
+			 * change of the resources, so it should only look at the
+			 * totals collected by the statistics.
+			 *
+			 * @param statistics Memory usage of the resources
+			 **/
+			virtual bool isQuotaExceeded(ResourceStatistics& statistics) const { return false; }
+
+		protected:
+
+			/**
+			 * Return true if the resource a should be unloaded before b.
+			 **/
+			virtual bool less(const ResourceEvictionCandidate& a, const ResourceEvictionCandidate& b) const = 0;
+
+			//! Adapter to use less() with std::sort
+			struct Compare{
+				const ResourceEvictionPolicy* policy;
+				bool operator()(const ResourceEvictionCandidate& a, const ResourceEvictionCandidate& b) const{
+					return policy->less(a, b);
+				}
+			};
+
+	};
+
+	//! Unload least used resources first
+	/**
+	 * Resources which were accessed less often are unloaded first.
+	 * This is the default policy of the resource manager.
+	 * \ingroup resource
+	 **/
+	class _NRExport LeastUsedEvictionPolicy : public ResourceEvictionPolicy{
+		protected:
+			bool less(const ResourceEvictionCandidate& a, const ResourceEvictionCandidate& b) const;
+	};
+
+	//! Unload resources with lowest priority first
+	/**
+	 * Resources with lowest priority are unloaded first. For two resources
+	 * of the same priority the least used one is unloaded.
+	 * \ingroup resource
+	 **/
+	class _NRExport PriorityEvictionPolicy : public ResourceEvictionPolicy{
+		protected:
+			bool less(const ResourceEvictionCandidate& a, const ResourceEvictionCandidate& b) const;
+	};
+
+	//! Unload resources with the most bytes per access first
+	/**
+	 * Big resources which are rarely used are unloaded first. So we
+	 * free most memory by unloading the less number of resources.
+	 * \ingroup resource
+	 **/
+	class _NRExport SizeWeightedEvictionPolicy : public ResourceEvictionPolicy{
+		protected:
+			bool less(const ResourceEvictionCandidate& a, const ResourceEvictionCandidate& b) const;
+	};
+
+	//! Keep each resource group in its own memory quota
+	/**
+	 * Each group can get its own quota. Groups which exceeds their quota
+	 * are getting their least used resources unloaded, also if the total
+	 * memory budget is not exceeded. The resources are only collected if
+	 * the total of a group given by the statistics exceeds its quota. If the total budget is still exceeded,
+	 * so the least used resources of all groups are unloaded.
+	 * \ingroup resource
+	 **/
+	class _NRExport GroupQuotaEvictionPolicy : public LeastUsedEvictionPolicy{
+		public:
+
+			/**
+			 * Set the quota for a group.
+			 *
+			 * @param group Name of the group
+			 * @param bytes Maximal number of bytes used by the group (0 to remove the quota)
+			 **/
+			void setQuota(const std::string& group, std::size_t bytes);
+
+			//! Get the quota of a group (0 for no quota)
+			std::size_t getQuota(const std::string& group) const;
+
+			//! @see ResourceEvictionPolicy::selectVictims()
+			void selectVictims(CandidateList& candidates, std::size_t bytesToFree, std::vector<ResourceHandle>& victims);
+
+			//! Check the quotas against the group totals of the statistics
+			bool isQuotaExceeded(ResourceStatistics& statistics) const;
+
+		private:
+
+			//! Quota of each group
+			typedef std::map<std::string, std::size_t> QuotaMap;
+
+			QuotaMap mQuota;
+	};
+
+};
+
+#endif
@@ -0,0 +1,181 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef _NR_RESOURCE_FILE_WATCHER_H_
+#define _NR_RESOURCE_FILE_WATCHER_H_
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "Prerequisities.h"
+#include "ResourceSystem.h"
+#include "ITask.h"
+
+#include <boost/thread/mutex.hpp>
+
+namespace nrEngine{
+
+	//! Reload resources as soon as their files are changed on the disk
+	/**
+	 * ResourceFileWatcher does know the file of each resource in the database
+	 * while it is enabled. The manager does register them when the resources
+	 * are added and removes them when the resources are removed, the entry of
+	 * each resource is kept in its slot. The watcher does watch the directories
+	 * of these files for changes through the inotify interface of the linux
+	 * kernel. Only one watch per directory is used, so also big trees of
+	 * resources are cheap to watch. While the watcher is disabled, so the
+	 * files of new resources are not resolved at all.
+	 *
+	 * Editors and exporters mostly write a file in several steps. So a changed
+	 * file is reloaded only if there was no further change for the debounce
+	 * time. Then the resource and all resources depending on it are reloaded
+	 * in the background by ResourceManager::reloadAsync(). Until they are
+	 * loaded the empty resources are used.
+	 *
+	 * The watcher is owned by the resource manager. The engine does add it
+	 * to the kernel as system task. It is disabled by default.
+	 *
+	 * \ingroup resource
+	 **/
+	class _NRExport ResourceFileWatcher : public ITask{
+		public:
+
+			typedef ::std::multimap< ::std::string, ResourceHandle> FileMap;
+
+			//! Entry of a watched resource, given back by watch()
+			typedef FileMap::iterator WatchEntry;
+
+			/**
+			 * Create the watcher. Default debounce time is 200 milliseconds.
+			 *
+			 * @param manager Manager which has to reload the resources
+			 **/
+			ResourceFileWatcher(ResourceManager* manager);
+
+			//! Stop watching
+			~ResourceFileWatcher();
+
+			/**
+			 * Start watching the files. The files of all resources already
+			 * in the database are added. Changes are not recognized before.
+			 *
+			 * @return either OK or RES_ERROR if the platform does not
+			 * support file watching or inotify could not be initialized
+			 **/
+			Result enable();
+
+			/**
+			 * Stop watching the files. Changes which are not handled yet
+			 * are dropped. Files already known are kept until their
+			 * resources are removed.
+			 **/
+			void disable();
+
+			/**
+			 * Check whenever the files are watched
+			 **/
+			bool isEnabled() const { return mFd >= 0; }
+
+			/**
+			 * Add the file of a resource to the watched files.
+			 *
+			 * @param handle Handle of the resource
+			 * @param fileName File from which the resource was loaded
+			 * @param entry Is set to the entry of the resource
+			 * @return false if the file is not watched, because the watcher
+			 * is disabled or the resource has no file
+			 **/
+			bool watch(ResourceHandle handle, const ::std::string& fileName, WatchEntry& entry);
+
+			/**
+			 * Remove the file of a resource from the watched files
+			 *
+			 * @param entry Entry given by watch()
+			 **/
+			void unwatch(WatchEntry entry);
+
+			/**
+			 * Set the time in milliseconds which a file has to stay unchanged
+			 * before its resources are reloaded.
+			 **/
+			void setDebounceTime(uint32 milliseconds) { mDebounceTime = milliseconds; }
+
+			/**
+			 * Get the debounce time in milliseconds
+			 **/
+			uint32 getDebounceTime() const { return mDebounceTime; }
+
+			/**
+			 * Get number of changed files waiting for the end of the debounce time
+			 **/
+			uint32 getPendingCount();
+
+			//! Read the changes and reload resources of stable files
+			Result taskUpdate();
+
+			//! Stop watching
+			Result taskStop();
+
+		private:
+
+			//! Watched directory
+			struct Directory{
+				//! Watch descriptor (-1 if the watcher is disabled)
+				int32 wd;
+
+				//! Number of watched files in the directory
+				uint32 fileCount;
+			};
+
+			typedef ::std::map< ::std::string, Directory> DirectoryMap;
+			typedef ::std::map<int32, ::std::string> WatchMap;
+			typedef ::std::map< ::std::string, uint64> ChangeMap;
+
+			//! Split the file name in the real path of its directory and the name
+			static void splitPath(const ::std::string& fileName, ::std::string& dir, ::std::string& name);
+
+			//! Add inotify watch for the directory
+			void addWatch(const ::std::string& path, Directory& dir);
+
+			//! Read all events from the inotify descriptor
+			void readEvents(uint64 now);
+
+			//! Manager which does reload the resources
+			ResourceManager* mManager;
+
+			//! Inotify descriptor (-1 if disabled)
+			int32 mFd;
+
+			//! Debounce time in milliseconds
+			uint32 mDebounceTime;
+
+			//! Directories containing watched files
+			DirectoryMap mDirectory;
+
+			//! Directories by their watch descriptors
+			WatchMap mWatch;
+
+			//! Resources by the path of their file
+			FileMap mFile;
+
+			//! Changed files and the time of their last change
+			ChangeMap mChanged;
+
+			//! Protects the maps, resources could be added by any thread
+			boost::mutex mMutex;
+	};
+
+};
+
+#endif
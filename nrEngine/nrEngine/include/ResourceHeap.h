@@ -0,0 +1,265 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef _NR_RESOURCE_HEAP_H_
+#define _NR_RESOURCE_HEAP_H_
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "Prerequisities.h"
+#include "ITask.h"
+
+#include <boost/thread/mutex.hpp>
+
+//! Default size of the chunks allocated by the resource heap
+#define NR_HEAP_CHUNK_SIZE (4 * 1024 * 1024)
+
+//! Alignment of the blocks of the resource heap
+#define NR_HEAP_ALIGNMENT 16
+
+namespace nrEngine{
+
+	//! Handle of a block of the resource heap, 0 is no block
+	typedef uint32 HeapBlock;
+
+	//! Heap for the data of resources which could be defragmented
+	/**
+	 * Resources loaded and unloaded over a long time does fragment the
+	 * general heap, so the process does use much more memory than its
+	 * resources. Resources could allocate their data from this heap
+	 * instead. The heap does give back handles to the blocks and not
+	 * pointers, so the blocks could be moved to close the holes between
+	 * them.
+	 *
+	 * Blocks are allocated one after the other in big chunks. Freed blocks
+	 * leave holes, which are closed by taskUpdate() until the time budget of
+	 * the frame is exceeded: the blocks of the chunk with the most free
+	 * space are moved either into the other chunks, so the chunk could be
+	 * given back to the system, or to the begin of the chunk. Blocks which
+	 * are locked are not moved.
+	 *
+	 * Resources should count their blocks in their data size. The memory
+	 * lost by the holes and the free space of the chunks is given by
+	 * getOverhead(), the resource manager does add it to the memory usage
+	 * checked against the budget.
+	 *
+	 * The heap is owned by the resource manager. The engine does add it to
+	 * the kernel as system task. Its methods could be called from any thread.
+	 *
+	 * \ingroup resource
+	 **/
+	class _NRExport ResourceHeap : public ITask{
+		public:
+
+			/**
+			 * Create an empty heap. Default time budget of the
+			 * defragmentation is 1 millisecond per update.
+			 *
+			 * @param chunkSize Size of the chunks, bigger blocks get an own chunk
+			 **/
+			ResourceHeap(size_t chunkSize = NR_HEAP_CHUNK_SIZE);
+
+			//! Free all chunks
+			~ResourceHeap();
+
+			/**
+			 * Allocate a block.
+			 *
+			 * @param size Size of the block in bytes
+			 * @return Handle of the block or 0 if there is no memory
+			 **/
+			HeapBlock allocate(size_t size);
+
+			/**
+			 * Free a block. The block must not be locked.
+			 **/
+			void free(HeapBlock block);
+
+			/**
+			 * Lock a block, so it is not moved, and get its data. Each
+			 * lock must be followed by an unlock.
+			 *
+			 * @return Data of the block or NULL if the handle is not valid
+			 **/
+			void* lock(HeapBlock block);
+
+			/**
+			 * Unlock a block locked before by lock()
+			 **/
+			void unlock(HeapBlock block);
+
+			/**
+			 * Get the size of a block as it was allocated
+			 **/
+			size_t getSize(HeapBlock block);
+
+			/**
+			 * Get the number of bytes allocated from the system
+			 **/
+			size_t getFootprint();
+
+			/**
+			 * Get the number of bytes of all blocks
+			 **/
+			size_t getUsedBytes();
+
+			/**
+			 * Get the number of bytes allocated from the system but not
+			 * used by blocks
+			 **/
+			size_t getOverhead();
+
+			/**
+			 * Give the chunks without blocks back to the system.
+			 *
+			 * @return Number of freed bytes
+			 **/
+			size_t trim();
+
+			/**
+			 * Defragment until the time budget is exceeded.
+			 *
+			 * @param budget Time budget in microseconds, 0 to defragment completely
+			 **/
+			void compact(uint64 budget);
+
+			/**
+			 * Set the time in microseconds used by each update
+			 * for defragmentation. 0 does disable it.
+			 **/
+			void setTimeBudget(uint64 microseconds) { mTimeBudget = microseconds; }
+
+			/**
+			 * Get the time budget of each update in microseconds
+			 **/
+			uint64 getTimeBudget() const { return mTimeBudget; }
+
+			//! Defragment in the time budget
+			Result taskUpdate();
+
+		private:
+
+			//! Block of the heap
+			typedef struct _Block{
+				//! Chunk of the block or -1 if the block is free
+				int32 chunk;
+
+				//! Offset in the chunk
+				size_t offset;
+
+				//! Size as allocated
+				size_t size;
+
+				//! Number of locks
+				uint32 locks;
+
+				//! Generation of the handle
+				uint32 generation;
+
+				//! Next free block if this one is free
+				uint32 nextFree;
+			} Block;
+
+			//! Chunk of memory allocated from the system
+			typedef struct _Chunk{
+				//! Memory of the chunk
+				byte* data;
+
+				//! Size of the chunk
+				size_t size;
+
+				//! Begin of the free space at the end
+				size_t top;
+
+				//! Bytes used by blocks
+				size_t used;
+
+				//! Blocks of the chunk ordered by their offset
+				::std::vector<uint32> blocks;
+
+				//! True if the last defragmentation of the chunk did not move anything
+				bool settled;
+			} Chunk;
+
+			//! Get the block of a handle or NULL if not valid
+			Block* getBlock(HeapBlock block);
+
+			//! Get the handle of a block
+			HeapBlock makeHandle(uint32 index) const;
+
+			//! Find a chunk with enough space at the end, which is not the given one
+			int32 findChunk(size_t size, int32 except);
+
+			//! Allocate a new chunk
+			int32 createChunk(size_t size);
+
+			//! Give a chunk back to the system
+			void releaseChunk(int32 chunk);
+
+			//! Choose the chunk to defragment next
+			void beginCompaction();
+
+			//! Move the next block of the chunk beeing defragmented
+			bool compactStep();
+
+			//! Finish the defragmentation of the current chunk
+			void endCompaction();
+
+			//! Align the size of a block
+			static size_t align(size_t size) { return (size + NR_HEAP_ALIGNMENT - 1) & ~size_t(NR_HEAP_ALIGNMENT - 1); }
+
+			//! All blocks, block 0 is not used
+			::std::vector<Block> mBlock;
+
+			//! First free block
+			uint32 mFreeBlock;
+
+			//! All chunks, freed chunks have no data
+			::std::vector<Chunk> mChunk;
+
+			//! Default size of the chunks
+			size_t mChunkSize;
+
+			//! Bytes allocated from the system
+			size_t mFootprint;
+
+			//! Bytes used by blocks
+			size_t mUsed;
+
+			//! Chunk beeing defragmented or -1
+			int32 mCompactChunk;
+
+			//! Next block of this chunk to move
+			uint32 mCompactIndex;
+
+			//! Offset where the next block is moved to if not moved into an other chunk
+			size_t mCompactOffset;
+
+			//! Number of blocks at the begin of the block list which stay in the chunk
+			uint32 mCompactKept;
+
+			//! True if a block of the chunk was moved
+			bool mCompactMoved;
+
+			//! Time budget of each update
+			uint64 mTimeBudget;
+
+			//! Protects the heap
+			boost::mutex mMutex;
+	};
+
+};
+
+#endif
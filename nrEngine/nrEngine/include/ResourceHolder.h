@@ -19,12 +19,12 @@
 // Includes
 //----------------------------------------------------------------------------------
 #include "Prerequisities.h"
+#include <boost/atomic.hpp>
 
 namespace nrEngine{
 	
 	/**
-	* This constant defines the size of the lock stack. 
-	* All locking states are stored in the stack, to allow nested lock/unlock calling.
+	* This constant defines the maximal depth of nested lock/unlock calling.
 	* \ingroup resource
 	**/
 	const int32 NR_RESOURCE_LOCK_STACK = 128;
@@ -49,7 +49,7 @@ namespace nrEngine{
 	* to derive any classes from it.
 	*
 	* This system was get from Game Programming Gems 4, and was expanded to be more
-	* flexible and more efficient.
+	* flexible and more efficient. Holders are allocated from a pool.
 	*
 	* \ingroup resource
 	**/
@@ -62,6 +62,15 @@ namespace nrEngine{
 		* public so it can be used by smart pointers
 		**/	
 		~ResourceHolder();
+
+		/**
+		* Holders are allocated from a pool, because the manager does
+		* create a lot of them with the same size.
+		**/
+		static void* operator new(size_t size);
+
+		//! Give the memory of the holder back to the pool
+		static void operator delete(void* p, size_t size);
 	
 	private:
 	
@@ -80,21 +89,22 @@ namespace nrEngine{
 		//! Shared pointer that holds the empty resource object
 		SharedPtr<IResource> mEmptyResource;
 		
-		//! Store number that represents how often the resource was in use
-		uint64		countAccess;
-		
-		//! Store the status if real resources lock stack
-		bool		mLockStack[NR_RESOURCE_LOCK_STACK];
+		//! Store number that represents how often the resource was in use (could be touched by many threads)
+		::boost::atomic<uint64>		countAccess;
+
+		//! Frame of the manager in which the resource was pinned last
+		::boost::atomic<uint32>		mPinFrame;
 		
-		//! Current position in the stack
-		int32		mLockStackTop;
+		//! Number of nested locks, only the depth is needed since each lock does lock the real resource (read by many threads)
+		::boost::atomic<uint32>		mLockDepth;
 		
 		/**
 		* Lock real resource for using. Locking has the effect that the getResource() method
 		* will now return real resources also if it is unloaded.
 		*
 		* @return true if locking was successfull otherwise false
-		* @note If the lock stack is full you are not able lock anymore
+		* @note Locks could be nested up to NR_RESOURCE_LOCK_STACK times,
+		*		further locks fail until the resource is unlocked again.
 		**/
 		bool lockPure();
 		
@@ -104,7 +114,7 @@ namespace nrEngine{
 		*
 		* @return true if unlocking was successfull otherwise false
 		* @note In complement of the locking, you are always able to unlock. 
-		*		If the lock state stack is empty and you are unlocking the resource, so this
+		*		If the resource is not locked and you are unlocking it, so this
 		*		do not affect anything.
 		**/
 		void unlockPure();
@@ -125,7 +135,7 @@ namespace nrEngine{
 		* Return the number of access to this resource
 		**/
 		inline uint64 getAccessCount() const{
-			return countAccess;
+			return countAccess.load(::boost::memory_order_relaxed);
 		}
 		
 		/**
@@ -133,19 +143,37 @@ namespace nrEngine{
 		* we do work that has to be done if a resource was used.
 		**/
 		inline void touchResource(){
-			// count up the access count variable
-			countAccess ++;
+			// count up the access count variable, the order of the counts does not matter
+			countAccess.fetch_add(1, ::boost::memory_order_relaxed);
 		}
 		
 		/**
 		* Check whenever the resource is currently locked
 		**/
 		inline bool isLocked(){
-			if (mLockStackTop > 0) 
-				return mLockStack[mLockStackTop - 1];
-			else
-				return false;
+			return mLockDepth.load(::boost::memory_order_relaxed) > 0;
 		}
+
+		/**
+		* Check whenever the resource is pinned in the given frame of the manager
+		**/
+		inline bool isPinned(uint32 frame) const{
+			return mPinFrame.load(::boost::memory_order_relaxed) == frame;
+		}
+
+		/**
+		* Check whenever the resource must not be unloaded by the manager,
+		* because it is locked or pinned in the given frame
+		**/
+		inline bool isInUse(uint32 frame){
+			return isLocked() || isPinned(frame);
+		}
+
+		/**
+		* Pin the resource in the given frame and get it like getResource().
+		* The access is counted only once per frame.
+		**/
+		IResource* pin(uint32 frame);
 		
 		/**
 		* This will bind this holder to specific empty resource.
@@ -161,7 +189,9 @@ namespace nrEngine{
 		/**
 		 * Returns the empty resource of the resource type holded by this holder.
 		 **/
-		IResource* getEmpty();
+		NR_FORCEINLINE IResource* getEmpty(){
+			return mEmptyResource.get();
+		}
 	
 		
 		/**
@@ -175,8 +205,15 @@ namespace nrEngine{
 		* give you the empty resource back, which still can be NULL or not
 		*
 		* Each call of getResource() method will count up the access number.
+		* The method is inlined, it is defined in Resource.h.
+		**/
+		inline IResource* getResource();
+
+		/**
+		* Get the real resource if it is loaded or locked, otherwise the empty one.
+		* The access is not counted.
 		**/
-		IResource* getResource();
+		inline IResource* selectResource();
 			
 	};
 
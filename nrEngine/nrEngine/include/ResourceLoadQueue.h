@@ -0,0 +1,264 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef _NR_RESOURCE_LOAD_QUEUE_H_
+#define _NR_RESOURCE_LOAD_QUEUE_H_
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "Prerequisities.h"
+#include "ResourceSystem.h"
+#include "ITask.h"
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/unordered_map.hpp>
+
+namespace nrEngine{
+
+	//! Pool of loader threads used by the resource manager
+	/**
+	 * ResourceLoadQueue does load resources in the background. Resources
+	 * requested through ResourceManager::loadResourceAsync() are queued here
+	 * and processed by a small pool of loader threads. Requests with higher
+	 * priority (smaller priority value) are loaded first, requests of the
+	 * same priority in the order they were queued.
+	 *
+	 * The loader threads does only call IResourceLoader::loadResource().
+	 * Finished requests are collected and finalized in taskUpdate(), so in
+	 * the main thread. Finalisation does call IResourceLoader::finalizeResource()
+	 * and hands the resource back to the manager. There the resource is marked
+	 * as loaded, the holder does return the real resource instead of the empty
+	 * one from now on and a ResourceLoadedEvent is sent to the
+	 * NR_RESOURCE_EVENT_CHANNEL. So the database of the manager is never
+	 * changed from the loader threads.
+	 *
+	 * Resources of loaders which are not thread safe (see
+	 * IResourceLoader::isThreadSafe()) are not given to the loader threads.
+	 * They are loaded completely by the finalisation stage.
+	 *
+	 * The finalisation stage is time sliced. On each update the requests are
+	 * finalized in the order of their priority until the time budget is
+	 * exceeded. The rest is done in the next updates. So even if a lot of
+	 * resources are finished at the same time, the frame rate stays smooth.
+	 *
+	 * The queue does also stream the finer detail levels of loaded resources
+	 * (see IResource::getResLevelCount()). Such requests are handled in the
+	 * same way, but through IResourceLoader::loadResourceLevel() and
+	 * IResourceLoader::finalizeResourceLevel(). They are not seen by
+	 * isPending() by default, since the resource is already usable.
+	 *
+	 * The queue is owned by the resource manager. The engine does add it
+	 * to the kernel as system task.
+	 *
+	 * \ingroup resource
+	 **/
+	class _NRExport ResourceLoadQueue : public ITask{
+		public:
+
+			/**
+			 * Create the queue. The threads are started as soon as the
+			 * first request is pushed. Default time budget of the
+			 * finalisation stage is 2 milliseconds.
+			 *
+			 * @param manager Manager which has to get the finished requests
+			 * @param threadCount Number of loader threads
+			 **/
+			ResourceLoadQueue(ResourceManager* manager, uint32 threadCount = 2);
+
+			//! Stop all loader threads, queued requests are dropped
+			~ResourceLoadQueue();
+
+			/**
+			 * Queue a resource to be loaded by its loader.
+			 *
+			 * @param res Resource to load, it has to be in the database
+			 * @param loader Loader which has to load the resource
+			 * @param priority Priority of the request
+			 * @param level Detail level to load or -1 to load the whole resource
+			 **/
+			void push(IResource* res, ResourceLoader loader, Priority priority, int32 level = -1);
+
+			/**
+			 * Remove the request for the given resource. If the resource
+			 * is currently loaded by one of the threads, so wait until
+			 * the thread has finished. The result of a finished but not yet
+			 * handed back request is dropped too. Requests of detail levels are
+			 * removed as well.
+			 *
+			 * @param handle Handle of the resource
+			 * @return true if there was a request to load the whole resource
+			 **/
+			bool cancel(ResourceHandle handle);
+
+			/**
+			 * Finish the request to load the given resource now. A queued
+			 * request is loaded by the calling thread, for a request beeing
+			 * loaded it is waited. Then the request is finalized, so this has
+			 * to be called from the main thread.
+			 *
+			 * @param handle Handle of the resource
+			 * @return true if there was a request for the resource
+			 **/
+			bool finish(ResourceHandle handle);
+
+			/**
+			 * Check whenever the resource is still waiting for loading,
+			 * or is loaded but not handed back to the manager.
+			 *
+			 * @param handle Handle of the resource
+			 * @param levels If true, so check requests of detail levels instead
+			 **/
+			bool isPending(ResourceHandle handle, bool levels = false);
+
+			/**
+			 * Get number of requests which are not finished yet
+			 **/
+			uint32 getPendingCount();
+
+			/**
+			 * Block until the loader threads have loaded all queued requests.
+			 * The requests are finalized by the next calls of taskUpdate().
+			 **/
+			void waitAll();
+
+			/**
+			 * Stop the loader threads. Queued requests are dropped.
+			 **/
+			void shutdown();
+
+			/**
+			 * Set the time which could be spent by the finalisation stage on
+			 * each update. At least one request is finalized per update.
+			 *
+			 * @param microseconds Time budget (0 for no limit)
+			 **/
+			void setTimeBudget(uint32 microseconds) { mTimeBudget = microseconds; }
+
+			/**
+			 * Get the time budget of the finalisation stage in microseconds
+			 **/
+			uint32 getTimeBudget() const { return mTimeBudget; }
+
+			//! Finalize finished requests in the time budget
+			Result taskUpdate();
+
+			//! Stop the loader threads
+			Result taskStop();
+
+		private:
+
+			//! Request to load a resource
+			struct Request{
+				//! Resource to be loaded
+				IResource*		resource;
+
+				//! Loader of the resource
+				ResourceLoader	loader;
+
+				//! Handle of the resource
+				ResourceHandle	handle;
+
+				//! Detail level to load (-1 for the whole resource)
+				int32			level;
+
+				//! Result of the loader
+				Result			result;
+
+				//! True if loadResource() was already called
+				bool			loaded;
+
+				//! Microseconds spent by the loader thread
+				uint64			loadTime;
+			};
+
+			//! Requests are sorted by priority and then by queuing order
+			typedef ::std::pair<uint32, uint64> RequestKey;
+			typedef ::std::map<RequestKey, Request> RequestMap;
+
+			//! Keys of the queued, running and finished requests of each resource
+			typedef ::boost::unordered_multimap<ResourceHandle, RequestKey> RequestIndex;
+
+			//! Remove the requests of the given resource from the map
+			bool eraseRequest(RequestMap& map, ResourceHandle handle);
+
+			//! Find the request of the whole resource or of a level in the map
+			RequestMap::iterator findRequest(RequestMap& map, ResourceHandle handle, bool levels);
+
+			//! Remove the request from the map and from the index
+			void removeRequest(RequestMap& map, RequestMap::iterator it);
+
+			//! Remove all requests of the map
+			void clearRequests(RequestMap& map);
+
+			//! Manager getting the results
+			ResourceManager* mManager;
+
+			//! Requests waiting for a loader thread
+			RequestMap mQueued;
+
+			//! Handle and level of a request beeing loaded
+			typedef ::std::pair<ResourceHandle, int32> RunningKey;
+
+			//! Requests beeing loaded at now
+			::std::vector<RunningKey> mRunning;
+
+			//! Requests which has to be finalized in the main thread
+			RequestMap mFinished;
+
+			//! Requests by the handle, so the resource is found without a scan
+			RequestIndex mIndex;
+
+			//! Counter giving the queuing order
+			uint64 mOrder;
+
+			//! Number of loader threads to start
+			uint32 mThreadCount;
+
+			//! Time budget of the finalisation stage in microseconds
+			uint32 mTimeBudget;
+
+			//! Loader threads
+			boost::thread_group mThreads;
+
+			//! True if the threads are started
+			bool mStarted;
+
+			//! True if the threads has to stop
+			bool mShutdown;
+
+			//! Protects all the lists
+			boost::mutex mMutex;
+
+			//! Signaled if a new request is queued
+			boost::condition_variable mQueueSignal;
+
+			//! Signaled if a request is finished
+			boost::condition_variable mFinishSignal;
+
+			//! Main function of the loader threads
+			void run();
+
+			//! Load the resource if not done yet and hand it back to the manager
+			void finalize(Request& req);
+
+			//! Check if the handle is in the running list
+			bool isRunning(ResourceHandle handle) const;
+	};
+
+};
+
+#endif
@@ -107,6 +107,102 @@ namespace nrEngine{
 		* @return either OK or an error code
 		**/
 		virtual Result loadResource(IResource* resource);
+
+
+		/**
+		* This method is called in the main thread after the resource was loaded
+		* through loadResource(). Derived loaders could do here the work which
+		* must not be done in the loader threads, for example using the rendering
+		* context. Default implementation does nothing.
+		*
+		* @param resource Pointer to the loaded resource
+		* @return either OK or an error code
+		**/
+		virtual Result finalizeResource(IResource* resource) { return OK; }
+
+
+		/**
+		* Return true if loadResource() could be called from the loader threads
+		* of the ResourceLoadQueue. Otherwise resources loaded asynchronously by
+		* this loader are loaded in the main thread by the finalisation stage
+		* of the queue. Default is false, so a loader has to declare that its
+		* loadResource() does not touch the kernel or other engine parts,
+		* which are not protected against the loader threads.
+		**/
+		virtual bool isThreadSafe() const { return false; }
+
+
+		/**
+		* Return the version of the cooked form of the resources created by this
+		* loader. Loaders returning a version greater than 0 are asked for the
+		* cooked form after loading and get it back through loadCookedResource()
+		* instead of loading the resource file again (see ResourceCache). The
+		* version has to be increased as soon as the cooked form is changed.
+		* Default is 0, so nothing is cooked.
+		**/
+		virtual uint32 getCookVersion() const { return 0; }
+
+
+		/**
+		* Store a loaded resource in a binary form, which could be loaded faster
+		* than the resource file. Default does cook nothing.
+		*
+		* @param resource Resource loaded by loadResource()
+		* @param data Here the cooked form has to be stored
+		* @return OK if the resource was cooked
+		**/
+		virtual Result cookResource(IResource* resource, std::vector<byte>& data) { return RES_ERROR; }
+
+
+		/**
+		* Load a resource from its cooked form instead of loadResource().
+		* The data is mapped from the cache and valid only during this call.
+		*
+		* @param resource Resource to be loaded
+		* @param data Cooked form stored by cookResource()
+		* @param size Size of the cooked form
+		* @return either OK or an error code, then the resource is loaded
+		* through loadResource()
+		**/
+		virtual Result loadCookedResource(IResource* resource, const byte* data, size_t size) { return RES_ERROR; }
+
+
+		/**
+		* Load a finer detail level of a resource which has declared more than
+		* one level (see IResource::getResLevelCount()). The levels are loaded
+		* one after another by the loader threads of the ResourceLoadQueue, so the
+		* resource is used by the application at the same time. Therefor the
+		* data of the level should only be prepared here and made visible in
+		* finalizeResourceLevel(). If the resource is unloaded in the meantime,
+		* finalizeResourceLevel() is not called, so the resource has to free
+		* such data while unloading. Default does not support levels.
+		*
+		* @param resource Loaded resource
+		* @param level Level to be loaded, all coarser levels are resident
+		* @return either OK or an error code
+		**/
+		virtual Result loadResourceLevel(IResource* resource, uint32 level) { return RES_ERROR; }
+
+
+		/**
+		* Called in the main thread after loadResourceLevel(). Here the new
+		* level should be given to the resource and its data size updated.
+		* Default does nothing.
+		**/
+		virtual Result finalizeResourceLevel(IResource* resource, uint32 level) { return OK; }
+
+
+		/**
+		* Free the memory of a detail level. The manager does drop the finest
+		* levels of resources before it does unload whole resources, if the
+		* memory budget is exceeded. The data size of the resource has to be
+		* updated. Default does not support levels.
+		*
+		* @param resource Resource of the level
+		* @param level Finest resident level, which has to be freed
+		* @return either OK or an error code
+		**/
+		virtual Result unloadResourceLevel(IResource* resource, uint32 level) { return RES_ERROR; }
 	
 		
 		/**
@@ -150,6 +246,21 @@ namespace nrEngine{
 		* @return Instance of such a resource
 		**/
 		virtual IResource* createResourceInstance(const std::string& resourceType, NameValuePairs* params = NULL) const = 0;
+
+		/**
+		* Create an instance of a resource which is loaded from the given file.
+		* Loaders could choose here the implementation by the file, e.g. by its
+		* size. Default implementation does ignore the file name.
+		*
+		* @param resourceType Unique name of the resource type to be created
+		* @param fileName Name of the file from which the resource is loaded
+		* @param params Parameters for the creating functions or NULL
+		* @return Instance of such a resource
+		**/
+		virtual IResource* createResourceInstance(const std::string& resourceType, const std::string& fileName, NameValuePairs* params) const
+		{
+			return createResourceInstance(resourceType, params);
+		}
 		
 		
 		/**
@@ -219,6 +330,14 @@ namespace nrEngine{
 		* change properties of resources from any loader.
 		**/
 		void setResourceEmpty(IResource* res, bool b);
+
+		/**
+		* Declare a resource needed by the loaded one. Call this while loading, if
+		* the loader does find out that the resource needs other resources.
+		* @see IResource::declareResDependency()
+		**/
+		void declareDependency(IResource* res, const std::string& name, const std::string& resourceType,
+								const std::string& fileName, const std::string& group = "");
 	
 	};
 
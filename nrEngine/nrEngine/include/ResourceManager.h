@@ -21,6 +21,14 @@
 #include "Prerequisities.h"
 #include "ResourceSystem.h"
 
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/future.hpp>
+#include <boost/atomic.hpp>
+
+//! Number of shards of the resource database (has to be a power of two)
+#define NR_RESOURCE_SHARDS 16
+
 namespace nrEngine {
 
 	//! General pointer/handle based resource management system
@@ -58,6 +66,17 @@ namespace nrEngine {
 	*			   unload function for the whole group.
 	*			 - Groups must not be disjoint, so you can have same resource in different groups.
 	*
+	* <b>-</b> Multi threaded access:
+	*		@par - The database is split in NR_RESOURCE_SHARDS shards. The shard of a resource
+	*			   is choosen by the hash of its name. Each shard has its own read/write lock,
+	*			   so lookups through getByName() and getByHandle() from different threads
+	*			   does not block each other.
+	*			 - Creating, loading and removing of resources is thread safe too. Only
+	*			   the shard of the resource is locked for writing.
+	*			 - Loaders, groups and empty resources are protected by their own locks.
+	*			 - Unloading or reloading of the same resource has to be done by one thread
+	*			   at a time. Asynchronously loaded resources are handed back in the main thread.
+	*
 	* \ingroup resource
 	**/
 	class _NRExport ResourceManager : public ISingleton<ResourceManager>{
@@ -110,10 +129,35 @@ namespace nrEngine {
 
 
 		/**
-		* Returns the usage of memory in bytes.
+		* Returns the usage of memory in bytes. This is the sum of the sizes of
+		* all resources, unloaded resources does count with their current size.
+		* The memory of the resource heap not used by blocks is added too.
 		**/
 		size_t	 getMemoryUsage() const;
 
+		/**
+		* Get the statistics about the memory usage by groups, resource types
+		* and loaders.
+		**/
+		SharedPtr<ResourceStatistics> getStatistics() const { return mStatistics; }
+
+
+		/**
+		* Set the policy which decides which resources has to be unloaded
+		* if the memory budget is exceeded. Unloaded resources are replaced
+		* by their empty resources. Locked resources are never unloaded.
+		* Default policy is LeastUsedEvictionPolicy.
+		*
+		* @param policy Smart pointer to the policy (NULL disables unloading)
+		**/
+		void	setEvictionPolicy(SharedPtr<ResourceEvictionPolicy> policy);
+
+
+		/**
+		* Get the policy used to unload resources if the budget is exceeded
+		**/
+		SharedPtr<ResourceEvictionPolicy> getEvictionPolicy() const;
+
 
 		/**
 		* Here you can register any loader by the manager. Loader are used to load resources
@@ -129,7 +173,8 @@ namespace nrEngine {
 		*			- BAD_PARAMETERS
 		*
 		* @note If there is two loaders which do support loading of file of the same filetype,
-		*		 so the behavior of getting appropriate loader is undefined.
+		*		 so the first registered one is used. The supported types are read
+		*		 while registering, so the loader has to declare them before.
 		**/
 		Result	registerLoader	(const ::std::string& name, ResourceLoader loader);
 
@@ -208,9 +253,9 @@ namespace nrEngine {
 		/**
 		* Load a resource from a file. For loading of a resource the registered
 		* loader will be used. The filetype is defined by the last
-		* characters of the file name. If we can not find this characters
-		* so the manual loader will be used if such one is specified. Manual loader
-		* will also be used if it is specified and filetype is detected.
+		* characters of the file name after the dot. If there is no loader for
+		* this filetype, so the loader of the resource type will be used. Manual
+		* loader will always be used if it is specified.
 		* You can assign your resource to special group. The group names
 		* has to be unique.
 		*
@@ -238,6 +283,43 @@ namespace nrEngine {
 										NameValuePairs* params = NULL,
 										ResourceLoader manualLoader = ResourceLoader());
 
+		/**
+		* Load a resource in the background. The resource is created and stored
+		* in the database like by loadResource(), but the loading itself is done
+		* by the loader threads of the ResourceLoadQueue. Until the loading is
+		* complete, the returned pointer does give the empty resource of that
+		* resource type. Afterwards the holder does switch to the real resource
+		* and a ResourceLoadedEvent is sent to the NR_RESOURCE_EVENT_CHANNEL.
+		*
+		* The loader of the resource has to be able to load resources in
+		* another thread than the main thread.
+		*
+		* If a resource with the given name already exists, so the existing
+		* resource is returned.
+		*
+		* @param name Unique name fo the resource
+		* @param group Group name to which this resource should be assigned
+		* @param resourceType Unique type name of the resource
+		* @param fileName File name of the file to be loaded
+		* @param params Parameters which will be send to the loader/creator
+		* @param manualLoader Loader which should be used instead of the registered ones
+		* @param priority Requests with higher priority are loaded first
+		*
+		* @return Pointer to the resource or NULL if the resource could not be created
+		**/
+		IResourcePtr	loadResourceAsync(const ::std::string& name,
+										const ::std::string& group,
+										const ::std::string& resourceType,
+										const ::std::string& fileName,
+										NameValuePairs* params = NULL,
+										ResourceLoader manualLoader = ResourceLoader(),
+										Priority priority = Priority::NORMAL);
+
+		/**
+		* Get the queue used to load the resources in the background.
+		**/
+		SharedPtr<ResourceLoadQueue> getLoadQueue() const { return mLoadQueue; }
+
 		/**
 		* This function will add a given resource to the resource management system.
 		* From now one resource management get the rights for unloading/reloading and
@@ -364,6 +446,116 @@ namespace nrEngine {
 		//! @see reload(name)
 		virtual Result		reload(ResourceHandle& handle);
 
+		/**
+		* Reload the resource in the background. The resource is unloaded and
+		* given to the ResourceLoadQueue, so the empty resource is used until
+		* the loader threads has loaded it again.
+		*
+		* @param handle Handle of the resource
+		* @param priority Priority of the load request
+		* @return either OK or error code:
+		*		- RES_NOT_FOUND
+		**/
+		virtual Result		reloadAsync(ResourceHandle handle, Priority priority = Priority::NORMAL);
+
+		/**
+		* Reload the given resources and all resources depending on them in
+		* the background. A dependent resource is given to the ResourceLoadQueue
+		* not before all of its dependencies, which are reloaded too, has
+		* finished loading. So its loader does already see the new data.
+		* Each resource is reloaded only once.
+		*
+		* @param handles Handles of the resources which has changed
+		* @param priority Priority of the load requests
+		**/
+		void reloadDependentsAsync(const ::std::vector<ResourceHandle>& handles, Priority priority = Priority::NORMAL);
+
+		/**
+		* Stream the detail levels of a loaded resource, which are not resident.
+		* The manager does this automatically after a resource is loaded. Levels
+		* dropped because of the memory budget are streamed again only through
+		* this method, so the application decides when they are needed again.
+		*
+		* @param handle Handle of the resource
+		* @param priority Priority of the load requests
+		* @return either OK or error code:
+		*		- RES_NOT_FOUND
+		*		- RES_IS_EMPTY if the resource is not loaded
+		**/
+		virtual Result		streamLevels(ResourceHandle handle, Priority priority = Priority::NORMAL);
+
+		/**
+		* Get the watcher reloading resources if their files are changed.
+		**/
+		SharedPtr<ResourceFileWatcher> getFileWatcher() const { return mFileWatcher; }
+
+		/**
+		* Get the cache of the cooked resources. All resources are loaded
+		* through it, it is disabled until its directory is set.
+		**/
+		SharedPtr<ResourceCache> getCache() const { return mCache; }
+
+		/**
+		* Get the queue releasing the data of unloaded resources in the background.
+		* Resources and loaders could give it the release of big data or libraries.
+		**/
+		SharedPtr<ResourceReclaimQueue> getReclaimQueue() const { return mReclaimQueue; }
+
+		/**
+		* Get the preloader recording the resources used at the start, so they
+		* could be preloaded on the next start.
+		**/
+		SharedPtr<ResourcePreloader> getPreloader() const { return mPreloader; }
+
+		/**
+		* Get the collector unloading resources which were not used for a long time.
+		**/
+		SharedPtr<ResourceCollector> getCollector() const { return mCollector; }
+
+		/**
+		* Get the heap which could be used by resources for their data.
+		**/
+		SharedPtr<ResourceHeap> getHeap() const { return mHeap; }
+
+		/**
+		* Get the current frame. Resources pinned through IResourcePtr::pin()
+		* in this frame are not unloaded by the manager itself. The next frame
+		* is begun by the ResourceCollector task, which runs before the tasks
+		* of the application.
+		**/
+		uint32 getFrame() const { return mFrame.load(::boost::memory_order_relaxed); }
+
+		/**
+		* Declare that a resource needs another one. The needed resource is reference
+		* counted by its dependents. Mostly dependencies are declared by the resources
+		* or their loaders through IResource::declareResDependency() while loading.
+		* The manager does then find or load the needed resources by itself: in the
+		* background, in parallel on the loader threads, if the resource was loaded
+		* through loadResourceAsync(). The ResourceLoadedEvent of such a resource is
+		* sent when all its dependencies are loaded too.
+		*
+		* If a resource is unloaded, so the resources which were loaded only because of
+		* it, and are not needed by other loaded resources, are unloaded too. If it is
+		* removed, so such resources without other dependents are removed.
+		*
+		* @param resource Handle of the resource
+		* @param dependency Handle of the resource needed by the first one
+		* @return either OK or error code:
+		*		- RES_NOT_FOUND
+		*		- BAD_PARAMETERS if the dependency would give a cycle
+		**/
+		Result addDependency(ResourceHandle resource, ResourceHandle dependency);
+
+		/**
+		* Add the handles of the resources needed by the given one to the list.
+		**/
+		void getDependencies(ResourceHandle handle, ::std::vector<ResourceHandle>& dependencies);
+
+		/**
+		* Add the handles of the resources depending on the given one to the list.
+		**/
+		void getDependents(ResourceHandle handle, ::std::vector<ResourceHandle>& dependents);
+
 
 		/**
 		* This will remove the resource from the database.
@@ -393,14 +585,15 @@ namespace nrEngine {
 		*
 		* @param name Unique name of the resource
 		*
-		* @note At now you need a time of O(2n), where n is number of resources.
-		*		 Performance can became better by using of hash_map O(1)
+		* @note Names are stored in a hash map, so this takes O(1)
 		**/
 		virtual IResourcePtr	getByName(const ::std::string& name);
 
 
 		/**
 		* Same as getByName(), but here you get the resource by handle.
+		* The handle does directly index the database, so this takes O(1).
+		* Handles of removed resources give NULL, also if the slot is reused.
 		**/
 		virtual IResourcePtr	getByHandle(const ResourceHandle& handle);
 
@@ -426,6 +619,61 @@ namespace nrEngine {
 		**/
 		virtual Result		removeGroup(const ::std::string& group);
 
+		//! Future giving the result of a group operation in the background
+		typedef ::boost::shared_future<Result> GroupFuture;
+
+		/**
+		* Load all resources listed in a manifest file into a group. The resources
+		* are created at once and loaded in the background by the loader threads,
+		* at most getGroupConcurrency() of them at the same time. Resources which
+		* are already loaded are not loaded again.
+		*
+		* Each line of the manifest does describe one resource:
+		*	<tt>name resourceType fileName [group]</tt>
+		* Fields containing spaces are written in double quotes, where \" and
+		* \\ are escaped. Everything after // outside of quotes is a comment,
+		* empty lines are ignored. The group column is ignored here.
+		*
+		* The group is complete as soon as all its resources and their
+		* dependencies are loaded. This is done in the finalisation stage of the
+		* ResourceLoadQueue, so the main thread must not block on the future,
+		* but should check it on each update.
+		*
+		* @param group Name of the group
+		* @param manifest Name of the manifest file
+		* @param priority Priority of the load requests
+		* @return Future giving OK or the first error of the group
+		**/
+		virtual GroupFuture	loadGroup(const ::std::string& group, const ::std::string& manifest, Priority priority = Priority::NORMAL);
+
+		/**
+		* Same as loadGroup(group, manifest), but the resources are given directly.
+		* The group of each entry is ignored.
+		**/
+		virtual GroupFuture	loadGroup(const ::std::string& group, const ::std::vector<ResourceDependency>& resources, Priority priority = Priority::NORMAL);
+
+		/**
+		* Reload all elements of the group in the background. Like in loadGroup()
+		* at most getGroupConcurrency() of them are loaded at the same time.
+		*
+		* @param group Unique name of the group
+		* @param priority Priority of the load requests
+		* @return Future giving OK, RES_GROUP_NOT_FOUND or the first error of the group
+		**/
+		virtual GroupFuture	reloadGroupAsync(const ::std::string& group, Priority priority = Priority::NORMAL);
+
+		/**
+		* Set the number of resources of one group operation, which could be
+		* loaded at the same time. So other requests are not blocked by big
+		* groups. Default is 8.
+		**/
+		void	setGroupConcurrency(uint32 count) { mGroupConcurrency = count > 0 ? count : 1; }
+
+		/**
+		* Get the number of resources of one group operation loaded at the same time
+		**/
+		uint32	getGroupConcurrency() const { return mGroupConcurrency; }
+
 
 
 		/**
@@ -448,24 +696,124 @@ namespace nrEngine {
 		// Variables
 		//------------------------------------------
 		size_t		mMemBudget;
-		size_t		mMemUsage;
 
-		ResourceHandle	mLastHandle;
+		SharedPtr<ResourceStatistics>	mStatistics;
+
+		SharedPtr<ResourceEvictionPolicy>	mEvictionPolicy;
+
+		SharedPtr<ResourceLoadQueue>	mLoadQueue;
+
+		SharedPtr<ResourceFileWatcher>	mFileWatcher;
+
+		SharedPtr<ResourceCache>	mCache;
+
+		SharedPtr<ResourceReclaimQueue>	mReclaimQueue;
+
+		SharedPtr<ResourcePreloader>	mPreloader;
+
+		SharedPtr<ResourceCollector>	mCollector;
+
+		SharedPtr<ResourceHeap>	mHeap;
+
+		//! Current frame, resources pinned in it are not unloaded
+		::boost::atomic<uint32>	mFrame;
+
+		//! Begin the next frame, called by the ResourceCollector
+		void nextFrame() { mFrame.fetch_add(1, ::boost::memory_order_relaxed); }
 
 		typedef ::std::map< ::std::string, ResourceLoader> loader_map;
 
 		loader_map	mLoader;
 
+		//! Protects the loader maps, loaders are mostly read
+		::boost::shared_mutex	mLoaderMutex;
+
+		typedef ::boost::unordered_map< ::std::string, ResourceLoader> loader_type_map;
+
+		//! Loaders by supported file types and resource types
+		loader_type_map	mLoaderByFileType;
+		loader_type_map	mLoaderByResType;
+
 
-		typedef ::std::map<ResourceHandle, SharedPtr<ResourceHolder> > 	res_hdl_map;
-		typedef ::std::map< ::std::string, ResourceHandle>						res_str_map;
-		typedef ::std::map< ::std::string, ::std::list<ResourceHandle> >	 		res_grp_map;
+		//! Slot of the resource database, a handle is the slot index and its generation.
+		//! Slots are only used through pointers, so the slot is defined by the source.
+		struct ResourceSlot;
+
+		//! Resources of a group, they are linked through their slots
+		typedef struct _GroupList{
+			//! First and last slot of the group
+			uint32 first;
+			uint32 last;
+
+			//! Number of resources in the group
+			uint32 count;
+		} GroupList;
+
+		typedef ::boost::unordered_map< ::std::string, ResourceHandle>		res_str_map;
+		typedef ::std::map< ::std::string, GroupList>	 		res_grp_map;
 		typedef ::std::map< ::std::string, SharedPtr<IResource> >		res_empty_map;
 
-		res_hdl_map	mResource;
-		res_str_map mResourceName;
+		typedef ::boost::shared_lock< ::boost::shared_mutex>	ReadLock;
+		typedef ::boost::unique_lock< ::boost::shared_mutex>	WriteLock;
+
+		//! Part of the database. Slot i*NR_RESOURCE_SHARDS + k belongs to the shard k
+		typedef struct _ResourceShard{
+			//! Lock of the names and the slots of this shard
+			::boost::shared_mutex lock;
+
+			//! Names of the resources of this shard
+			res_str_map names;
+
+			//! Number of slots used by this shard
+			uint32 slotCount;
+
+			//! First free slot of this shard
+			uint32 freeSlot;
+		} ResourceShard;
+
+		ResourceShard	mShard[NR_RESOURCE_SHARDS];
+
+		//! Slots are allocated in pages, so they are never moved while other threads read them
+		::std::vector<ResourceSlot*>	mSlotPage;
+		::boost::mutex	mPageMutex;
+
+		//! Groups and the links of the slots in them are protected by the group mutex
 		res_grp_map mResourceGroup;
+		::boost::mutex	mGroupMutex;
+
 		res_empty_map mEmptyResource;
+		::boost::mutex	mEmptyMutex;
+
+		//! Node of the dependency graph
+		typedef struct _DependencyNode{
+			//! Resources needed by this one
+			::std::vector<ResourceHandle> dependsOn;
+
+			//! Resources needing this one, they does hold a reference
+			::std::vector<ResourceHandle> dependents;
+
+			//! Number of dependencies which are still loaded in the background
+			uint32 waiting;
+
+			//! Result reported when all dependencies are loaded
+			Result result;
+
+			//! True if the manager did load the resource because it was needed
+			bool automatic;
+
+			//! Number of dependencies which has to be reloaded before this one
+			uint32 reloadWaiting;
+
+			//! Priority of the reload waiting for the dependencies
+			Priority reloadPriority;
+
+			_DependencyNode() : waiting(0), result(OK), automatic(false), reloadWaiting(0) {}
+		} DependencyNode;
+
+		typedef ::boost::unordered_map<ResourceHandle, DependencyNode>	res_dep_map;
+
+		res_dep_map	mDependency;
+		::boost::mutex	mDependencyMutex;
 
 
 		//------------------------------------------
@@ -482,11 +830,162 @@ namespace nrEngine {
 		**/
 		void removeAllLoaders();
 
+		/**
+		* Add file types and resource types of the loader to the lookup tables
+		**/
+		void addLoaderTypes(ResourceLoader loader);
+
+
+		//! Load queue does hand back the loaded resources
+		friend class ResourceLoadQueue;
+		friend class ResourceCache;
+		friend class ResourcePreloader;
+		friend class ResourceCollector;
+		friend class ResourceFileWatcher;
+
+		/**
+		* Called in the main thread if the load queue has finished loading
+		* of a resource. The resource is marked as loaded, so the holder does
+		* give the real resource from now on, and a ResourceLoadedEvent is sent.
+		*
+		* @param handle Handle of the loaded resource
+		* @param result Result returned by the loader
+		* @param loadTime Microseconds spent by the loader
+		**/
+		void finishAsyncLoad(ResourceHandle handle, Result result, uint64 loadTime);
+
+		/**
+		* Called in the main thread if the load queue has loaded a detail level.
+		* The level becomes resident and the next one is queued.
+		*
+		* @param handle Handle of the resource
+		* @param level Loaded level
+		* @param result Result returned by the loader
+		**/
+		void finishLevelLoad(ResourceHandle handle, uint32 level, Result result);
+
+		/**
+		* Drop the finest detail levels of unlocked resources in the order
+		* given by the eviction policy, until the given number of bytes is freed
+		* or there are no levels to drop anymore.
+		*
+		* @return Number of freed bytes
+		**/
+		size_t dropLevels(size_t bytesToFree);
+
+		/**
+		* Collect the loaded resources which could be given to the eviction policy.
+		* Resources needed by other loaded resources are not collected.
+		*
+		* @param levelsOnly Collect only resources with resident levels above 0
+		**/
+		void getEvictionCandidates(::std::vector<ResourceEvictionCandidate>& candidates, bool levelsOnly);
+
+		/**
+		* Report the current size and state of the resource to the statistics
+		**/
+		void updateUsage(ResourceHandle handle);
+
+		/**
+		* Report the current size and state of the resource to the statistics.
+		* Nothing happens if the handle is not valid anymore.
+		**/
+		void updateUsage(ResourceHandle handle, IResource* res);
+
+		/**
+		* Report the loading time of the resource to the statistics
+		**/
+		void addLoadTime(ResourceHandle handle, uint64 microseconds);
+
+		/**
+		* Let the file watcher watch the files of all resources which are
+		* not watched yet. Called by the watcher if it gets enabled.
+		**/
+		void watchResources();
+
+		/**
+		* Get the name under which the loader is registered
+		**/
+		::std::string getLoaderName(ResourceLoader loader);
+
+		/**
+		* Let the resource take the payload of the given loaded one.
+		* Called by the ResourceCache.
+		*
+		* @return true if the payload is shared
+		**/
+		bool sharePayload(ResourceHandle source, IResource* res);
+
+		/**
+		* Check whenever the resource with the given handle is loaded
+		* and could share its payload
+		**/
+		bool isPayloadLoaded(ResourceHandle handle);
+
+		/**
+		* Notify the resources waiting for the given one, that it is loaded.
+		* Resources which does not wait for other dependencies anymore are
+		* reported as loaded through ResourceLoadedEvent.
+		*
+		* @param handle Handle of the resource
+		* @param result Result of the loading
+		**/
+		void completeAsyncLoad(ResourceHandle handle, Result result);
+
+		/**
+		* Reload the dependents which were waiting only for the given resource
+		* (see reloadDependentsAsync()).
+		**/
+		void continueReload(ResourceHandle handle);
+
+		/**
+		* Find or load all resources declared as dependencies by the given resource
+		* and link them in the dependency graph. Missing resources are loaded in the
+		* background if async is true.
+		*
+		* @param handle Handle of the resource
+		* @param async Load missing dependencies through the load queue
+		* @return Number of dependencies which are not loaded yet
+		**/
+		uint32 resolveDependencies(ResourceHandle handle, bool async);
+
+		/**
+		* Release the dependencies of an unloaded or removed resource. Dependencies
+		* which were loaded by the manager are unloaded if no loaded resource does
+		* need them anymore. If remove is true, so the links are removed and
+		* dependencies without other dependents are removed too.
+		**/
+		void releaseDependencies(ResourceHandle handle, bool remove);
+
+		/**
+		* Check whenever a loaded resource does depend on the given one, so that
+		* it could not be unloaded alone
+		**/
+		bool isNeeded(ResourceHandle handle);
+
+		/**
+		* Check whenever the resource a does depend on b. The dependency lock has to be held.
+		**/
+		bool isDependent(ResourceHandle a, ResourceHandle b);
+
+		/**
+		* Get the loader for a resource. Manual loader is used if it is specified,
+		* otherwise the loader supporting the filetype and at last the loader
+		* supporting the resource type.
+		*
+		* @param resourceType Unique type name of the resource
+		* @param fileName File name of the file to be loaded
+		* @param manualLoader Loader given by the user (could be NULL)
+		**/
+		ResourceLoader findLoader(const ::std::string& resourceType,
+									const ::std::string& fileName,
+									ResourceLoader manualLoader);
 
 		/**
 		* Check if we have now memory available.
 		* If we need to remove some resources from the memory to get free place
-		* so do it.
+		* so do it. The eviction policy decides which of the loaded and not
+		* locked resources are unloaded.
 		**/
 		virtual Result checkMemoryUsage();
 
@@ -508,16 +1007,56 @@ namespace nrEngine {
 
 		/**
 		* Get the appropriate holder for the given resource name.
-		* This is a internal function, so it will return a pointer to a smart pointer
-		* pointing to the holder. This is done because of performance reasons.
+		* The holder is copied under the lock of the shard, so it stays valid
+		* even if the resource is removed by another thread.
 		* If nothing found NULL will be returned.
 		**/
-		SharedPtr<ResourceHolder>*	getHolderByName(const ::std::string& name);
+		SharedPtr<ResourceHolder>	getHolderByName(const ::std::string& name);
+
+		/**
+		* Same as getHolderByName(...) but now get the holder through a handle.
+		* Handles of removed resources are detected by the generation of the slot.
+		**/
+		SharedPtr<ResourceHolder>	getHolderByHandle(const ResourceHandle& handle);
+
+		/**
+		* Get the shard of a resource name
+		**/
+		uint32 getShard(const ::std::string& name) const;
+
+		/**
+		* Get a slot by its index. The shard of the slot has to be locked.
+		**/
+		ResourceSlot& getSlot(uint32 slot);
+		const ResourceSlot& getSlot(uint32 slot) const;
+
+		/**
+		* Get a free slot in the shard of the name and return the handle for it.
+		* @return 0 if the shard has no free slot anymore
+		**/
+		ResourceHandle createHandle(const ::std::string& name);
+
+		/**
+		* Free the slot of the handle, so the handle gets invalid. The name
+		* is removed from the shard together with the slot.
+		**/
+		void releaseHandle(ResourceHandle handle, const ::std::string& name = "");
+
+		/**
+		* Copy the handles of a group.
+		* @return false if there is no such group
+		**/
+		bool getGroupHandles(const ::std::string& group, ::std::list<ResourceHandle>& handles);
+
+		/**
+		* Get the current handle of a slot
+		**/
+		ResourceHandle makeHandle(uint32 slot) const;
 
 		/**
-		* Same as getHolderByName(...) but now get the holder through a handle
+		* Store the holder in the slot of the handle and register the name and the group
 		**/
-		SharedPtr<ResourceHolder>*	getHolderByHandle(const ResourceHandle& handle);
+		void insertResource(ResourceHandle handle, const ::std::string& name, const ::std::string& group, SharedPtr<ResourceHolder> holder);
 
 
 		/**
@@ -543,6 +1082,86 @@ namespace nrEngine {
 		* can do it here
 		* @see loadResource()
 		**/
+		/**
+		* Create a resource which has to be loaded in the background and store
+		* it in the database. The resource is not queued. If a resource with the
+		* given name already exists, so its holder is returned.
+		*
+		* @return Holder of the resource or NULL if it could not be created
+		**/
+		SharedPtr<ResourceHolder> createAsyncResource(const ::std::string& name,
+											const ::std::string& group,
+											const ::std::string& resourceType,
+											const ::std::string& fileName,
+											NameValuePairs* params,
+											ResourceLoader manualLoader);
+
+		/**
+		* Scan a number of slots, beginning at the cursor, for resources whose
+		* access count did not change for the given number of frames and
+		* unload them. Called by the ResourceCollector.
+		*
+		* @param cursor Slot to begin with, it is set to the next slot to scan
+		* @param count Number of slots to scan
+		* @param frame Current frame of the collector
+		* @param idleFrames Number of frames a resource has to be unused
+		* @return Number of unloaded resources
+		**/
+		uint32 collectIdle(uint32& cursor, uint32 count, uint32 frame, uint32 idleFrames);
+
+		/**
+		* Create the resource and queue it for loading, if there is no
+		* resource with such a name yet.
+		*
+		* @return true if the resource was queued
+		**/
+		bool preload(const ResourceDependency& resource, Priority priority);
+
+		//! Group operation running in the background
+		struct GroupOperation{
+			//! Handles which are not started yet
+			::std::list<ResourceHandle> remaining;
+
+			//! Number of started resources which are not complete
+			uint32 waiting;
+
+			//! True if loaded resources has to be reloaded
+			bool reload;
+
+			//! True if the future is set
+			bool done;
+
+			//! Priority of the load requests
+			Priority priority;
+
+			//! First error of the group
+			Result result;
+
+			//! Promise of the future given to the application
+			::boost::promise<Result> promise;
+		};
+
+		typedef ::std::map<ResourceHandle, ::std::vector< SharedPtr<GroupOperation> > > group_op_map;
+
+		//! Group operations waiting for a resource
+		group_op_map mGroupOperation;
+		::boost::mutex mGroupOperationMutex;
+
+		//! Number of resources of one group operation loaded at the same time
+		uint32 mGroupConcurrency;
+
+		/**
+		* Start the next resources of the operation and set its future if all
+		* of them are complete.
+		**/
+		void runGroupOperation(SharedPtr<GroupOperation> op);
+
+		/**
+		* Called if a resource loaded in the background is complete, so
+		* the group operations waiting for it could go on.
+		**/
+		void finishGroupRequest(ResourceHandle handle, Result result);
+
 		virtual IResource* loadResourceImpl(ResourceHandle hdl,
 											const ::std::string& name,
 											const ::std::string& group,
@@ -0,0 +1,163 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef _NR_RESOURCE_PRELOADER_H_
+#define _NR_RESOURCE_PRELOADER_H_
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "Prerequisities.h"
+#include "ResourceSystem.h"
+#include "ITask.h"
+
+#include <set>
+#include <boost/thread/mutex.hpp>
+
+namespace nrEngine{
+
+	//! Preload the resources used at the start of the last run
+	/**
+	 * Mostly an application does load the same resources in the same order
+	 * each time it is started. The preloader does record the resources
+	 * requested through ResourceManager::loadResource() and
+	 * ResourceManager::loadResourceAsync() during the first seconds after
+	 * start() in a manifest file. On the next start() the manifest is readed
+	 * and all its resources are given to the loader threads at once. So they
+	 * are loaded in parallel before the application does request them.
+	 *
+	 * If the application does request a preloaded resource, so the manager
+	 * does give back the preloaded one. ResourceManager::loadResource() does
+	 * wait until it is loaded, if it is still in the queue.
+	 *
+	 * Resources loaded with parameters or through a manual loader are not
+	 * recorded, since they could not be loaded again from the manifest.
+	 *
+	 * The manifest has the format described in ResourceManager::loadGroup(),
+	 * the group of each resource follows its file name.
+	 *
+	 * The preloader is owned by the resource manager. The engine does add it
+	 * to the kernel as system task, the manifest is written there as soon as
+	 * the recording time is over.
+	 *
+	 * \ingroup resource
+	 **/
+	class _NRExport ResourcePreloader : public ITask{
+		public:
+
+			/**
+			 * Create the preloader, it does nothing until start() is called.
+			 *
+			 * @param manager Manager loading the resources
+			 **/
+			ResourcePreloader(ResourceManager* manager);
+
+			//! Write the manifest if the recording is not finished
+			~ResourcePreloader();
+
+			/**
+			 * Preload the resources of the manifest, if it exists, and start
+			 * recording for the next run.
+			 *
+			 * @param manifest Name of the manifest file
+			 * @param seconds Time after which the recording is finished
+			 * @param priority Priority of the preload requests
+			 * @return OK or FILE_ERROR if an existing manifest could not be readed
+			 **/
+			Result start(const ::std::string& manifest, float32 seconds = 10.0f, Priority priority = Priority::LOW);
+
+			/**
+			 * Stop recording and write the manifest.
+			 *
+			 * @return either OK or FILE_ERROR
+			 **/
+			Result stop();
+
+			/**
+			 * Check whenever the resources are recorded at now
+			 **/
+			bool isRecording();
+
+			/**
+			 * Get the number of resources preloaded from the manifest
+			 **/
+			uint32 getPreloadCount() const { return mPreloadCount; }
+
+			/**
+			 * Record a resource requested by the application. Called by the manager.
+			 **/
+			void record(const ::std::string& name, const ::std::string& resourceType,
+						const ::std::string& fileName, const ::std::string& group);
+
+			/**
+			 * Check whenever the resource was preloaded and not requested
+			 * until now. The resource is not reported again.
+			 **/
+			bool takePreloaded(const ::std::string& name);
+
+			/**
+			 * Read a manifest file.
+			 *
+			 * @param fileName Name of the manifest
+			 * @param resources Here the resources are added
+			 * @return either OK or FILE_ERROR
+			 **/
+			static Result readManifest(const ::std::string& fileName, ::std::vector<ResourceDependency>& resources);
+
+			/**
+			 * Write a manifest file.
+			 *
+			 * @return either OK or FILE_ERROR
+			 **/
+			static Result writeManifest(const ::std::string& fileName, const ::std::vector<ResourceDependency>& resources);
+
+			//! Finish the recording if its time is over
+			Result taskUpdate();
+
+			//! Finish the recording
+			Result taskStop();
+
+		private:
+
+			//! Manager loading the resources
+			ResourceManager* mManager;
+
+			//! Name of the manifest file
+			::std::string mFileName;
+
+			//! True while recording
+			bool mRecording;
+
+			//! Time when the recording is finished
+			uint64 mStopTime;
+
+			//! Recorded resources in the order of their requests
+			::std::vector<ResourceDependency> mRecorded;
+
+			//! Names of the recorded resources
+			::std::set< ::std::string> mRecordedNames;
+
+			//! Names of preloaded resources not requested until now
+			::std::set< ::std::string> mPreloaded;
+
+			//! Number of resources preloaded from the manifest
+			uint32 mPreloadCount;
+
+			//! Protects the lists
+			boost::mutex mMutex;
+	};
+
+};
+
+#endif
@@ -20,6 +20,7 @@
 // Includes
 //----------------------------------------------------------------------------------
 #include "Prerequisities.h"
+#include "ResourceHolder.h"
 
 namespace nrEngine{
 	
@@ -111,19 +112,37 @@ namespace nrEngine{
 		
 		
 		/**
-		* Access to the resource to which one this pointer points. This access need
-		* 1 static_cast, 3 function calls until it returns the resource.
-		* So this function is running in O(1) and is pretty efficient
+		* Access to the resource to which one this pointer points. The access is
+		* inlined, it does only count the access and choose between the real
+		* and the empty resource. The pointer must not be NULL, this is not checked.
 		**/
-		virtual IResource* operator->() const;
+		NR_FORCEINLINE IResource* operator->() const
+		{
+			return mHolder->getResource();
+		}
 	
 		
 		/**
-		* Access to the resource to which one this pointer points. This access need
-		* 1 static_cast, 3 function calls until it returns the resource.
-		* So this function is running in O(1) and is pretty efficient
+		* Access to the resource to which one this pointer points.
+		* @see operator->()
+		**/
+		NR_FORCEINLINE IResource& operator*() const
+		{
+			return *mHolder->getResource();
+		}
+
+		/**
+		* Pin the resource for the current frame of the manager and get a raw
+		* pointer to it. The pointer is valid until the manager does begin the
+		* next frame (see ResourceManager::getFrame()), since the manager does
+		* not unload pinned resources by itself. Use it in hot loops instead of
+		* dereferencing the resource pointer each time. The access is counted
+		* only once per frame.
+		*
+		* If the resource is unloaded, so the empty resource is returned.
+		* Explicit unloading or removing does not care about pins.
 		**/
-		virtual IResource& operator*() const;
+		IResource* pin() const;
 			
 	protected:
 	
@@ -204,7 +223,7 @@ namespace nrEngine{
 		* 1 static_cast, 3 function calls until it returns the resource.
 		* So this function is running in O(1) and is pretty efficient
 		**/
-		inline ResType* operator->() const
+		NR_FORCEINLINE ResType* operator->() const
 		{
 			return static_cast<ResType*>(IResourcePtr::operator->());
 		}
@@ -215,10 +234,19 @@ namespace nrEngine{
 		* 1 static_cast, 3 function calls until it returns the resource.
 		* So this function is running in O(1) and is pretty efficient
 		**/
-		inline ResType& operator*() const
+		NR_FORCEINLINE ResType& operator*() const
 		{
 			return *(static_cast<ResType*>(IResourcePtr::operator->()));
 		}
+
+		/**
+		* Pin the resource for the current frame and get a raw typed pointer.
+		* @see IResourcePtr::pin()
+		**/
+		inline ResType* pin() const
+		{
+			return static_cast<ResType*>(IResourcePtr::pin());
+		}
 		
 	private:
 	
@@ -0,0 +1,217 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef _NR_RESOURCE_RECLAIM_QUEUE_H_
+#define _NR_RESOURCE_RECLAIM_QUEUE_H_
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "Prerequisities.h"
+#include "ITask.h"
+
+#include <deque>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+//! Default limit of bytes waiting for their release
+#define NR_RECLAIM_BYTE_LIMIT (64 * 1024 * 1024)
+
+namespace nrEngine{
+
+	//! Deferred release of the data of unloaded resources
+	/**
+	 * Freeing the data of big resources or unloading of libraries could take
+	 * a lot of time. If this is done while a lot of resources are unloaded
+	 * or removed at once, for example by changing the scene, so the frame
+	 * rate drops. Therefor resources and loaders could give the release of
+	 * their data to this queue in IResource::unloadRes() or
+	 * IResourceLoader::unloadResource(). So ResourceManager::unload(),
+	 * ResourceManager::remove() and ResourceManager::removeAllRes() does
+	 * return without waiting for it. File streams, scripts and plugins do
+	 * so, and the manager does delete the objects of removed resources
+	 * through the queue in the main thread.
+	 *
+	 * Releases which could be done in any thread are done by a background
+	 * thread with low priority. The other ones are done in taskUpdate(),
+	 * so in the main thread, until the time budget of the frame is exceeded.
+	 *
+	 * The number of bytes waiting for their release is limited. If a new
+	 * release would exceed the limit, so it is done at once by the calling
+	 * thread.
+	 *
+	 * The queue is owned by the resource manager. The engine does add it
+	 * to the kernel as system task.
+	 *
+	 * \ingroup resource
+	 **/
+	class _NRExport ResourceReclaimQueue : public ITask{
+		public:
+
+			//! Function releasing the data
+			typedef boost::function<void ()> Release;
+
+			/**
+			 * Create the queue. The thread is started with the first
+			 * release. Default time budget of the main thread releases is
+			 * 1 millisecond.
+			 *
+			 * @param byteLimit Maximal number of bytes waiting for their release
+			 **/
+			ResourceReclaimQueue(size_t byteLimit = NR_RECLAIM_BYTE_LIMIT);
+
+			//! Release all the data and stop the thread
+			~ResourceReclaimQueue();
+
+			/**
+			 * Queue the release of data.
+			 *
+			 * @param release Function releasing the data
+			 * @param size Number of bytes freed by the release
+			 * @param threadSafe If false, so the release is done in the main thread
+			 **/
+			void push(const Release& release, size_t size, bool threadSafe = true);
+
+			/**
+			 * Queue the release of data held by a shared pointer. The data is
+			 * deleted by the queue, if it does hold the last reference. The given
+			 * pointer is reset.
+			 **/
+			template<class T>
+			void pushData(SharedPtr<T>& data, size_t size, bool threadSafe = true)
+			{
+				DataRelease<T> release;
+				release.data.swap(data);
+				push(Release(release), size, threadSafe);
+			}
+
+			/**
+			 * Release all the queued data now. Waits until the background
+			 * thread has done its current release.
+			 **/
+			void flush();
+
+			/**
+			 * Stop the background thread. Queued data is released before.
+			 **/
+			void shutdown();
+
+			/**
+			 * Set the maximal number of bytes waiting for their release.
+			 * 0 does release everything at once, so disables the queue.
+			 **/
+			void setByteLimit(size_t bytes) { mByteLimit = bytes; }
+
+			/**
+			 * Get the maximal number of bytes waiting for their release
+			 **/
+			size_t getByteLimit() const { return mByteLimit; }
+
+			/**
+			 * Get the number of bytes waiting for their release
+			 **/
+			size_t getPendingBytes();
+
+			/**
+			 * Get the number of releases which are not done yet
+			 **/
+			uint32 getPendingCount();
+
+			/**
+			 * Set the time which could be spent on releases in the main
+			 * thread on each update. At least one release is done per update.
+			 *
+			 * @param microseconds Time budget (0 for no limit)
+			 **/
+			void setTimeBudget(uint32 microseconds) { mTimeBudget = microseconds; }
+
+			/**
+			 * Get the time budget of the main thread releases in microseconds
+			 **/
+			uint32 getTimeBudget() const { return mTimeBudget; }
+
+			//! Do the main thread releases in the time budget
+			Result taskUpdate();
+
+			//! Release everything and stop the thread
+			Result taskStop();
+
+		private:
+
+			//! Release function holding the last reference of some data
+			template<class T>
+			struct DataRelease{
+				mutable SharedPtr<T> data;
+				void operator()() const { data.reset(); }
+			};
+
+			//! Queued release
+			struct Entry{
+				//! Function releasing the data
+				Release	release;
+
+				//! Bytes freed by the release
+				size_t	size;
+			};
+
+			typedef ::std::deque<Entry> EntryList;
+
+			//! Releases done by the background thread
+			EntryList mQueued;
+
+			//! Releases done in the main thread
+			EntryList mMainQueued;
+
+			//! Bytes waiting for their release
+			size_t mPendingBytes;
+
+			//! Maximal number of bytes waiting for their release
+			size_t mByteLimit;
+
+			//! Time budget of the main thread releases in microseconds
+			uint32 mTimeBudget;
+
+			//! True while the thread does release some data
+			bool mRunning;
+
+			//! True if the thread is started
+			bool mStarted;
+
+			//! True if the thread has to stop
+			bool mShutdown;
+
+			//! Background thread
+			SharedPtr<boost::thread> mThread;
+
+			//! Protects the lists and the counters
+			boost::mutex mMutex;
+
+			//! Signaled if a new release is queued
+			boost::condition_variable mQueueSignal;
+
+			//! Signaled if a release is done
+			boost::condition_variable mDoneSignal;
+
+			//! Main function of the background thread
+			void run();
+
+			//! Call the release function and free the entry
+			static void release(Entry& entry);
+	};
+
+};
+
+#endif
@@ -0,0 +1,216 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef _NR_RESOURCE_STATISTICS_H_
+#define _NR_RESOURCE_STATISTICS_H_
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "Prerequisities.h"
+#include "ResourceSystem.h"
+#include "ITask.h"
+
+#include <boost/thread/mutex.hpp>
+
+//! Number of buckets of the load time histogram, bucket i counts loads faster than 2^i ms
+#define NR_RESOURCE_LOAD_TIME_BUCKETS 12
+
+namespace nrEngine{
+
+	//! Memory and loading statistics of a set of resources
+	/**
+	 * Usage of all resources, of a group, of a resource type or of the
+	 * resources of one loader.
+	 *
+	 * \ingroup resource
+	 **/
+	struct _NRExport ResourceUsage{
+		//! Bytes currently used by the resources
+		std::size_t		memory;
+
+		//! Highest number of bytes used so far
+		std::size_t		peakMemory;
+
+		//! Number of loaded resources
+		uint32			loadedCount;
+
+		//! Number of resources which are not loaded, so the empty resource is used for them
+		uint32			emptyCount;
+
+		//! Number of loadings measured
+		uint32			loadCount;
+
+		//! Sum of all measured loading times in microseconds
+		uint64			loadTime;
+
+		//! Number of loadings by their time, the last bucket does count all slower ones
+		uint32			loadTimeHistogram[NR_RESOURCE_LOAD_TIME_BUCKETS];
+
+		ResourceUsage();
+	};
+
+	//! Accounting of the memory used by the resources
+	/**
+	 * The resource manager does report each change of a resource to the
+	 * statistics, so the used memory is known for all resources together,
+	 * for each group, for each resource type and for each loader. For each
+	 * of them the highest memory usage, the number of loaded and unloaded
+	 * resources and a histogram of the loading times are collected.
+	 *
+	 * The recorded state of each resource is an Entry, which is kept by the
+	 * manager in the slot of the resource. So the statistics does not need
+	 * a lookup structure with a node for each resource.
+	 *
+	 * The statistics are also a kernel task. If a log interval is set, so
+	 * they are written to the engine log periodically.
+	 *
+	 * All methods are thread safe, the entries are protected by the
+	 * statistics too.
+	 *
+	 * \ingroup resource
+	 **/
+	class _NRExport ResourceStatistics : public ITask{
+		public:
+
+			//! Usage by the name of a group, type or loader
+			typedef std::map<std::string, ResourceUsage> UsageMap;
+
+			//! Recorded state of a resource, the names are shared by a lot of entries
+			struct Entry{
+				InternedString group;
+				InternedString type;
+				InternedString loader;
+				std::size_t size;
+				bool inserted;
+				bool loaded;
+				bool recorded;
+
+				Entry() : size(0), inserted(false), loaded(false), recorded(false) {}
+			};
+
+			ResourceStatistics();
+
+			~ResourceStatistics();
+
+			/**
+			 * Add a resource to the statistics. Its size and state are
+			 * recorded by the following update().
+			 *
+			 * @param entry Entry of the resource
+			 * @param group Group of the resource
+			 * @param resourceType Type of the resource
+			 * @param loader Name of the loader of the resource
+			 **/
+			void insert(Entry& entry, const std::string& group, const std::string& resourceType, const std::string& loader);
+
+			/**
+			 * Record the current size and state of a resource.
+			 *
+			 * @param entry Entry of the resource given to insert()
+			 * @param res The resource itself (not the empty one)
+			 **/
+			void update(Entry& entry, IResource* res);
+
+			/**
+			 * Record the time the loader did need to load the resource.
+			 *
+			 * @param entry Entry of the resource given to insert()
+			 * @param microseconds Loading time
+			 **/
+			void addLoadTime(Entry& entry, uint64 microseconds);
+
+			/**
+			 * Remove the resource from the statistics. The entry is cleared,
+			 * so it could be used for another resource.
+			 **/
+			void remove(Entry& entry);
+
+			/**
+			 * Get bytes used by all resources.
+			 **/
+			std::size_t getMemoryUsage();
+
+			/**
+			 * Get the usage of all resources
+			 **/
+			ResourceUsage getTotalUsage();
+
+			/**
+			 * Get the usage of a group, a resource type or a loader. If there
+			 * was no such resource, so the usage is empty.
+			 **/
+			ResourceUsage getGroupUsage(const std::string& group);
+			ResourceUsage getTypeUsage(const std::string& resourceType);
+			ResourceUsage getLoaderUsage(const std::string& loader);
+
+			/**
+			 * Get the usage of all groups, resource types or loaders
+			 **/
+			UsageMap getGroupUsage();
+			UsageMap getTypeUsage();
+			UsageMap getLoaderUsage();
+
+			/**
+			 * Write the statistics into the engine log
+			 **/
+			void logStatistics();
+
+			/**
+			 * Set the time in seconds between two writings of the statistics
+			 * into the log (0 to disable, this is the default).
+			 **/
+			void setLogInterval(uint32 seconds) { mLogInterval = seconds; }
+
+			/**
+			 * Get the log interval in seconds
+			 **/
+			uint32 getLogInterval() const { return mLogInterval; }
+
+			/**
+			 * Get current time in microseconds, used to measure the loading time
+			 **/
+			static uint64 getMicroseconds();
+
+			//! Write the statistics into the log if the interval is elapsed
+			Result taskUpdate();
+
+		private:
+
+			//! Change the usage by the difference of the old and new state
+			static void change(ResourceUsage& usage, const Entry& entry, std::size_t size, bool loaded);
+
+			//! Add the loading time to the usage
+			static void addTime(ResourceUsage& usage, uint64 microseconds);
+
+			//! Write one usage into the log
+			static void logUsage(const std::string& name, const ResourceUsage& usage);
+
+			//! Get the usage from the map or an empty one
+			ResourceUsage find(const UsageMap& map, const std::string& name);
+
+			ResourceUsage mTotal;
+			UsageMap mGroup;
+			UsageMap mType;
+			UsageMap mLoader;
+
+			uint32 mLogInterval;
+			uint64 mLastLog;
+
+			boost::mutex mMutex;
+	};
+
+};
+
+#endif
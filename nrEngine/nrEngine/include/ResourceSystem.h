@@ -69,6 +69,15 @@ namespace nrEngine{
 #include "ResourceHolder.h"
 #include "ResourceLoader.h" 
 #include "ResourcePtr.h"
+#include "ResourceEvictionPolicy.h"
+#include "ResourceLoadQueue.h"
+#include "ResourceFileWatcher.h"
+#include "ResourceStatistics.h"
+#include "ResourceCache.h"
+#include "ResourceReclaimQueue.h"
+#include "ResourcePreloader.h"
+#include "ResourceCollector.h"
+#include "ResourceHeap.h"
 
 
 #endif
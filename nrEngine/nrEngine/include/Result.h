@@ -251,6 +251,9 @@ namespace nrEngine{
 		//! We can not lock anymore, because the lock state stack is full
 		RES_LOCK_STATE_STACK_IS_FULL= RES_ERROR | (1 << 12),
 
+		//! There is no free slot for a new resource in the database
+		RES_DATABASE_IS_FULL		= RES_ERROR | (1 << 13),
+
 
 		//------------------------------------------------------------------------------
 		//! This are plugin managment errors
@@ -316,6 +319,12 @@ namespace nrEngine{
 		//! There is no such factory with the given name
 		EVENT_FACTORY_NOT_FOUND = EVENT_ERROR | (1 << 7),
 
+		//! The event does not support flat serialisation
+		EVENT_NOT_FLAT = EVENT_ERROR | (1 << 8),
+
+		//! Shared memory segment could not be created or mapped
+		EVENT_SHARED_MEMORY_ERROR = EVENT_ERROR | (1 << 9),
+
 
 		//------------------------------------------------------------------------------
 		//! This are general engine layer errors
@@ -73,6 +73,21 @@ namespace nrEngine{
 			**/
 			Result loadFromString(const std::string& str);
 
+			/**
+			* Store the parsed commands in a binary form, which could
+			* be loaded without parsing by loadCooked().
+			*
+			* @param data Here the commands are stored
+			**/
+			Result cook(std::vector<byte>& data) const;
+
+			/**
+			* Load the commands from their binary form created by cook().
+			*
+			* @return either OK or SCRIPT_PARSE_ERROR if the data is damaged
+			**/
+			Result loadCooked(const byte* data, size_t size);
+
 			/**
 			* @copydoc IScript::getLastError()
 			**/
@@ -109,6 +124,13 @@ namespace nrEngine{
 			**/
 			Result step();
 
+			/**
+			* Unload the script. The parsed commands are released
+			* through the reclaim queue of the resource manager.
+			* @copydoc IScript::unloadRes()
+			**/
+			Result unloadRes();
+
 		private:
 
 			//!  Parse the given string as nrScript language
@@ -161,6 +183,19 @@ namespace nrEngine{
 			//! Here we store our sequentiall commands
 			std::vector< Command > mCommand;
 
+			//! Data of an unloaded script waiting for its release
+			typedef struct _Payload{
+				std::string content;
+				std::vector< Command > command;
+				std::vector< Command > timedCommand;
+			} Payload;
+
+			//! Append a command to the binary form
+			static void cookCommand(const Command& cmd, std::vector<byte>& data);
+
+			//! Read a command from the binary form (return false if there is not enough data)
+			static bool loadCookedCommand(Command& cmd, const byte*& data, const byte* end);
+
 			//! Store command queue of waiting command ids
 			std::list< int32 > mCommandFifo;
 
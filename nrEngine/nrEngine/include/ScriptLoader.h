@@ -54,15 +54,39 @@ namespace nrEngine{
 			
 		/**
 		* Load the script resource.
-		*
-		* If a script is loaded then it will be added to the kernel as a task,
-		* because scripts are task executed in the kernel.
-		* If you write your own script-loader (i.e. different script language),
-		* so you have to worry about the adding the script into the kernel .
 		* 
 		* @copydoc IResourceLoader::loadResource()
 		**/
 		Result loadResource(IResource* resource);
+
+		/**
+		* If a script is loaded then it will be added to the kernel as a task,
+		* because scripts are task executed in the kernel. This is done here,
+		* because the kernel could only be changed in the main thread.
+		* If you write your own script-loader (i.e. different script language),
+		* so you have to worry about the adding the script into the kernel .
+		*
+		* @copydoc IResourceLoader::finalizeResource()
+		**/
+		Result finalizeResource(IResource* resource);
+
+		/**
+		* Version of the cooked scripts, which are the parsed commands.
+		* @copydoc IResourceLoader::getCookVersion()
+		**/
+		uint32 getCookVersion() const { return 1; }
+
+		/**
+		* @copydoc IResourceLoader::cookResource()
+		**/
+		Result cookResource(IResource* resource, std::vector<byte>& data);
+
+		/**
+		* Load the script from the cooked commands, so it does not have to be
+		* parsed. The script is added to the kernel by finalizeResource().
+		* @copydoc IResourceLoader::loadCookedResource()
+		**/
+		Result loadCookedResource(IResource* resource, const byte* data, size_t size);
 	
 		/**
 		* Create an empty script resource. The resource represents a script
@@ -69,6 +69,8 @@
 #include <boost/shared_array.hpp>
 #include <boost/function.hpp>
 #include <boost/any.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 
 
 // load default libraries for linux using
@@ -18,6 +18,9 @@
 //----------------------------------------------------------------------------------
 #include "Prerequisities.h"
 
+#include <boost/atomic.hpp>
+#include <boost/unordered_map.hpp>
+
 /*!
  * \defgroup helpers Global helper functions
  *
@@ -61,6 +64,82 @@ namespace nrEngine{
 	 **/
 	std::string _NRExport NR_trim(const std::string& str);
 
+	//! String stored only once in the memory
+	/**
+	 * Equal strings are stored only once in a global pool, an interned string
+	 * does only hold a pointer to it. Use it for strings repeated by a lot of
+	 * objects, like the group or the type of resources. The strings of the pool
+	 * are counted, a string is freed together with its last interned string
+	 * and the pool itself if it does not contain any string anymore.
+	 *
+	 * Interning and releasing the last interned string of a kind does lock
+	 * the pool, copying and reading the string does not.
+	 *
+	 * \ingroup helpers
+	 **/
+	class _NRExport InternedString{
+		public:
+			//! Empty string
+			InternedString() : mString(NULL) {}
+
+			//! Intern the given string
+			InternedString(const ::std::string& str) : mString(acquire(str)) {}
+
+			//! Share the string of the pool
+			InternedString(const InternedString& str) : mString(str.mString) {
+				if (mString) mString->refs++;
+			}
+
+			//! Release the string of the pool
+			~InternedString() { release(mString); }
+
+			//! Intern the given string
+			InternedString& operator=(const ::std::string& str){
+				PoolString* s = acquire(str);
+				release(mString);
+				mString = s;
+				return *this;
+			}
+
+			//! Share the string of the pool
+			InternedString& operator=(const InternedString& str){
+				if (str.mString) str.mString->refs++;
+				release(mString);
+				mString = str.mString;
+				return *this;
+			}
+
+			//! Get the string
+			operator const ::std::string&() const { return str(); }
+
+			//! Get the string
+			const ::std::string& str() const { return mString ? mString->str : empty(); }
+
+		private:
+			//! String of the pool and the number of interned strings using it
+			struct PoolString{
+				::std::string str;
+				::boost::atomic<uint32> refs;
+			};
+
+			typedef ::boost::unordered_map< ::std::string, PoolString*> Pool;
+
+			//! Pool of the strings, NULL if it is empty
+			static Pool* sPool;
+
+			//! Get the string of the pool which is equal to the given one and count it
+			static PoolString* acquire(const ::std::string& str);
+
+			//! Release one use of the string, the last one does remove it from the pool
+			static void release(PoolString* str);
+
+			//! Get the empty string, it is not in the pool
+			static const ::std::string& empty();
+
+			//! String of the pool (NULL for the empty string)
+			PoolString* mString;
+	};
+
 }; // end namespace
 
 #endif
@@ -0,0 +1,135 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+#ifndef _NR_ENGINE_RESOURCE_EVENT__H_
+#define _NR_ENGINE_RESOURCE_EVENT__H_
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "EngineEvent.h"
+#include "../EventFactory.h"
+#include "../Resource.h"
+
+namespace nrEngine{
+
+	//! Base class for the events sent by the resource management
+	/**
+	 * ResourceEvent is a base class for all events sent by the resource
+	 * manager to the NR_RESOURCE_EVENT_CHANNEL. It does contain the handle
+	 * and the name of the resource about which the event is sent.
+	 *
+	 * \ingroup sysevent
+	 **/
+	class _NRExport ResourceEvent : public Event {
+		public:
+
+			/**
+			 * Get the handle of the resource
+			 **/
+			const ResourceHandle& getResHandle() const { return mResHandle; }
+
+			/**
+			 * Get the name of the resource
+			 **/
+			const std::string& getResName() const { return mResName; }
+
+		protected:
+
+			//! Only the resource system is allowed to create the events
+			friend class ResourceManager;
+
+			/**
+			 * The constructor is protected, so only the resource manager
+			 * is able to send this kind of events.
+			 **/
+			ResourceEvent(const std::string& name, ResourceHandle handle, Priority prior = Priority::NORMAL)
+				: Event(prior), mResHandle(handle), mResName(name) {}
+
+			//! Handle of the resource
+			ResourceHandle mResHandle;
+
+			//! Name of the resource
+			std::string mResName;
+	};
+
+	//! Asynchronous loading of a resource is complete
+	/**
+	 * ResourceLoadedEvent is sent when a resource requested through
+	 * ResourceManager::loadResourceAsync() was loaded by the loader thread
+	 * and is now used instead of its empty resource. If the loading fails,
+	 * so the event is sent too, but getResult() does return the error code
+	 * of the loader and the resource stays empty.
+	 *
+	 * The event is flat, so it could be mirrored to other processes through
+	 * an EventBridge connected to the NR_RESOURCE_EVENT_CHANNEL. The events
+	 * are recreated there by the ResourceEventFactory.
+	 *
+	 * \ingroup sysevent
+	 **/
+	class _NRExport ResourceLoadedEvent : public ResourceEvent {
+		public:
+
+			/**
+			 * Get the result of the loading
+			 **/
+			Result getResult() const { return mResult; }
+
+			//! Flat type name of the event is "ResourceLoadedEvent"
+			const char* getFlatType() const;
+
+			//! Write handle, result and name of the resource
+			uint32 writeFlat(byte* buffer, uint32 size) const;
+
+			//! Read the data written by writeFlat()
+			Result readFlat(const byte* buffer, uint32 size);
+
+		private:
+			ResourceLoadedEvent(const std::string& name, ResourceHandle handle, Result result, Priority prior = Priority::NORMAL)
+				: ResourceEvent(name, handle, prior), mResult(result) {}
+			friend class ResourceManager;
+			friend class ResourceEventFactory;
+
+			//! Result returned by the loader
+			Result mResult;
+	};
+
+	//! Factory of the flat resource events
+	/**
+	 * The factory is registered by the engine, so the flat events of the
+	 * resource system could be recreated by an EventBridge subscriber.
+	 * Events created here are empty until they are read from flat data.
+	 *
+	 * \ingroup sysevent
+	 **/
+	class _NRExport ResourceEventFactory : public EventFactory {
+		public:
+
+			//! Create the factory
+			ResourceEventFactory() : EventFactory("ResourceEventFactory") {}
+
+			//! Create an empty event of the given type
+			SharedPtr<Event> create(const std::string& eventType);
+
+			//! Create an empty event by the interned type id
+			SharedPtr<Event> create(EventTypeID eventType);
+
+		private:
+
+			//! Declare the flat resource events
+			void fillSupported();
+	};
+
+}; // end namespace
+
+#endif
@@ -33,9 +33,11 @@
 #include "PluginLoader.h"
 #include "Plugin.h"
 #include "IStream.h"
+#include "MappedFileStream.h"
 
 #include "ScriptEngine.h"
 #include "EventManager.h"
+#include "EventBridge.h"
 #include "Binding.h"
 
 #endif
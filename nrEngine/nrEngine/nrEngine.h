@@ -33,9 +33,11 @@
 #include "include/PluginLoader.h"
 #include "include/Plugin.h"
 #include "include/IStream.h"
+#include "include/MappedFileStream.h"
 
 #include "include/ScriptEngine.h"
 #include "include/EventManager.h"
+#include "include/EventBridge.h"
 #include "include/Binding.h"
 
 #endif
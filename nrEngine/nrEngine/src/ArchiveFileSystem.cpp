@@ -0,0 +1,582 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "ArchiveFileSystem.h"
+#include "CompressedStream.h"
+#include "Log.h"
+#include "ResourceReclaimQueue.h"
+
+#include <fstream>
+#include <algorithm>
+
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace nrEngine {
+
+	//----------------------------------------------------------------------------------
+	ArchiveMapping::ArchiveMapping(const std::string& fileName) : mData(NULL), mSize(0), mMapped(false)
+	{
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+		int fd = ::open(fileName.c_str(), O_RDONLY);
+		if (fd < 0) return;
+
+		struct stat st;
+		if (fstat(fd, &st) == 0 && st.st_size > 0){
+			void* data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+			if (data != MAP_FAILED){
+				mData = static_cast<const byte*>(data);
+				mSize = st.st_size;
+				mMapped = true;
+			}
+		}
+
+		// the mapping does stay valid after closing
+		::close(fd);
+#else
+		// no mapping available, so read the whole archive
+		std::ifstream file(fileName.c_str(), std::ios::binary);
+		if (!file.good()) return;
+
+		file.seekg(0, std::ios_base::end);
+		size_t size = file.tellg();
+		file.seekg(0, std::ios_base::beg);
+
+		byte* data = new byte[size];
+		file.read((char*)data, size);
+		mData = data;
+		mSize = file.gcount();
+#endif
+	}
+
+	//----------------------------------------------------------------------------------
+	ArchiveMapping::~ArchiveMapping()
+	{
+		if (mData == NULL) return;
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+		if (mMapped){
+			munmap(const_cast<byte*>(mData), mSize);
+			return;
+		}
+#endif
+		delete [] mData;
+	}
+
+	//----------------------------------------------------------------------------------
+	ArchiveFileStream::ArchiveFileStream(SharedPtr<ArchiveMapping> mapping, const byte* data, size_t size)
+		: mMapping(mapping), mData(data), mPos(0), mEof(false)
+	{
+		mSize = size;
+	}
+
+	//----------------------------------------------------------------------------------
+	ArchiveFileStream::ArchiveFileStream(SharedPtr<CompressedStream> stream)
+		: mCompressed(stream), mData(NULL), mPos(0), mEof(false)
+	{
+		mSize = stream->size();
+	}
+
+	//----------------------------------------------------------------------------------
+	ArchiveFileStream::~ArchiveFileStream()
+	{
+		close();
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ArchiveFileStream::open (const ::std::string& fileName)
+	{
+		NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ArchiveFileStream: \"%s\" can only be opened through the archive file system", fileName.c_str());
+		return FILE_NOT_FOUND;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ArchiveFileStream::close()
+	{
+		mCompressed.reset();
+		mMapping.reset();
+		mData = NULL;
+		mSize = 0;
+		mPos = 0;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ArchiveFileStream::reclaim(ResourceReclaimQueue& queue)
+	{
+		// the data is only released if no other stream or file system does use it
+		if (mCompressed){
+			size_t size = mCompressed.unique() ? 2 * mCompressed->getBlockSize() : 0;
+			queue.pushData(mCompressed, size);
+		}
+		if (mMapping){
+			size_t size = mMapping.unique() ? mMapping->getSize() : 0;
+			queue.pushData(mMapping, size);
+		}
+
+		close();
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ArchiveFileStream::shareResPayload(IResource* source)
+	{
+		ArchiveFileStream* stream = dynamic_cast<ArchiveFileStream*>(source);
+		if (stream == NULL || stream->mData == NULL) return false;
+
+		// the references keep the data valid, also if the source is unloaded
+		close();
+		mMapping = stream->mMapping;
+		mData = stream->mData;
+		mSize = stream->mSize;
+		mEof = false;
+
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ArchiveFileStream::setData(SharedPtr<ArchiveMapping> mapping, const byte* data, size_t size)
+	{
+		close();
+		mMapping = mapping;
+		mData = data;
+		mSize = size;
+		mEof = false;
+	}
+
+	//----------------------------------------------------------------------------------
+	const byte* ArchiveFileStream::getView(size_t& count) const
+	{
+		count = mData != NULL ? mSize : 0;
+		return mData;
+	}
+
+	//----------------------------------------------------------------------------------
+	size_t ArchiveFileStream::read(void *buf, size_t size, size_t nmemb)
+	{
+		if (mCompressed) return mCompressed->read(buf, size, nmemb);
+		if (mData == NULL) return 0;
+
+		size_t count = size * nmemb;
+		if (count > mSize - mPos){
+			count = mSize - mPos;
+			mEof = true;
+		}
+
+		memcpy(buf, mData + mPos, count);
+		mPos += count;
+		return count;
+	}
+
+	//----------------------------------------------------------------------------------
+	size_t ArchiveFileStream::readDelim(void* buf, size_t count, const ::std::string& delim)
+	{
+		if (mCompressed) return mCompressed->readDelim(buf, count, delim);
+		if (mData == NULL) return 0;
+		if (delim.empty()){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ArchiveFileStream::readDelim(): No delimiter provided");
+			return 0;
+		}
+
+		char* str = static_cast<char*>(buf);
+		const char* data = (const char*)mData;
+
+		// copy until the delimiter, which is skipped but not copied
+		size_t ret = 0;
+		while (ret < count && mPos < mSize && data[mPos] != delim.at(0)){
+			str[ret++] = data[mPos++];
+		}
+		if (mPos < mSize && ret < count) mPos++;
+		if (mPos >= mSize) mEof = true;
+
+		// trim off CR if we found CR/LF
+		if (delim.at(0) == '\n' && ret > 0 && str[ret-1] == '\r') ret--;
+		str[ret] = '\0';
+
+		return ret;
+	}
+
+	//----------------------------------------------------------------------------------
+	size_t ArchiveFileStream::tell() const
+	{
+		if (mCompressed) return mCompressed->tell();
+		return mPos;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ArchiveFileStream::eof() const
+	{
+		if (mCompressed) return mCompressed->eof();
+		return mData == NULL || mEof;
+	}
+
+	//----------------------------------------------------------------------------------
+	byte* ArchiveFileStream::getData(size_t& count) const
+	{
+		if (mCompressed) return mCompressed->getData(count);
+		if (mData == NULL || mPos >= mSize) return NULL;
+
+		// copy the rest of the file as the file stream does
+		count = mSize - mPos;
+		byte* data = new byte[count];
+		memcpy(data, mData + mPos, count);
+		mPos = mSize;
+		mEof = true;
+
+		return data;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ArchiveFileStream::seek(int32 offset, int32 whence)
+	{
+		if (mCompressed) return mCompressed->seek(offset, whence);
+		if (mData == NULL) return false;
+
+		int64 pos = offset;
+		if (whence == IStream::CURRENT)
+			pos += mPos;
+		else if (whence == IStream::END)
+			pos += mSize;
+
+		if (pos < 0 || pos > int64(mSize)) return false;
+
+		mPos = pos;
+		mEof = false;
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	ArchiveFileSystem::ArchiveFileSystem(const std::string& archiveName) : mArchiveName(archiveName)
+	{
+		mType = "archive";
+		mHeader = NULL;
+		mEntry = NULL;
+		mName = NULL;
+	}
+
+	//----------------------------------------------------------------------------------
+	ArchiveFileSystem::~ArchiveFileSystem()
+	{
+		deinitialize();
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ArchiveFileSystem::initialize()
+	{
+		if (mMapping) return VFS_ALREADY_OPEN;
+
+		SharedPtr<ArchiveMapping> mapping(new ArchiveMapping(mArchiveName));
+		const byte* data = mapping->getData();
+		size_t size = mapping->getSize();
+
+		if (data == NULL){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ArchiveFileSystem: Can not map the archive %s", mArchiveName.c_str());
+			return VFS_CANNOT_OPEN;
+		}
+
+		// check the header
+		const ArchiveHeader* header = (const ArchiveHeader*)data;
+		if (size < sizeof(ArchiveHeader) || memcmp(header->magic, NR_ARCHIVE_MAGIC, 4) != 0){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ArchiveFileSystem: %s is not an archive", mArchiveName.c_str());
+			return VFS_CANNOT_OPEN;
+		}
+		if (header->byteOrder != 0x01020304 || header->version != NR_ARCHIVE_VERSION){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ArchiveFileSystem: %s has wrong byte order or version", mArchiveName.c_str());
+			return VFS_CANNOT_OPEN;
+		}
+		if (uint64(header->dirOffset) + uint64(header->count) * sizeof(ArchiveEntry) > size
+			|| uint64(header->nameOffset) + header->nameSize > size){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ArchiveFileSystem: Directory of %s is damaged", mArchiveName.c_str());
+			return VFS_CANNOT_OPEN;
+		}
+
+		// check all entries once, so they could be used without checks later
+		const ArchiveEntry* entry = (const ArchiveEntry*)(data + header->dirOffset);
+		for (uint32 i=0; i < header->count; i++){
+			const ArchiveEntry& e = entry[i];
+			if (uint64(e.nameOffset) + e.nameLength >= header->nameSize || e.offset + e.packedSize > size
+				|| (i > 0 && e.hash < entry[i-1].hash)){
+				NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ArchiveFileSystem: Entry %d of %s is damaged", i, mArchiveName.c_str());
+				return VFS_CANNOT_OPEN;
+			}
+		}
+
+		mMapping = mapping;
+		mHeader = header;
+		mEntry = entry;
+		mName = (const char*)(data + header->nameOffset);
+
+		NR_Log(Log::LOG_ENGINE, "ArchiveFileSystem: Archive %s with %d files opened", mArchiveName.c_str(), mHeader->count);
+		return OK;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ArchiveFileSystem::deinitialize()
+	{
+		// opened streams do hold the mapping by themself
+		mMapping.reset();
+		mHeader = NULL;
+		mEntry = NULL;
+		mName = NULL;
+		return OK;
+	}
+
+	//----------------------------------------------------------------------------------
+	uint32 ArchiveFileSystem::hash(const std::string& name)
+	{
+		uint32 h = 2166136261u;
+		for (size_t i=0; i < name.length(); i++){
+			h ^= (byte)name[i];
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+	//----------------------------------------------------------------------------------
+	std::string ArchiveFileSystem::normalize(const std::string& fileName)
+	{
+		std::string name = fileName;
+		std::replace(name.begin(), name.end(), '\\', '/');
+
+		// names are relative to the archive root
+		size_t start = 0;
+		while (start < name.length()){
+			if (name[start] == '/') start++;
+			else if (name.compare(start, 2, "./") == 0) start += 2;
+			else break;
+		}
+		return name.substr(start);
+	}
+
+	//----------------------------------------------------------------------------------
+	const ArchiveEntry* ArchiveFileSystem::find(const std::string& fileName) const
+	{
+		if (mEntry == NULL) return NULL;
+
+		std::string name = normalize(fileName);
+		uint32 h = hash(name);
+
+		// binary search for the first entry with the hash
+		uint32 first = 0, last = mHeader->count;
+		while (first < last){
+			uint32 mid = (first + last) / 2;
+			if (mEntry[mid].hash < h) first = mid + 1;
+			else last = mid;
+		}
+
+		// compare the names of all entries with this hash
+		for (; first < mHeader->count && mEntry[first].hash == h; first++){
+			const ArchiveEntry& e = mEntry[first];
+			if (e.nameLength == name.length() && memcmp(mName + e.nameOffset, name.c_str(), e.nameLength) == 0)
+				return &e;
+		}
+		return NULL;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ArchiveFileSystem::exists(const std::string& fileName)
+	{
+		return find(fileName) != NULL;
+	}
+
+	//----------------------------------------------------------------------------------
+	IFileSystem::FileInfo ArchiveFileSystem::getInfo(const ArchiveEntry& entry)
+	{
+		FileInfo info;
+		info.fsParent = this;
+		info.name.assign(mName + entry.nameOffset, entry.nameLength);
+
+		// files in the archive root are in the path "/"
+		std::string::size_type pos = info.name.rfind('/');
+		info.path = pos == std::string::npos ? "/" : info.name.substr(0, pos + 1);
+		info.realPath = mArchiveName + ":" + info.name;
+		info.size = entry.size;
+		return info;
+	}
+
+	//----------------------------------------------------------------------------------
+	IFileSystem::FileInfoListPtr ArchiveFileSystem::listFiles(bool recursive)
+	{
+		return findFiles("*", recursive);
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ArchiveFileSystem::match(const char* pattern, const char* name)
+	{
+		while (*pattern != '*'){
+			if (*pattern != *name) return false;
+			if (*pattern == '\0') return true;
+			pattern++;
+			name++;
+		}
+
+		// wildcard matches any number of characters
+		do{
+			if (match(pattern + 1, name)) return true;
+		}while (*name++ != '\0');
+
+		return false;
+	}
+
+	//----------------------------------------------------------------------------------
+	IFileSystem::FileInfoListPtr ArchiveFileSystem::findFiles(const std::string& pattern, bool recursive)
+	{
+		FileInfoListPtr list(new FileInfoList());
+		if (mEntry == NULL) return list;
+
+		std::string pat = normalize(pattern);
+		bool subdir = pat.find('/') != std::string::npos;
+
+		for (uint32 i=0; i < mHeader->count; i++){
+			std::string name(mName + mEntry[i].nameOffset, mEntry[i].nameLength);
+
+			// files in subdirectories are only found recursively
+			if (!recursive && !subdir && name.find('/') != std::string::npos) continue;
+
+			if (match(pat.c_str(), name.c_str())){
+				list->push_back(getInfo(mEntry[i]));
+			}
+		}
+
+		return list;
+	}
+
+	//----------------------------------------------------------------------------------
+	SharedPtr<FileStream> ArchiveFileSystem::open(const std::string& filename, NameValuePairs*)
+	{
+		const ArchiveEntry* e = find(filename);
+		if (e == NULL){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ArchiveFileSystem: File %s not found in %s", filename.c_str(), mArchiveName.c_str());
+			return SharedPtr<FileStream>();
+		}
+
+		const byte* data = mMapping->getData() + e->offset;
+
+		// uncompressed files are read directly from the mapping
+		if (!(e->flags & NR_ARCHIVE_COMPRESSED)){
+			return SharedPtr<FileStream>(new ArchiveFileStream(mMapping, data, e->size));
+		}
+
+		// compressed files are decompressed block by block while reading
+		SharedPtr<IStream> packed(new ArchiveFileStream(mMapping, data, e->packedSize));
+		SharedPtr<CompressedStream> stream(new CompressedStream(packed));
+		if (stream->open() != OK || stream->size() != e->size){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ArchiveFileSystem: File %s in %s can not be decompressed", filename.c_str(), mArchiveName.c_str());
+			return SharedPtr<FileStream>();
+		}
+		return SharedPtr<FileStream>(new ArchiveFileStream(stream));
+	}
+
+	//----------------------------------------------------------------------------------
+	struct ArchivePackEntry{
+		ArchiveEntry entry;
+		std::string name;
+		std::vector<byte> data;
+
+		bool operator < (const ArchivePackEntry& e) const{
+			if (entry.hash != e.entry.hash) return entry.hash < e.entry.hash;
+			return name < e.name;
+		}
+	};
+
+	//----------------------------------------------------------------------------------
+	Result ArchiveFileSystem::pack(const std::string& archiveName, const std::string& root,
+									const std::vector<std::string>& files, bool compress)
+	{
+		std::vector<ArchivePackEntry> pack(files.size());
+		uint32 nameSize = 0;
+
+		// read all files
+		for (uint32 i=0; i < files.size(); i++){
+			ArchivePackEntry& p = pack[i];
+			p.name = normalize(files[i]);
+
+			std::string path = root.length() ? root + "/" + p.name : p.name;
+			std::ifstream file(path.c_str(), std::ios::binary);
+			if (!file.good()){
+				NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ArchiveFileSystem: Can not read %s", path.c_str());
+				return FILE_NOT_FOUND;
+			}
+			p.data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+			memset(&p.entry, 0, sizeof(ArchiveEntry));
+			p.entry.hash = hash(p.name);
+			p.entry.nameLength = p.name.length();
+			p.entry.size = p.data.size();
+
+#ifdef HAVE_LIBZ
+			// keep the compressed data only if it is smaller
+			if (compress && p.data.size() > 0){
+				std::vector<byte> packed;
+				if (CompressedStream::compress(&p.data[0], p.data.size(), packed) == OK && packed.size() < p.data.size()){
+					p.data.swap(packed);
+					p.entry.flags |= NR_ARCHIVE_COMPRESSED;
+				}
+			}
+#endif
+			p.entry.packedSize = p.data.size();
+		}
+
+		std::sort(pack.begin(), pack.end());
+
+		// layout: header, directory, names and then the aligned file data
+		ArchiveHeader header;
+		memset(&header, 0, sizeof(ArchiveHeader));
+		memcpy(header.magic, NR_ARCHIVE_MAGIC, 4);
+		header.byteOrder = 0x01020304;
+		header.version = NR_ARCHIVE_VERSION;
+		header.count = pack.size();
+		header.dirOffset = sizeof(ArchiveHeader);
+		header.nameOffset = header.dirOffset + pack.size() * sizeof(ArchiveEntry);
+
+		for (uint32 i=0; i < pack.size(); i++){
+			pack[i].entry.nameOffset = nameSize;
+			nameSize += pack[i].name.length() + 1;
+		}
+		header.nameSize = nameSize;
+
+		uint64 offset = header.nameOffset + nameSize;
+		for (uint32 i=0; i < pack.size(); i++){
+			offset = (offset + NR_ARCHIVE_ALIGNMENT - 1) / NR_ARCHIVE_ALIGNMENT * NR_ARCHIVE_ALIGNMENT;
+			pack[i].entry.offset = offset;
+			offset += pack[i].entry.packedSize;
+		}
+
+		// write the archive
+		std::ofstream out(archiveName.c_str(), std::ios::binary | std::ios::trunc);
+		out.write((const char*)&header, sizeof(ArchiveHeader));
+		for (uint32 i=0; i < pack.size(); i++)
+			out.write((const char*)&pack[i].entry, sizeof(ArchiveEntry));
+		for (uint32 i=0; i < pack.size(); i++)
+			out.write(pack[i].name.c_str(), pack[i].name.length() + 1);
+
+		for (uint32 i=0; i < pack.size(); i++){
+			while (uint64(out.tellp()) < pack[i].entry.offset) out.put('\0');
+			if (pack[i].data.size()) out.write((const char*)&pack[i].data[0], pack[i].data.size());
+		}
+
+		if (!out.good()){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ArchiveFileSystem: Can not write the archive %s", archiveName.c_str());
+			return FILE_ERROR;
+		}
+
+		NR_Log(Log::LOG_ENGINE, "ArchiveFileSystem: %lu files packed into %s", (unsigned long)pack.size(), archiveName.c_str());
+		return OK;
+	}
+
+};
+
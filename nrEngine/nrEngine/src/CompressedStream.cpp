@@ -0,0 +1,473 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "CompressedStream.h"
+#include "Log.h"
+
+#include <boost/bind.hpp>
+#include <fstream>
+
+#ifdef HAVE_LIBZ
+	#include <zlib.h>
+#endif
+
+namespace nrEngine {
+
+	//----------------------------------------------------------------------------------
+	CompressedStream::CompressedStream(SharedPtr<IStream> source, bool prefetch) : IStream(0), mSource(source)
+	{
+		mBlockSize = NR_COMPRESSED_BLOCK_SIZE;
+		mPos = 0;
+		mEof = false;
+		mCurrent.index = -1;
+		mPrefetched.index = -1;
+		mRequested = -1;
+		mLoading = -1;
+		mPrefetch = prefetch;
+		mStop = false;
+	}
+
+	//----------------------------------------------------------------------------------
+	CompressedStream::~CompressedStream()
+	{
+		close();
+	}
+
+	//----------------------------------------------------------------------------------
+	Result CompressedStream::open()
+	{
+#ifndef HAVE_LIBZ
+		NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "CompressedStream: The engine was compiled without zlib");
+		return VFS_CANNOT_OPEN;
+#else
+		if (!mSource) return VFS_FILE_READ_ERROR;
+
+		// check the header, the block count has to match the size and the
+		// block table has to fit into the source
+		Header h;
+		uint64 sourceSize = mSource->size();
+		mSource->seek(0, IStream::START);
+		if (sourceSize < sizeof(Header) || mSource->read(&h, sizeof(Header), 1) != sizeof(Header)
+			|| memcmp(h.magic, NR_COMPRESSED_MAGIC, 4) != 0 || h.byteOrder != 0x01020304 || h.blockSize == 0
+			|| h.blockCount != h.size / h.blockSize + (h.size % h.blockSize != 0 ? 1 : 0)
+			|| uint64(size_t(h.size)) != h.size
+			|| (uint64(h.blockCount) + 1) * sizeof(uint64) > sourceSize - sizeof(Header)){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "CompressedStream: %s does not contain compressed data", getName().c_str());
+			return VFS_FILE_READ_ERROR;
+		}
+
+		// read the block table, the blocks has to follow the table and end in the source
+		::std::vector<uint64> offset(uint64(h.blockCount) + 1);
+		size_t tableSize = offset.size() * sizeof(uint64);
+		bool valid = mSource->read(&offset[0], tableSize, 1) == tableSize
+			&& offset[0] >= sizeof(Header) + tableSize && offset[h.blockCount] <= sourceSize;
+		for (uint32 i=0; valid && i < h.blockCount; i++){
+			valid = offset[i] <= offset[i+1];
+		}
+		if (!valid){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "CompressedStream: Block table of %s is damaged", getName().c_str());
+			return VFS_FILE_READ_ERROR;
+		}
+
+		mOffset.swap(offset);
+		mBlockSize = h.blockSize;
+		mSize = h.size;
+		mPos = 0;
+		mEof = false;
+
+		return OK;
+#endif
+	}
+
+	//----------------------------------------------------------------------------------
+	void CompressedStream::stopPrefetch()
+	{
+		if (!mThread) return;
+		{
+			boost::mutex::scoped_lock lock(mMutex);
+			mStop = true;
+			mSignal.notify_all();
+		}
+		mThread->join();
+		mThread.reset();
+		mStop = false;
+	}
+
+	//----------------------------------------------------------------------------------
+	void CompressedStream::close()
+	{
+		stopPrefetch();
+
+		mSource.reset();
+		mOffset.clear();
+		mCurrent.index = -1;
+		mCurrent.data.clear();
+		mPrefetched.index = -1;
+		mPrefetched.data.clear();
+		mRequested = -1;
+		mSize = 0;
+		mPos = 0;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool CompressedStream::seekSource(uint64 pos) const
+	{
+		// the source does only seek by 32 bit offsets, so far positions are reached in steps
+		if (!mSource->seek(0, IStream::START)) return false;
+		while (pos > 0){
+			int32 step = pos > 0x7FFFFFFF ? 0x7FFFFFFF : int32(pos);
+			if (!mSource->seek(step, IStream::CURRENT)) return false;
+			pos -= step;
+		}
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool CompressedStream::readBlock(int32 index, Block& block) const
+	{
+		uint64 packed = mOffset[index + 1] - mOffset[index];
+		size_t size = mSize - size_t(index) * mBlockSize;
+		if (size > mBlockSize) size = mBlockSize;
+
+		// only reading of the source has to be serialized
+		::std::vector<byte> buffer(packed);
+		size_t count = 0;
+		{
+			boost::mutex::scoped_lock lock(mSourceMutex);
+			if (seekSource(mOffset[index]) && packed > 0)
+				count = mSource->read(&buffer[0], 1, packed);
+		}
+
+		if (count != packed){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "CompressedStream: Block %d of %s can not be readed", index, mSource->getName().c_str());
+			return false;
+		}
+
+		// blocks with the same size are stored uncompressed
+		if (packed == size){
+			block.data.swap(buffer);
+			return true;
+		}
+
+#ifdef HAVE_LIBZ
+		block.data.resize(size);
+		uLongf length = size;
+		if (uncompress(&block.data[0], &length, &buffer[0], packed) == Z_OK && length == size)
+			return true;
+#endif
+
+		NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "CompressedStream: Block %d of %s can not be decompressed", index, mSource->getName().c_str());
+		block.data.clear();
+		return false;
+	}
+
+	//----------------------------------------------------------------------------------
+	const CompressedStream::Block& CompressedStream::getBlock(size_t pos) const
+	{
+		int32 index = pos / mBlockSize;
+		boost::mutex::scoped_lock lock(mMutex);
+
+		if (mCurrent.index != index){
+			// block is decompressed in the background at now, so wait for it
+			while (mLoading == index) mSignal.wait(lock);
+
+			if (mPrefetched.index == index){
+				mCurrent.data.swap(mPrefetched.data);
+				mPrefetched.index = -1;
+				mCurrent.index = index;
+			}else{
+				// the background thread does only use the prefetched block
+				if (mRequested == index) mRequested = -1;
+				lock.unlock();
+				bool ok = readBlock(index, mCurrent);
+				lock.lock();
+				mCurrent.index = ok ? index : -1;
+			}
+		}
+
+		// decompress the next block while the current one is readed
+		int32 next = index + 1;
+		if (mPrefetch && mCurrent.index == index && next < int32(mOffset.size()) - 1
+			&& mPrefetched.index != next && mLoading != next && mRequested != next){
+			mRequested = next;
+			if (!mThread){
+				mThread.reset(new boost::thread(boost::bind(&CompressedStream::run, const_cast<CompressedStream*>(this))));
+			}
+			mSignal.notify_all();
+		}
+
+		return mCurrent;
+	}
+
+	//----------------------------------------------------------------------------------
+	void CompressedStream::run()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+
+		while (!mStop){
+			if (mRequested < 0){
+				mSignal.wait(lock);
+				continue;
+			}
+
+			int32 index = mRequested;
+			mRequested = -1;
+			mLoading = index;
+
+			lock.unlock();
+			Block block;
+			bool ok = readBlock(index, block);
+			lock.lock();
+
+			if (ok){
+				mPrefetched.data.swap(block.data);
+				mPrefetched.index = index;
+			}
+			mLoading = -1;
+			mSignal.notify_all();
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	size_t CompressedStream::read(void *buf, size_t size, size_t nmemb)
+	{
+		if (mOffset.size() == 0) return 0;
+
+		size_t count = size * nmemb;
+		size_t done = 0;
+		while (done < count){
+			if (mPos >= mSize){
+				mEof = true;
+				break;
+			}
+
+			const Block& block = getBlock(mPos);
+			if (block.index < 0){
+				mEof = true;
+				break;
+			}
+
+			// copy as much as possible from this block
+			size_t offset = mPos - size_t(block.index) * mBlockSize;
+			size_t n = block.data.size() - offset;
+			if (n > count - done) n = count - done;
+
+			memcpy(static_cast<byte*>(buf) + done, &block.data[offset], n);
+			done += n;
+			mPos += n;
+		}
+
+		return done;
+	}
+
+	//----------------------------------------------------------------------------------
+	size_t CompressedStream::readDelim(void* buf, size_t count, const ::std::string& delim)
+	{
+		if (mOffset.size() == 0) return 0;
+		if (delim.empty()){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "CompressedStream::readDelim(): No delimiter provided");
+			return 0;
+		}
+
+		char* str = static_cast<char*>(buf);
+		size_t ret = 0;
+		bool found = false;
+
+		// copy until the delimiter, which is skipped but not copied
+		while (ret < count && !found){
+			if (mPos >= mSize){
+				mEof = true;
+				break;
+			}
+
+			const Block& block = getBlock(mPos);
+			if (block.index < 0){
+				mEof = true;
+				break;
+			}
+
+			size_t offset = mPos - size_t(block.index) * mBlockSize;
+			while (offset < block.data.size() && ret < count){
+				char c = block.data[offset++];
+				mPos++;
+				if (c == delim.at(0)){
+					found = true;
+					break;
+				}
+				str[ret++] = c;
+			}
+		}
+
+		// trim off CR if we found CR/LF
+		if (delim.at(0) == '\n' && ret > 0 && str[ret-1] == '\r') ret--;
+		str[ret] = '\0';
+
+		return ret;
+	}
+
+	//----------------------------------------------------------------------------------
+	size_t CompressedStream::tell() const
+	{
+		return mPos;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool CompressedStream::eof() const
+	{
+		return mOffset.size() == 0 || mEof;
+	}
+
+	//----------------------------------------------------------------------------------
+	byte* CompressedStream::getData(size_t& count) const
+	{
+		if (mOffset.size() == 0 || mPos >= mSize) return NULL;
+
+		// decompress the rest of the data
+		count = mSize - mPos;
+		byte* data = new byte[count];
+		count = const_cast<CompressedStream*>(this)->read(data, 1, count);
+
+		return data;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool CompressedStream::seek(int32 offset, int32 whence)
+	{
+		if (mOffset.size() == 0) return false;
+
+		int64 pos = offset;
+		if (whence == IStream::CURRENT)
+			pos += mPos;
+		else if (whence == IStream::END)
+			pos += mSize;
+
+		if (pos < 0 || pos > int64(mSize)) return false;
+
+		// the block is decompressed by the next reading
+		mPos = pos;
+		mEof = false;
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	void CompressedStream::initHeader(Header& h, uint64 size, uint32 blockSize)
+	{
+		memcpy(h.magic, NR_COMPRESSED_MAGIC, 4);
+		h.byteOrder = 0x01020304;
+		h.blockSize = blockSize;
+		h.size = size;
+		h.blockCount = (size + blockSize - 1) / blockSize;
+	}
+
+	//----------------------------------------------------------------------------------
+	const byte* CompressedStream::packBlock(const byte* block, size_t size, ::std::vector<byte>& packed, size_t& length)
+	{
+#ifdef HAVE_LIBZ
+		// store the block uncompressed if it does not get smaller
+		uLongf packedLength = packed.size();
+		if (compress2(&packed[0], &packedLength, block, size, Z_BEST_COMPRESSION) == Z_OK && packedLength < size){
+			length = packedLength;
+			return &packed[0];
+		}
+#endif
+		length = size;
+		return block;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result CompressedStream::compress(IStream* source, const ::std::string& fileName, uint32 blockSize)
+	{
+#ifndef HAVE_LIBZ
+		NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "CompressedStream: The engine was compiled without zlib");
+		return VFS_CANNOT_OPEN;
+#else
+		NR_ASSERT(source != NULL && blockSize > 0);
+
+		Header h;
+		initHeader(h, source->size() - source->tell(), blockSize);
+
+		// the block table is written after all blocks are known
+		::std::vector<uint64> offset(h.blockCount + 1);
+		offset[0] = sizeof(Header) + offset.size() * sizeof(uint64);
+
+		::std::ofstream out(fileName.c_str(), ::std::ios::binary | ::std::ios::trunc);
+		out.write((const char*)&h, sizeof(Header));
+		out.write((const char*)&offset[0], offset.size() * sizeof(uint64));
+
+		::std::vector<byte> block(blockSize);
+		::std::vector<byte> packed(compressBound(blockSize));
+		for (uint32 i=0; i < h.blockCount; i++){
+			size_t size = source->read(&block[0], 1, blockSize);
+			if (i + 1 < h.blockCount ? size != blockSize : size != h.size - uint64(i) * blockSize){
+				NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "CompressedStream: Can not read %s", source->getName().c_str());
+				return FILE_ERROR;
+			}
+
+			size_t length = 0;
+			const byte* data = packBlock(&block[0], size, packed, length);
+			out.write((const char*)data, length);
+			offset[i + 1] = offset[i] + length;
+		}
+
+		out.seekp(sizeof(Header));
+		out.write((const char*)&offset[0], offset.size() * sizeof(uint64));
+
+		if (!out.good()){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "CompressedStream: Can not write %s", fileName.c_str());
+			return FILE_ERROR;
+		}
+
+		return OK;
+#endif
+	}
+
+	//----------------------------------------------------------------------------------
+	Result CompressedStream::compress(const byte* data, size_t size, ::std::vector<byte>& result, uint32 blockSize)
+	{
+#ifndef HAVE_LIBZ
+		NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "CompressedStream: The engine was compiled without zlib");
+		return VFS_CANNOT_OPEN;
+#else
+		NR_ASSERT((data != NULL || size == 0) && blockSize > 0);
+
+		Header h;
+		initHeader(h, size, blockSize);
+
+		// header and block table are at the beginning, the blocks are appended
+		::std::vector<uint64> offset(h.blockCount + 1);
+		offset[0] = sizeof(Header) + offset.size() * sizeof(uint64);
+		result.resize(offset[0]);
+
+		::std::vector<byte> packed(compressBound(blockSize));
+		for (uint32 i=0; i < h.blockCount; i++){
+			size_t pos = size_t(i) * blockSize;
+			size_t blockLength = size - pos < blockSize ? size - pos : blockSize;
+
+			size_t length = 0;
+			const byte* block = packBlock(data + pos, blockLength, packed, length);
+			result.insert(result.end(), block, block + length);
+			offset[i + 1] = offset[i] + length;
+		}
+
+		memcpy(&result[0], &h, sizeof(Header));
+		memcpy(&result[sizeof(Header)], &offset[0], offset.size() * sizeof(uint64));
+
+		return OK;
+#endif
+	}
+
+};
+
@@ -19,6 +19,7 @@
 #include "PluginLoader.h"
 #include "FileStreamLoader.h"
 #include "EventManager.h"
+#include "events/ResourceEvent.h"
 #include "ScriptEngine.h"
 
 namespace nrEngine{
@@ -145,6 +146,26 @@ namespace nrEngine{
 		// comunication between engine's components
 		_event->createChannel(NR_DEFAULT_EVENT_CHANNEL);
 
+		// resources loaded in the background are handed back by this task
+		_resmgr->getLoadQueue()->setTaskType(TASK_SYSTEM);
+		_kernel->AddTask(_resmgr->getLoadQueue(), ORDER_SYS_THIRD);
+		_resmgr->getFileWatcher()->setTaskType(TASK_SYSTEM);
+		_kernel->AddTask(_resmgr->getFileWatcher(), ORDER_SYS_THIRD);
+		_resmgr->getReclaimQueue()->setTaskType(TASK_SYSTEM);
+		_kernel->AddTask(_resmgr->getReclaimQueue(), ORDER_SYS_THIRD);
+		_resmgr->getPreloader()->setTaskType(TASK_SYSTEM);
+		_kernel->AddTask(_resmgr->getPreloader(), ORDER_SYS_THIRD);
+		_resmgr->getCollector()->setTaskType(TASK_SYSTEM);
+		_kernel->AddTask(_resmgr->getCollector(), ORDER_SYS_LAST);
+		_resmgr->getHeap()->setTaskType(TASK_SYSTEM);
+		_kernel->AddTask(_resmgr->getHeap(), ORDER_SYS_LAST);
+		_resmgr->getStatistics()->setTaskType(TASK_SYSTEM);
+		_kernel->AddTask(_resmgr->getStatistics(), ORDER_SYS_THIRD);
+		_event->createChannel(NR_RESOURCE_EVENT_CHANNEL);
+
+		// flat resource events could be recreated from an event bridge
+		_event->registerFactory("ResourceEventFactory", SharedPtr<EventFactory>(new ResourceEventFactory()));
+
 		return true;
 	}
 
@@ -30,6 +30,24 @@ namespace nrEngine{
 		return mPriority;
 	}
 
+	//------------------------------------------------------------------------
+	const char* Event::getFlatType() const
+	{
+		return NULL;
+	}
+
+	//------------------------------------------------------------------------
+	uint32 Event::writeFlat(byte* buffer, uint32 size) const
+	{
+		return 0;
+	}
+
+	//------------------------------------------------------------------------
+	Result Event::readFlat(const byte* buffer, uint32 size)
+	{
+		return EVENT_NOT_FLAT;
+	}
+
 	//------------------------------------------------------------------------
 	Event::Event(Priority prior):mPriority(prior)
 	{
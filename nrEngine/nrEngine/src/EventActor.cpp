@@ -28,10 +28,10 @@ namespace nrEngine{
 	EventActor::~EventActor()
 	{
 		// first let each channel know, that we want to disconnect now
-		std::list<std::string>::iterator it = mChannel.begin();
-		for (; it != mChannel.end(); it++){
-			EventManager::GetSingleton().getChannel(*it)->del(this, false);
+		for (uint32 i=0; i < mChannel.size(); i++){
+			mChannel[i].channel->del(mChannel[i].handle, false);
 		}
+		mChannel.clear();
 
 	}
 
@@ -57,13 +57,10 @@ namespace nrEngine{
 		if (!channel) return EVENT_NO_CHANNEL_FOUND;
 
 		// check if we are already connected
-		if (isConnected(name)) return EVENT_ALREADY_CONNECTED;
+		if (isConnected(channel.get())) return EVENT_ALREADY_CONNECTED;
 		
 		// ask the channel to connect me to it
-		channel->add(this);
-				
-		// ok
-		return OK;
+		return channel->add(this);
 	}
 	
 	//------------------------------------------------------------------------
@@ -74,37 +71,61 @@ namespace nrEngine{
 		if (!channel) return EVENT_NO_CHANNEL_FOUND;
 		
 		// check if we are already connected
-		if (!isConnected(name)) return EVENT_NOT_CONNECTED;
+		ActorHandle handle = getHandle(channel.get());
+		if (handle == NR_INVALID_ACTOR_HANDLE) return EVENT_NOT_CONNECTED;
 		
-		// ask the channel to connect me to it
-		channel->del(this);
-
-		// ok
-		return OK;
+		// ask the channel to disconnect me from it
+		return channel->del(handle);
 	}
 
 	//------------------------------------------------------------------------
 	bool EventActor::isConnected(const std::string& name)
 	{
 		// search for the name in the list
-		return std::find(mChannel.begin(), mChannel.end(), name) != mChannel.end();
+		for (uint32 i=0; i < mChannel.size(); i++)
+			if (mChannel[i].channel->getName() == name) return true;
+		return false;
+	}
+
+	//------------------------------------------------------------------------
+	bool EventActor::isConnected(const EventChannel* channel) const
+	{
+		return getHandle(channel) != NR_INVALID_ACTOR_HANDLE;
 	}
 
 	//------------------------------------------------------------------------
-	void EventActor::_noticeConnected(EventChannel* channel)
+	ActorHandle EventActor::getHandle(const EventChannel* channel) const
 	{
-		// add the name of this channel to the list
-		if (!isConnected(channel->getName()))
-			mChannel.push_back(channel->getName());
+		// actors are connected only to a few channels, so just iterate
+		for (uint32 i=0; i < mChannel.size(); i++)
+			if (mChannel[i].channel == channel) return mChannel[i].handle;
+		return NR_INVALID_ACTOR_HANDLE;
+	}
+
+	//------------------------------------------------------------------------
+	void EventActor::_noticeConnected(EventChannel* channel, ActorHandle handle)
+	{
+		// add the channel to the list
+		if (!isConnected(channel)){
+			Connection con;
+			con.channel = channel;
+			con.handle = handle;
+			mChannel.push_back(con);
+		}
 	}
 
 	
 	//------------------------------------------------------------------------
 	void EventActor::_noticeDisconnected(EventChannel* channel)
 	{
-		// delete the name of this channel in the connection list
-		if (isConnected(channel->getName()))
-			mChannel.erase(std::find(mChannel.begin(), mChannel.end(), channel->getName()));
+		// delete this channel from the connection list
+		for (uint32 i=0; i < mChannel.size(); i++){
+			if (mChannel[i].channel == channel){
+				mChannel[i] = mChannel.back();
+				mChannel.pop_back();
+				return;
+			}
+		}
 	}
 	
 }; // end namespace	
@@ -0,0 +1,343 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "EventBridge.h"
+#include "EventManager.h"
+#include "Log.h"
+#include "Profiler.h"
+
+#if NR_PLATFORM == NR_PLATFORM_LINUX || NR_PLATFORM == NR_PLATFORM_APPLE
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <fcntl.h>
+#	include <errno.h>
+#	define NR_EVENT_BRIDGE_SHM
+#	define NR_MEMORY_BARRIER() __sync_synchronize()
+#endif
+
+//! Magic number of the shared memory segment ("nrEB")
+#define NR_EVENT_BRIDGE_MAGIC 0x6e724542
+
+namespace nrEngine{
+
+	//! Header of the shared memory segment
+	struct BridgeHeader{
+		//! Magic number to check the segment
+		uint32 magic;
+
+		//! Number of slots in the ring
+		uint32 slotCount;
+
+		//! Size of the flat data of each slot
+		uint32 slotSize;
+
+		//! Padding to get the sequence number 8 byte aligned
+		uint32 reserved;
+
+		//! Sequence number of the next slot to be written
+		volatile uint64 writeSeq;
+	};
+
+	//! Header of each slot in the ring, followed by the flat event data
+	struct BridgeSlot{
+		//! Odd while the slot is written, 2*seq+2 when slot seq is complete
+		volatile uint64 seq;
+
+		//! Size of the flat data
+		uint32 size;
+
+		//! Interned type id of the event in the publisher process
+		uint32 typeId;
+
+		//! Type name of the event
+		char type[NR_EVENT_BRIDGE_TYPE_LENGTH];
+	};
+
+	//------------------------------------------------------------------------
+	EventBridge::EventBridge(const std::string& channel, BridgeMode mode, uint32 slotCount, uint32 slotSize)
+		: EventActor(std::string("EventBridge_") + channel), ITask(std::string("EventBridge_") + channel),
+		mChannelName(channel), mMode(mode), mSlotCount(slotCount), mSlotSize((slotSize + 7) & ~7),
+		mMemory(NULL), mMemorySize(0), mReadSeq(0), mLostCount(0), mRetryDelay(0)
+	{
+	}
+
+	//------------------------------------------------------------------------
+	EventBridge::~EventBridge()
+	{
+		close();
+	}
+
+	//------------------------------------------------------------------------
+	std::string EventBridge::getSegmentName() const
+	{
+		return std::string("/nrEngine_") + mChannelName;
+	}
+
+	//------------------------------------------------------------------------
+	Result EventBridge::open()
+	{
+		if (mMemory) return OK;
+
+#ifdef NR_EVENT_BRIDGE_SHM
+		// open the segment, only the publisher is allowed to create it
+		int flags = (mMode == PUBLISH) ? (O_RDWR | O_CREAT) : O_RDWR;
+		int fd = shm_open(getSegmentName().c_str(), flags, 0666);
+		if (fd < 0){
+			// the publisher is not started yet
+			if (mMode == SUBSCRIBE && errno == ENOENT){
+				NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "EventBridge (%s): Shared memory segment %s does not exist yet", mChannelName.c_str(), getSegmentName().c_str());
+				return EVENT_SHARED_MEMORY_ERROR;
+			}
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "EventBridge (%s): Can not open shared memory segment %s", mChannelName.c_str(), getSegmentName().c_str());
+			return EVENT_SHARED_MEMORY_ERROR;
+		}
+
+		// get the geometry of an already initialized segment
+		struct stat st;
+		fstat(fd, &st);
+		bool isNew = true;
+		if (st.st_size >= (off_t)sizeof(BridgeHeader)){
+			BridgeHeader hdr;
+			if (pread(fd, &hdr, sizeof(BridgeHeader), 0) == sizeof(BridgeHeader) && hdr.magic == NR_EVENT_BRIDGE_MAGIC){
+				mSlotCount = hdr.slotCount;
+				mSlotSize = hdr.slotSize;
+				isNew = false;
+			}
+		}
+
+		// compute the size of the segment, subscriber does wait until the publisher
+		// has resized and initialized it, so this is not an error
+		mMemorySize = sizeof(BridgeHeader) + mSlotCount * (sizeof(BridgeSlot) + mSlotSize);
+		bool isSmall = st.st_size < (off_t)mMemorySize;
+		if (mMode == SUBSCRIBE && (isNew || isSmall)){
+			NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "EventBridge (%s): Shared memory segment %s is not initialized yet", mChannelName.c_str(), getSegmentName().c_str());
+			::close(fd);
+			return EVENT_SHARED_MEMORY_ERROR;
+		}
+		if (isSmall && ftruncate(fd, mMemorySize) != 0){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "EventBridge (%s): Can not resize shared memory segment %s", mChannelName.c_str(), getSegmentName().c_str());
+			::close(fd);
+			return EVENT_SHARED_MEMORY_ERROR;
+		}
+
+		// map it
+		void* mem = mmap(NULL, mMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (mem == MAP_FAILED){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "EventBridge (%s): Can not map shared memory segment", mChannelName.c_str());
+			return EVENT_SHARED_MEMORY_ERROR;
+		}
+
+		// the segment could be recreated by a new publisher since we have read the geometry,
+		// so subscriber does check the mapped header again and waits if it does not match
+		BridgeHeader* hdr = (BridgeHeader*)mem;
+		if (mMode == SUBSCRIBE && (hdr->magic != NR_EVENT_BRIDGE_MAGIC || hdr->slotCount != mSlotCount || hdr->slotSize != mSlotSize)){
+			NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "EventBridge (%s): Shared memory segment %s has changed, try again", mChannelName.c_str(), getSegmentName().c_str());
+			munmap(mem, mMemorySize);
+			mMemorySize = 0;
+			return EVENT_SHARED_MEMORY_ERROR;
+		}
+		mMemory = (byte*)mem;
+
+		// initialize the header of a new segment
+		if (isNew){
+			hdr->slotCount = mSlotCount;
+			hdr->slotSize = mSlotSize;
+			hdr->writeSeq = 0;
+			NR_MEMORY_BARRIER();
+			hdr->magic = NR_EVENT_BRIDGE_MAGIC;
+		}
+
+		// subscriber does only read new events
+		mReadSeq = hdr->writeSeq;
+
+		// publisher has to hear the local channel
+		if (mMode == PUBLISH) connect(mChannelName);
+
+		NR_Log(Log::LOG_ENGINE, "EventBridge (%s): Shared memory segment %s mapped (%d slots of %d bytes)", mChannelName.c_str(), getSegmentName().c_str(), mSlotCount, mSlotSize);
+		return OK;
+#else
+		NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "EventBridge (%s): Shared memory is not supported on this platform", mChannelName.c_str());
+		return EVENT_SHARED_MEMORY_ERROR;
+#endif
+	}
+
+	//------------------------------------------------------------------------
+	void EventBridge::close()
+	{
+#ifdef NR_EVENT_BRIDGE_SHM
+		if (mMemory == NULL) return;
+
+		// the bridge could be released after the event manager
+		if (mMode == PUBLISH && EventManager::isValid()) disconnect(mChannelName);
+
+		munmap(mMemory, mMemorySize);
+		mMemory = NULL;
+		mMemorySize = 0;
+#endif
+	}
+
+	//------------------------------------------------------------------------
+	void EventBridge::OnEvent(const EventChannel& channel, SharedPtr<Event> event)
+	{
+#ifdef NR_EVENT_BRIDGE_SHM
+		// Profiling of the engine
+		_nrEngineProfile("EventBridge.OnEvent");
+
+		// only flat events could be transfered
+		if (mMemory == NULL || mMode != PUBLISH) return;
+		const char* type = event->getFlatType();
+		if (type == NULL) return;
+
+		// get the slot to write to
+		BridgeHeader* hdr = (BridgeHeader*)mMemory;
+		uint64 seq = hdr->writeSeq;
+		BridgeSlot* slot = (BridgeSlot*)(mMemory + sizeof(BridgeHeader) + (seq % mSlotCount) * (sizeof(BridgeSlot) + mSlotSize));
+
+		// mark the slot as being written
+		slot->seq = 2 * seq + 1;
+		NR_MEMORY_BARRIER();
+
+		// write the event data, events which do not fit are written as empty slots
+		slot->typeId = getFlatTypeId(type);
+		strncpy(slot->type, type, NR_EVENT_BRIDGE_TYPE_LENGTH - 1);
+		slot->type[NR_EVENT_BRIDGE_TYPE_LENGTH - 1] = 0;
+		slot->size = event->writeFlat((byte*)(slot + 1), mSlotSize);
+		if (slot->size == 0){
+			NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "EventBridge (%s): Event of type %s could not be written", mChannelName.c_str(), type);
+			mLostCount++;
+		}
+
+		// publish the slot
+		NR_MEMORY_BARRIER();
+		slot->seq = 2 * seq + 2;
+		NR_MEMORY_BARRIER();
+		hdr->writeSeq = seq + 1;
+#endif
+	}
+
+	//------------------------------------------------------------------------
+	EventTypeID EventBridge::getFlatTypeId(const char* type)
+	{
+		// flat type names are constants, so they are found by their address
+		FlatTypeMap::const_iterator it = mFlatType.find(type);
+		if (it != mFlatType.end()) return it->second;
+
+		EventTypeID id = EventManager::GetSingleton().getEventType(std::string(type));
+		mFlatType[type] = id;
+		return id;
+	}
+
+	//------------------------------------------------------------------------
+	EventTypeID EventBridge::getLocalTypeId(uint32 remoteId, const char* type)
+	{
+		// the name is compared, since a restarted publisher could use other ids
+		if (remoteId < mRemoteType.size() && mRemoteType[remoteId].id != NR_EVENT_TYPE_INVALID
+			&& strcmp(mRemoteType[remoteId].name.c_str(), type) == 0){
+			return mRemoteType[remoteId].id;
+		}
+
+		// ids of the publisher are small, so they index the cache directly
+		EventTypeID id = EventManager::GetSingleton().getEventType(std::string(type), false);
+		if (remoteId < NR_EVENT_BRIDGE_TYPE_CACHE){
+			if (remoteId >= mRemoteType.size()) mRemoteType.resize(remoteId + 1);
+			mRemoteType[remoteId].id = id;
+			mRemoteType[remoteId].name = type;
+		}
+		return id;
+	}
+
+	//------------------------------------------------------------------------
+	Result EventBridge::taskInit()
+	{
+		Result ret = open();
+
+		// subscriber does wait for the publisher in taskUpdate()
+		if (ret != OK && mMode == SUBSCRIBE){
+			NR_Log(Log::LOG_ENGINE, "EventBridge (%s): Wait for the publisher", mChannelName.c_str());
+			mRetryDelay = NR_EVENT_BRIDGE_RETRY;
+			return OK;
+		}
+		return ret;
+	}
+
+	//------------------------------------------------------------------------
+	Result EventBridge::taskStop()
+	{
+		close();
+		return OK;
+	}
+
+	//------------------------------------------------------------------------
+	Result EventBridge::taskUpdate()
+	{
+#ifdef NR_EVENT_BRIDGE_SHM
+		// Profiling of the engine
+		_nrEngineProfile("EventBridge.taskUpdate");
+
+		// subscriber could be started before the publisher, so try again from time to time
+		if (mMemory == NULL && mMode == SUBSCRIBE){
+			if (mRetryDelay > 0) mRetryDelay--;
+			else if (open() != OK) mRetryDelay = NR_EVENT_BRIDGE_RETRY;
+		}
+		if (mMemory == NULL || mMode != SUBSCRIBE) return OK;
+
+		BridgeHeader* hdr = (BridgeHeader*)mMemory;
+		uint64 writeSeq = hdr->writeSeq;
+		NR_MEMORY_BARRIER();
+
+		// if the publisher has overrun us, so skip the overwritten slots
+		if (writeSeq - mReadSeq > mSlotCount){
+			mLostCount += writeSeq - mReadSeq - mSlotCount;
+			mReadSeq = writeSeq - mSlotCount;
+		}
+
+		char type[NR_EVENT_BRIDGE_TYPE_LENGTH];
+		for (; mReadSeq < writeSeq; mReadSeq++){
+			BridgeSlot* slot = (BridgeSlot*)(mMemory + sizeof(BridgeHeader) + (mReadSeq % mSlotCount) * (sizeof(BridgeSlot) + mSlotSize));
+
+			// check whenever the slot does still contain our event
+			uint64 seq = slot->seq;
+			NR_MEMORY_BARRIER();
+			if (seq != 2 * mReadSeq + 2){
+				mLostCount++;
+				continue;
+			}
+
+			// read the event directly from the shared memory
+			uint32 size = slot->size;
+			memcpy(type, slot->type, NR_EVENT_BRIDGE_TYPE_LENGTH);
+			type[NR_EVENT_BRIDGE_TYPE_LENGTH - 1] = 0;
+			if (size == 0 || size > mSlotSize) continue;
+
+			SharedPtr<Event> event = EventManager::GetSingleton().createEvent(getLocalTypeId(slot->typeId, type));
+			if (!event) continue;
+			Result res = event->readFlat((const byte*)(slot + 1), size);
+
+			// if the slot was overwritten while reading, so the event is lost
+			NR_MEMORY_BARRIER();
+			if (slot->seq != seq){
+				mLostCount++;
+				continue;
+			}
+
+			if (res == OK) EventManager::GetSingleton().emit(mChannelName, event);
+		}
+#endif
+		return OK;
+	}
+
+}; // end namespace
+
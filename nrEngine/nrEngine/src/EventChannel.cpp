@@ -17,11 +17,24 @@
 #include "Log.h"
 #include "Profiler.h"
 
+//! Number of bits of an actor handle used for the slot index
+#define NR_ACTOR_SLOT_BITS 32
+#define NR_ACTOR_SLOT_MASK 0xFFFFFFFFULL
+
+//! Marks the end of the list of free slots
+#define NR_ACTOR_NO_SLOT 0xFFFFFFFF
+
+//! Slots reaching this generation are not used anymore, so their handles could not repeat
+#define NR_ACTOR_MAX_GENERATION 0xFFFFFFFF
+
 namespace nrEngine{
 
 	//------------------------------------------------------------------------
 	EventChannel::EventChannel(EventManager* manager, const std::string& name) : mName(name){
 		mParentManager = manager;
+		mFreeSlot = NR_ACTOR_NO_SLOT;
+		mEmitDepth = 0;
+		mRemovedCount = 0;
 	}
 
 	//------------------------------------------------------------------------
@@ -31,16 +44,34 @@ namespace nrEngine{
 	}
 
 	//------------------------------------------------------------------------
-	Result EventChannel::add(EventActor* actor, bool notice)
+	Result EventChannel::add(EventActor* actor, bool notice, ActorHandle* handle)
 	{
-		// we first check whenever the actor is already connected
-		if (isConnected(actor->getName())) return EVENT_ALREADY_CONNECTED;
+		// we first check whenever the actor is already connected, only actors
+		// which are not noticed have to be searched
+		if (actor->isConnected(this) || (!notice && findActor(actor) >= 0)) return EVENT_ALREADY_CONNECTED;
+
+		// get a free slot for the handle or create a new one
+		uint32 slot = mFreeSlot;
+		if (slot != NR_ACTOR_NO_SLOT){
+			mFreeSlot = mActorSlot[slot].index;
+		}else{
+			if (mActorSlot.size() >= NR_ACTOR_NO_SLOT) return EVENT_ERROR;
+			slot = mActorSlot.size();
+			ActorSlot s;
+			s.generation = 0;
+			mActorSlot.push_back(s);
+		}
 
-		// connect the actor to the OnEvent - Signal slot
-		mActorDb[actor->getName()] = actor;
+		// connect the actor to the end of the database
+		ActorEntry entry;
+		entry.actor = actor;
+		entry.slot = slot;
+		mActorSlot[slot].index = mActorDb.size();
+		mActorDb.push_back(entry);
 
 		// notice an actor that he is got a connection now
-		if (notice) actor->_noticeConnected(this);
+		if (notice) actor->_noticeConnected(this, makeHandle(slot));
+		if (handle) *handle = makeHandle(slot);
 
 		// Log debug stuff
 		NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "EventChannel (%s): New actor connected \"%s\"", getName().c_str(), actor->getName().c_str());
@@ -50,12 +81,42 @@ namespace nrEngine{
 
 	//------------------------------------------------------------------------
 	Result EventChannel::del(EventActor* actor, bool notice)
+	{
+		// actors which were not noticed about the connection do not know their handle
+		ActorHandle handle = actor->getHandle(this);
+		if (handle == NR_INVALID_ACTOR_HANDLE){
+			int32 index = findActor(actor);
+			if (index >= 0) handle = makeHandle(mActorDb[index].slot);
+		}
+		return del(handle, notice);
+	}
+
+	//------------------------------------------------------------------------
+	Result EventChannel::del(ActorHandle handle, bool notice)
 	{
 		// we first check whenever the actor is already connected
-		if (!isConnected(actor->getName())) return EVENT_NOT_CONNECTED;
+		if (getActor(handle) == NULL) return EVENT_NOT_CONNECTED;
+
+		uint32 slot = uint32(handle & NR_ACTOR_SLOT_MASK);
+		uint32 index = mActorSlot[slot].index;
+		EventActor* actor = mActorDb[index].actor;
+
+		// while emitting the entries must not move, so they are removed afterwards
+		if (mEmitDepth > 0){
+			mActorDb[index].actor = NULL;
+			mRemovedCount++;
+		}else{
+			// fill the gap with the last actor, so the database stays contiguous
+			mActorDb[index] = mActorDb.back();
+			mActorSlot[mActorDb[index].slot].index = index;
+			mActorDb.pop_back();
+		}
 
-		// disconnect the actor to the OnEvent - Signal slot
-		mActorDb.erase(mActorDb.find(actor->getName()));
+		// release the slot, so old handles get invalid
+		if (++mActorSlot[slot].generation != NR_ACTOR_MAX_GENERATION){
+			mActorSlot[slot].index = mFreeSlot;
+			mFreeSlot = slot;
+		}
 
 		// notice an actor that it is disconnected now
 		if (notice) actor->_noticeDisconnected(this);
@@ -66,6 +127,50 @@ namespace nrEngine{
 		return OK;
 	}
 
+	//------------------------------------------------------------------------
+	EventActor* EventChannel::getActor(ActorHandle handle) const
+	{
+		uint32 slot = handle & NR_ACTOR_SLOT_MASK;
+		if (handle == NR_INVALID_ACTOR_HANDLE || slot >= mActorSlot.size()) return NULL;
+		if (makeHandle(slot) != handle || mActorSlot[slot].generation == NR_ACTOR_MAX_GENERATION) return NULL;
+
+		return mActorDb[mActorSlot[slot].index].actor;
+	}
+
+	//------------------------------------------------------------------------
+	ActorHandle EventChannel::getHandle(const EventActor* actor) const
+	{
+		return actor->getHandle(this);
+	}
+
+	//------------------------------------------------------------------------
+	ActorHandle EventChannel::makeHandle(uint32 slot) const
+	{
+		return ActorHandle(slot) | (ActorHandle(mActorSlot[slot].generation) << NR_ACTOR_SLOT_BITS);
+	}
+
+	//------------------------------------------------------------------------
+	int32 EventChannel::findActor(const EventActor* actor) const
+	{
+		for (uint32 i=0; i < mActorDb.size(); i++)
+			if (mActorDb[i].actor == actor) return i;
+		return -1;
+	}
+
+	//------------------------------------------------------------------------
+	void EventChannel::compact()
+	{
+		uint32 count = 0;
+		for (uint32 i=0; i < mActorDb.size(); i++){
+			if (mActorDb[i].actor == NULL) continue;
+			mActorDb[count] = mActorDb[i];
+			mActorSlot[mActorDb[count].slot].index = count;
+			count++;
+		}
+		mActorDb.resize(count);
+		mRemovedCount = 0;
+	}
+
 	//------------------------------------------------------------------------
 	void EventChannel::_disconnectAll()
 	{
@@ -75,11 +180,16 @@ namespace nrEngine{
 		// some logging
 		NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "EventChannel (%s): Disconnect all actors", getName().c_str());
 
+		// clear the database first, so actors could not disconnect twice
+		ActorDatabase actors;
+		actors.swap(mActorDb);
+		mActorSlot.clear();
+		mFreeSlot = NR_ACTOR_NO_SLOT;
+		mRemovedCount = 0;
+
 		// iterate through all connections and close them
-		ActorDatabase::iterator it = mActorDb.begin();
-		for (; it != mActorDb.end(); it++){
-			mActorDb.erase(it);
-			it->second->_noticeDisconnected(this);
+		for (uint32 i=0; i < actors.size(); i++){
+			if (actors[i].actor) actors[i].actor->_noticeDisconnected(this);
 		}
 
 	}
@@ -87,18 +197,25 @@ namespace nrEngine{
 	//------------------------------------------------------------------------
 	bool EventChannel::isConnected(const std::string& name)
 	{
-		ActorDatabase::iterator it = mActorDb.find(name);
-		return it != mActorDb.end();
+		for (uint32 i=0; i < mActorDb.size(); i++)
+			if (mActorDb[i].actor && mActorDb[i].actor->getName() == name) return true;
+		return false;
 	}
 
 	//------------------------------------------------------------------------
 	void EventChannel::emit (SharedPtr<Event> event)
 	{
-		// iterate through all connected actors and emit the signal
-		ActorDatabase::iterator it = mActorDb.begin();
-		for (; it != mActorDb.end(); it++){
-			it->second->OnEvent(*this, event);
+		// iterate through all connected actors and emit the signal, actors
+		// are allowed to connect and disconnect actors while handling the
+		// event, so the entries stay where they are until the end
+		mEmitDepth++;
+		for (uint32 i=0; i < mActorDb.size(); i++){
+			EventActor* actor = mActorDb[i].actor;
+			if (actor) actor->OnEvent(*this, event);
 		}
+		mEmitDepth--;
+
+		if (mEmitDepth == 0 && mRemovedCount > 0) compact();
 	}
 
 	//------------------------------------------------------------------------
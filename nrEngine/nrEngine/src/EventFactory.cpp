@@ -34,6 +34,10 @@ namespace nrEngine{
 	//------------------------------------------------------------------------
 	bool EventFactory::isSupported(const std::string& eventType) const
 	{
+		// if we are already registered, so just check the id table
+		if (mSupportedIds.size() && EventManager::isValid())
+			return isSupported(EventManager::GetSingleton().getEventType(eventType, false));
+
 		// iterate through the list and check
 		NameList::const_iterator it = mSupportedTypes.begin();
 		for (; it != mSupportedTypes.end(); it++)
@@ -42,5 +46,27 @@ namespace nrEngine{
 		return false;
 	}
 
+	//------------------------------------------------------------------------
+	bool EventFactory::isSupported(EventTypeID eventType) const
+	{
+		return mSupportedIds.find(eventType) != mSupportedIds.end();
+	}
+
+	//------------------------------------------------------------------------
+	SharedPtr<Event> EventFactory::create(EventTypeID eventType)
+	{
+		if (!EventManager::isValid()) return SharedPtr<Event>();
+		return create(EventManager::GetSingleton().getEventTypeName(eventType));
+	}
+
+	//------------------------------------------------------------------------
+	void EventFactory::declareSupportedType(const std::string& eventType)
+	{
+		// check whenever such type is already declared
+		NameList::const_iterator it = std::find(mSupportedTypes.begin(), mSupportedTypes.end(), eventType);
+		if (it == mSupportedTypes.end())
+			mSupportedTypes.push_back(eventType);
+	}
+
 }; // end namespace
 
@@ -26,6 +26,10 @@ namespace nrEngine{
 
 		NR_Log(Log::LOG_ENGINE, "EventManager: Initialize the event management system");
 
+		// id 0 is reserved for invalid types
+		mTypeName.push_back(std::string());
+		mTypeFactory.push_back(NULL);
+
 		// create default system wide channel
 		createChannel(NR_DEFAULT_EVENT_CHANNEL);
 	}
@@ -37,6 +41,7 @@ namespace nrEngine{
 		mChannelDb.clear();
 
 		// clear the factory list
+		mTypeFactory.clear();
 		mFactoryDb.clear();
 	}
 
@@ -133,14 +138,54 @@ namespace nrEngine{
 	//------------------------------------------------------------------------
 	SharedPtr<Event> EventManager::createEvent(const std::string& eventType)
 	{
-		// find the factory, able to create this kind of events
-		FactoryDatabase::iterator it = mFactoryDb.begin();
-		for (; it != mFactoryDb.end(); it++){
-			if (it->second->isSupported(eventType))
-				return it->second->create(eventType);
-		}
+		// find the interned id of the type
+		TypeIdDatabase::const_iterator it = mTypeIdDb.find(eventType);
+		if (it == mTypeIdDb.end()) return SharedPtr<Event>();
+
+		return createEvent(it->second);
+	}
+
+	//------------------------------------------------------------------------
+	SharedPtr<Event> EventManager::createEvent(EventTypeID eventType)
+	{
+		// get the factory, able to create this kind of events
+		if (eventType >= mTypeFactory.size() || mTypeFactory[eventType] == NULL)
+			return SharedPtr<Event>();
+
+		return mTypeFactory[eventType]->create(eventType);
+	}
+
+	//------------------------------------------------------------------------
+	EventTypeID EventManager::getEventType(const std::string& eventType, bool create)
+	{
+		// check whenever the type is already interned
+		TypeIdDatabase::const_iterator it = mTypeIdDb.find(eventType);
+		if (it != mTypeIdDb.end()) return it->second;
+		if (!create) return NR_EVENT_TYPE_INVALID;
+
+		// assign new id to the type
+		EventTypeID id = mTypeName.size();
+		mTypeIdDb[eventType] = id;
+		mTypeName.push_back(eventType);
+		mTypeFactory.push_back(NULL);
+
+		return id;
+	}
 
-		return SharedPtr<Event>();
+	//------------------------------------------------------------------------
+	const std::string& EventManager::getEventTypeName(EventTypeID eventType) const
+	{
+		if (eventType >= mTypeName.size()) return mTypeName[NR_EVENT_TYPE_INVALID];
+		return mTypeName[eventType];
+	}
+
+	//------------------------------------------------------------------------
+	void EventManager::bindFactoryTypes(EventFactory* factory)
+	{
+		EventFactory::TypeSet::const_iterator it = factory->mSupportedIds.begin();
+		for (; it != factory->mSupportedIds.end(); it++){
+			if (mTypeFactory[*it] == NULL) mTypeFactory[*it] = factory;
+		}
 	}
 
 	//------------------------------------------------------------------------
@@ -155,6 +200,22 @@ namespace nrEngine{
 
 		NR_Log(Log::LOG_ENGINE, Log::LL_NORMAL, "EventManager: Register event factory %s", name.c_str());
 		mFactoryDb[name] = factory;
+
+		// let the factory declare its types, if not already done
+		if (factory->mSupportedTypes.size() == 0)
+			factory->fillSupported();
+
+		// intern all supported types and bind them to the factory
+		factory->mSupportedIds.clear();
+		EventFactory::NameList::const_iterator jt = factory->mSupportedTypes.begin();
+		for (; jt != factory->mSupportedTypes.end(); jt++){
+			EventTypeID id = getEventType(*jt);
+			factory->mSupportedIds.insert(id);
+			if (mTypeFactory[id] != NULL)
+				NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "EventManager: Event type %s is already supported by factory %s", jt->c_str(), mTypeFactory[id]->getName().c_str());
+		}
+		bindFactoryTypes(factory.get());
+
 		return OK;
 	}
 
@@ -171,7 +232,17 @@ namespace nrEngine{
 			return EVENT_FACTORY_NOT_FOUND;
 		}
 		NR_Log(Log::LOG_ENGINE, Log::LL_NORMAL, "EventManager: Remove event factory %s", name.c_str());
+
+		// unbind the types of the factory from the type table
+		EventFactory* factory = it->second.get();
+		for (uint32 i=0; i < mTypeFactory.size(); i++)
+			if (mTypeFactory[i] == factory) mTypeFactory[i] = NULL;
 		mFactoryDb.erase(it);
+
+		// other factories could also support the unbound types
+		for (it = mFactoryDb.begin(); it != mFactoryDb.end(); it++)
+			bindFactoryTypes(it->second.get());
+
 		return OK;
 	}
 
@@ -16,12 +16,14 @@
 //----------------------------------------------------------------------------------
 #include "FileStream.h"
 #include "Log.h"
+#include "ResourceReclaimQueue.h"
 
 namespace nrEngine {
 
 	//----------------------------------------------------------------------------------
 	FileStream::FileStream() : IStream(0), IResource()
 	{
+		setResourceType("File");
 	}
 
 	//----------------------------------------------------------------------------------
@@ -61,6 +63,15 @@ namespace nrEngine {
 		mSize = 0;
 	}
 
+	//----------------------------------------------------------------------------------
+	void FileStream::reclaim(ResourceReclaimQueue& queue)
+	{
+		if (!mStream) return;
+		mStream->close();
+		queue.pushData(mStream, sizeof(::std::ifstream) + mStreamBufSize);
+		mSize = 0;
+	}
+
 	//----------------------------------------------------------------------------------
 	size_t FileStream::read(void *buf, size_t size, size_t nmemb)
 	{
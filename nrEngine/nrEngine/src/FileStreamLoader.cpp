@@ -16,12 +16,19 @@
 //----------------------------------------------------------------------------------
 #include "FileStreamLoader.h"
 #include "Log.h"
+#include "ResourceManager.h"
+#include "ResourceReclaimQueue.h"
+
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+	#include <sys/stat.h>
+#endif
 
 namespace nrEngine{
 
 	//----------------------------------------------------------------------------------
 	FileStreamLoader::FileStreamLoader()
 	{
+		mMappedSize = NR_MAPPED_FILE_SIZE;
 		initialize();
 	}
 
@@ -36,6 +43,7 @@ namespace nrEngine{
 	Result FileStreamLoader::initialize(){
 		// fill out supported resource types;
 		declareSupportedResourceType("File");
+		declareSupportedResourceType("MappedFile");
 
 		return OK;
 	}
@@ -91,11 +99,12 @@ namespace nrEngine{
 			resource->unloadRes();
 		}
 
-		// close the file stream and remove the pointer
+		// close the file stream, the data is released in the background
 		FileStream* fileStream = dynamic_cast<FileStream*>(resource);
-
-		fileStream->mStream->close();
-		fileStream->mStream.reset();
+		if (ResourceManager::isValid())
+			fileStream->reclaim(*ResourceManager::GetSingleton().getReclaimQueue());
+		else
+			fileStream->close();
 
 		// OK
 		return OK;
@@ -109,10 +118,42 @@ namespace nrEngine{
 		// check if we do support this kind of resource types
 		if (!supportResourceType(resourceType)) return NULL;
 
+		// mapped files are requested by the type or by the parameter
+		bool mapped = resourceType == "MappedFile";
+		if (params != NULL && params->find("mapped") != params->end()){
+			const ::std::string& value = (*params)["mapped"];
+			mapped = value == "1" || value == "true" || value == "yes";
+		}
+
 		// create an plugin instance
+		if (mapped) return new MappedFileStream();
 		return new FileStream();
 	}
 
+	//----------------------------------------------------------------------------------
+	IResource* FileStreamLoader::createResourceInstance(const ::std::string& resourceType, const ::std::string& fileName, NameValuePairs* params) const
+	{
+		// the parameter does overwrite the size
+		if (resourceType != "File" || mMappedSize == 0 || (params != NULL && params->find("mapped") != params->end()))
+			return createResourceInstance(resourceType, params);
+
+		// watched files are mostly rewritten in place by editors, which would
+		// crash any reader of the mapping, so they are only mapped on request
+		if (ResourceManager::isValid() && ResourceManager::GetSingleton().getFileWatcher()->isEnabled())
+			return createResourceInstance(resourceType, params);
+
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+		// big files are mapped, so they are not copied by reading
+		struct stat st;
+		if (stat(fileName.c_str(), &st) == 0 && size_t(st.st_size) >= mMappedSize){
+			NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "FileStreamLoader: Map the file %s", fileName.c_str());
+			return new MappedFileStream();
+		}
+#endif
+
+		return createResourceInstance(resourceType, params);
+	}
+
 
 	//----------------------------------------------------------------------------------
 	IResource* FileStreamLoader::createEmptyResource(const ::std::string& resourceType)
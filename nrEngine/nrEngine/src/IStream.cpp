@@ -16,6 +16,8 @@
 //----------------------------------------------------------------------------------
 #include "IStream.h"
 
+#include <cstring>
+
 namespace nrEngine {
 
 	//----------------------------------------------------------------------------------
@@ -79,9 +81,28 @@ namespace nrEngine {
 		return str;
 	}
 
+	//----------------------------------------------------------------------------------
+	const byte* IStream::getView(size_t& count) const
+	{
+		count = 0;
+		return NULL;
+	}
+
 	//----------------------------------------------------------------------------------
 	::std::string IStream::getAsString(){
 
+		// take the rest of the data without copying it twice, if it is in the memory
+		size_t count = 0;
+		const byte* view = getView(count);
+		if (view != NULL){
+			size_t pos = tell();
+			const char* data = (const char*)view + pos;
+			const char* end = (const char*)memchr(data, '\0', count - pos);
+			::std::string str(data, end != NULL ? end - data : count - pos);
+			seek(0, END);
+			return str;
+		}
+
 		// create buffer to hold the whole data
 		char* pBuf = new char[mSize+1];
 
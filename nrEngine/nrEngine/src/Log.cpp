@@ -77,6 +77,7 @@ namespace nrEngine{
 		va_end(args);
 		
 		// log the message
+		boost::mutex::scoped_lock lock(_mutex);
 		logIt(target, LL_NORMAL, szBuf);
 		
 		// echo logging
@@ -109,6 +110,7 @@ namespace nrEngine{
 		va_end(args);
 		
 		// log the message
+		boost::mutex::scoped_lock lock(_mutex);
 		logIt(target, level, szBuf);
 		
 		// echo logging
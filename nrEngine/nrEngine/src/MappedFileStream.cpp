@@ -0,0 +1,60 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "MappedFileStream.h"
+#include "Log.h"
+
+#include <fstream>
+
+namespace nrEngine{
+
+	//----------------------------------------------------------------------------------
+	MappedFileStream::MappedFileStream() : ArchiveFileStream(SharedPtr<ArchiveMapping>(), NULL, 0)
+	{
+		setResourceType("MappedFile");
+	}
+
+	//----------------------------------------------------------------------------------
+	MappedFileStream::~MappedFileStream()
+	{
+
+	}
+
+	//----------------------------------------------------------------------------------
+	Result MappedFileStream::open (const ::std::string& fileName)
+	{
+		SharedPtr<ArchiveMapping> mapping(new ArchiveMapping(fileName));
+
+		// empty files could not be mapped, but they exist
+		if (mapping->getData() == NULL){
+			if (!::std::ifstream(fileName.c_str()).good()){
+				NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "The file \"%s\" was not found", fileName.c_str());
+				return FILE_NOT_FOUND;
+			}
+			mapping.reset();
+		}
+
+		if (mapping)
+			setData(mapping, mapping->getData(), mapping->getSize());
+		else
+			setData(mapping, NULL, 0);
+		mResFileName = fileName;
+
+		return OK;
+	}
+
+};
+
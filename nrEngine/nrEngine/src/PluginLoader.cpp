@@ -15,9 +15,32 @@
 // Includes
 //----------------------------------------------------------------------------------
 #include "PluginLoader.h"
+#include "ResourceManager.h"
+#include "ResourceReclaimQueue.h"
 #include "Log.h"
 
+#include <boost/bind.hpp>
+
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+	#include <sys/stat.h>
+#endif
+
 namespace nrEngine{
+
+	//----------------------------------------------------------------------------------
+	// Unload the library, called by the reclaim queue. The result is set to
+	// PLG_UNLOAD_ERROR if the library could not be unloaded.
+	//----------------------------------------------------------------------------------
+	static void closePlugin(PluginHandle handle, const std::string& name, SharedPtr<Result> result)
+	{
+		if (NR_PLUGIN_UNLOAD(handle))
+		{
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, 
+				"Could not unload plugin %s. System Msg: %s", 
+				name.c_str(), PluginLoader::getLastPluginError().c_str());
+			*result = PLG_UNLOAD_ERROR;
+		}
+	}
 	
 	//----------------------------------------------------------------------------------
 	PluginLoader::PluginLoader()
@@ -116,17 +139,30 @@ namespace nrEngine{
 		if (resource->getResType() == "Plugin" || resource->getResType() == "nrPlugin")
 		{
 			Plugin* plugin = dynamic_cast<Plugin*>(resource);
+			if (plugin->mPluginHandle == NULL) return OK;
 
-			if (NR_PLUGIN_UNLOAD(plugin->mPluginHandle))
-			{
-				NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, 
-					"Could not unload plugin %s. System Msg: %s", 
-					plugin->getResName().c_str(), getLastPluginError().c_str());
-				return PLG_UNLOAD_ERROR;
+			// unloading of a library takes some time, so let the reclaim queue do it,
+			// the size of the library file is about the memory freed by it. The
+			// library is unloaded in the main thread, where it was loaded.
+			SharedPtr<Result> result(new Result(OK));
+			if (ResourceManager::isValid()){
+				size_t size = 0;
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+				struct stat st;
+				if (stat(plugin->getResFileName().c_str(), &st) == 0) size = st.st_size;
+#endif
+				ResourceManager::GetSingleton().getReclaimQueue()->push(
+					boost::bind(&closePlugin, plugin->mPluginHandle, plugin->getResName(), result), size, false);
 			}
-			
+			else
+				closePlugin(plugin->mPluginHandle, plugin->getResName(), result);
+
 			// set the handle to 0
 			plugin->mPluginHandle = NULL;
+
+			// the result is known if the library was unloaded at once, a failure
+			// of the queued unloading is only logged
+			return *result;
 		}
 		
 		// OK
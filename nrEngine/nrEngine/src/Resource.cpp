@@ -15,6 +15,7 @@
 // Includes
 //----------------------------------------------------------------------------------
 #include "Resource.h"
+#include "ResourceCache.h"
 
 namespace nrEngine {
 
@@ -25,6 +26,8 @@ namespace nrEngine {
 		mResHandle = 0;
 		mResIsEmpty = false;
 		mParentManager = NULL;
+		mResLevelCount = 1;
+		mResLevel = 0;
 
 		mResDataSize = sizeof(*this);
 	}
@@ -41,6 +44,28 @@ namespace nrEngine {
 		return manager.add(this, name, group);
 	}
 
+	//----------------------------------------------------------------------------------
+	void IResource::declareResDependency(const std::string& name, const std::string& resourceType,
+									const std::string& fileName, const std::string& group)
+	{
+		// each resource is declared only once
+		for (uint32 i=0; i < mResDependency.size(); i++)
+			if (mResDependency[i].name == name) return;
+
+		ResourceDependency dep;
+		dep.name = name;
+		dep.resourceType = resourceType;
+		dep.fileName = fileName;
+		dep.group = group;
+		mResDependency.push_back(dep);
+	}
+
+	//----------------------------------------------------------------------------------
+	void IResource::changeResPayload()
+	{
+		if (mParentManager != NULL) mParentManager->getCache()->forget(mResHandle);
+	}
+
 	//----------------------------------------------------------------------------------
 	Result IResource::reloadRes()
 	{
@@ -48,12 +73,18 @@ namespace nrEngine {
 		Result ret = unloadRes();
 		if (ret != OK) return ret;
 
-		// now force the loader to load the plugin again
-		ret = mResLoader->loadResource(this);
+		// now force the loader to load the plugin again, the cooked form is used if possible
+		if (mParentManager != NULL)
+			ret = mParentManager->getCache()->load(mResLoader, this);
+		else
+			ret = mResLoader->loadResource(this);
+		if (ret != OK) return ret;
+		ret = mResLoader->finalizeResource(this);
 		if (ret != OK) return ret;
 
-		// now setup internal variables
+		// now setup internal variables, only the coarsest level is loaded
 		mResIsLoaded = true;
+		mResLevel = 0;
 
 		// set the datacount back
 		mResDataSize = sizeof(*this);
@@ -0,0 +1,365 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "ResourceCache.h"
+#include "ResourceManager.h"
+#include "ArchiveFileSystem.h"
+#include "Log.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <errno.h>
+
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+	#include <sys/stat.h>
+	#include <stdlib.h>
+	#include <unistd.h>
+#else
+	#include <boost/thread/thread.hpp>
+#endif
+
+namespace nrEngine{
+
+	//----------------------------------------------------------------------------------
+	ResourceCache::ResourceCache(ResourceManager* manager)
+	{
+		mManager = manager;
+		mHitCount = 0;
+		mMissCount = 0;
+		mSharing = false;
+		mSharedCount = 0;
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceCache::~ResourceCache()
+	{
+
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceCache::setDirectory(const ::std::string& directory)
+	{
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+		if (directory.length() > 0 && mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourceCache: Can not create directory %s", directory.c_str());
+			return FILE_ERROR;
+		}
+#endif
+		boost::mutex::scoped_lock lock(mMutex);
+		mDirectory = directory;
+
+		NR_Log(Log::LOG_ENGINE, "ResourceCache: Cooked resources are stored in \"%s\"", directory.c_str());
+		return OK;
+	}
+
+	//----------------------------------------------------------------------------------
+	::std::string ResourceCache::getDirectory()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mDirectory;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceCache::hashFile(const ::std::string& fileName, uint64& hash)
+	{
+		::std::ifstream file(fileName.c_str(), ::std::ios::binary);
+		if (!file.good()) return false;
+
+		hash = 14695981039346656037ULL;
+		char buffer[4096];
+		while (file.good()){
+			file.read(buffer, sizeof(buffer));
+			::std::streamsize count = file.gcount();
+			for (::std::streamsize i=0; i < count; i++){
+				hash ^= (byte)buffer[i];
+				hash *= 1099511628211ULL;
+			}
+		}
+		return file.eof();
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceCache::getFileKey(const ::std::string& fileName, uint64& key)
+	{
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+		struct stat st;
+		if (fileName.length() == 0 || stat(fileName.c_str(), &st) != 0) return false;
+
+		// a file written twice in the same second does mostly differ in the nanoseconds
+		uint64 stamp[3];
+		stamp[0] = uint64(st.st_size);
+		stamp[1] = uint64(st.st_mtim.tv_sec);
+		stamp[2] = uint64(st.st_mtim.tv_nsec);
+
+		key = 14695981039346656037ULL;
+		for (uint32 i=0; i < fileName.length(); i++){
+			key ^= (byte)fileName[i];
+			key *= 1099511628211ULL;
+		}
+		const byte* data = (const byte*)stamp;
+		for (uint32 i=0; i < sizeof(stamp); i++){
+			key ^= data[i];
+			key *= 1099511628211ULL;
+		}
+		return true;
+#else
+		// no cheap way to get the modification time, so the content is the key
+		return hashFile(fileName, key);
+#endif
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceCache::getFileHash(const ::std::string& fileName, uint64 key, uint64& hash)
+	{
+		{
+			boost::mutex::scoped_lock lock(mMutex);
+			::std::map< ::std::string, ::std::pair<uint64, uint64> >::const_iterator it = mFileHash.find(fileName);
+			if (it != mFileHash.end() && it->second.first == key){
+				hash = it->second.second;
+				return true;
+			}
+		}
+
+		// the file is new or was changed
+		if (!hashFile(fileName, hash)) return false;
+
+		boost::mutex::scoped_lock lock(mMutex);
+		mFileHash[fileName] = ::std::pair<uint64, uint64>(key, hash);
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	::std::string ResourceCache::getFileName(const ::std::string& dir, const ::std::string& loaderName, uint32 version, uint64 key)
+	{
+		// loader names could contain characters not allowed in file names
+		::std::string name = loaderName;
+		for (uint32 i=0; i < name.length(); i++){
+			if (!isalnum(name[i])) name[i] = '_';
+		}
+
+		char suffix[64];
+		sprintf(suffix, "-%u-%08x%08x.cooked", version, uint32(key >> 32), uint32(key));
+		return dir + "/" + name + suffix;
+	}
+
+	//----------------------------------------------------------------------------------
+	SharedPtr<ArchiveMapping> ResourceCache::find(const ::std::string& loaderName, uint32 version, uint64 key)
+	{
+		::std::string dir = getDirectory();
+		if (dir.length() == 0) return SharedPtr<ArchiveMapping>();
+
+		SharedPtr<ArchiveMapping> mapping(new ArchiveMapping(getFileName(dir, loaderName, version, key)));
+		if (mapping->getData() == NULL) return SharedPtr<ArchiveMapping>();
+
+		// check whenever the file is a complete cooked file with this key
+		const Header* h = (const Header*)mapping->getData();
+		if (mapping->getSize() < sizeof(Header) || memcmp(h->magic, NR_COOKED_MAGIC, 4) != 0
+			|| h->byteOrder != 0x01020304 || h->version != version || h->key != key
+			|| h->size != mapping->getSize() - sizeof(Header)){
+			NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceCache: Cooked file of loader %s is damaged", loaderName.c_str());
+			return SharedPtr<ArchiveMapping>();
+		}
+
+		return mapping;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceCache::store(const ::std::string& loaderName, uint32 version, uint64 key, const ::std::vector<byte>& data)
+	{
+		::std::string dir = getDirectory();
+		if (dir.length() == 0) return OK;
+
+		Header h;
+		memcpy(h.magic, NR_COOKED_MAGIC, 4);
+		h.byteOrder = 0x01020304;
+		h.version = version;
+		h.reserved = 0;
+		h.key = key;
+		h.size = data.size();
+
+		// the temporary file is created with a unique name, so other
+		// threads and processes writing the same cooked file does not clash
+		::std::string fileName = getFileName(dir, loaderName, version, key);
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+		::std::string tmpName = fileName + ".XXXXXX";
+		int fd = mkstemp(&tmpName[0]);
+		if (fd < 0){
+			NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceCache: Can not write %s", fileName.c_str());
+			return FILE_ERROR;
+		}
+		fchmod(fd, 0644);
+		close(fd);
+#else
+		::std::ostringstream tmp;
+		tmp << fileName << "." << boost::this_thread::get_id() << ".tmp";
+		::std::string tmpName = tmp.str();
+#endif
+
+		::std::ofstream out(tmpName.c_str(), ::std::ios::binary | ::std::ios::trunc);
+		out.write((const char*)&h, sizeof(Header));
+		if (data.size()) out.write((const char*)&data[0], data.size());
+		out.close();
+
+		if (out.fail() || rename(tmpName.c_str(), fileName.c_str()) != 0){
+			NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceCache: Can not write %s", fileName.c_str());
+			remove(tmpName.c_str());
+			return FILE_ERROR;
+		}
+
+		return OK;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceCache::setSharing(bool enable)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		mSharing = enable;
+		if (!enable){
+			mPayload.clear();
+			mPayloadKey.clear();
+			mFileHash.clear();
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceCache::isSharing()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mSharing;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceCache::forgetPayload(ResourceHandle handle)
+	{
+		::std::map<ResourceHandle, PayloadKey>::iterator it = mPayloadKey.find(handle);
+		if (it == mPayloadKey.end()) return;
+
+		::std::map<PayloadKey, ResourceHandle>::iterator jt = mPayload.find(it->second);
+		if (jt != mPayload.end() && jt->second == handle) mPayload.erase(jt);
+		mPayloadKey.erase(it);
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceCache::forget(ResourceHandle handle)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		forgetPayload(handle);
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceCache::share(IResource* res, const PayloadKey& key)
+	{
+		ResourceHandle source = 0;
+		{
+			boost::mutex::scoped_lock lock(mMutex);
+
+			// the resource could be reloaded from a changed file, so forget its old payload
+			forgetPayload(res->getResHandle());
+
+			::std::map<PayloadKey, ResourceHandle>::iterator jt = mPayload.find(key);
+			if (jt == mPayload.end() || jt->second == res->getResHandle()) return false;
+			source = jt->second;
+		}
+
+		if (!mManager->sharePayload(source, res)) return false;
+
+		NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "ResourceCache: Resource %s shares the payload of an identical one", res->getResName().c_str());
+
+		boost::mutex::scoped_lock lock(mMutex);
+		mSharedCount++;
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceCache::remember(IResource* res, const PayloadKey& key)
+	{
+		ResourceHandle source = 0;
+		{
+			boost::mutex::scoped_lock lock(mMutex);
+			::std::map<PayloadKey, ResourceHandle>::iterator it = mPayload.find(key);
+			if (it != mPayload.end()) source = it->second;
+		}
+
+		// keep the payload of an other resource as long as it is loaded
+		if (source != 0 && mManager->isPayloadLoaded(source)) return;
+
+		boost::mutex::scoped_lock lock(mMutex);
+		mPayload[key] = res->getResHandle();
+		mPayloadKey[res->getResHandle()] = key;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceCache::load(ResourceLoader loader, IResource* res)
+	{
+		NR_ASSERT(loader != NULL && res != NULL);
+
+		// loader does not cook or cache is disabled and nothing is shared or the resource has no file
+		uint32 version = loader->getCookVersion();
+		bool cook = version > 0 && getDirectory().length() > 0;
+		bool sharing = isSharing() && res->isResPayloadShareable();
+		uint64 fileKey = 0;
+		if ((!cook && !sharing) || !getFileKey(res->getResFileName(), fileKey)){
+			return loader->loadResource(res);
+		}
+		::std::string loaderName = mManager->getLoaderName(loader);
+
+		// take the payload of an identical resource if there is one
+		uint64 hash = 0;
+		sharing = sharing && getFileHash(res->getResFileName(), fileKey, hash);
+		PayloadKey key(loaderName + ":" + res->getResType(), hash);
+		if (sharing && share(res, key)) return OK;
+
+		Result ret = cook ? loadCooked(loader, res, loaderName, version, fileKey) : loader->loadResource(res);
+		if (ret == OK && sharing) remember(res, key);
+
+		return ret;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceCache::loadCooked(ResourceLoader loader, IResource* res, const ::std::string& loaderName, uint32 version, uint64 key)
+	{
+		// use the cooked form if there is a matching one
+		SharedPtr<ArchiveMapping> cooked = find(loaderName, version, key);
+		if (cooked){
+			Result ret = loader->loadCookedResource(res, cooked->getData() + sizeof(Header), cooked->getSize() - sizeof(Header));
+			if (ret == OK){
+				boost::mutex::scoped_lock lock(mMutex);
+				mHitCount++;
+				return OK;
+			}
+			NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceCache: Cooked form of %s could not be loaded", res->getResName().c_str());
+		}
+
+		{
+			boost::mutex::scoped_lock lock(mMutex);
+			mMissCount++;
+		}
+
+		// load from the file and store the cooked form for the next time
+		Result ret = loader->loadResource(res);
+		if (ret != OK) return ret;
+
+		::std::vector<byte> data;
+		if (loader->cookResource(res, data) == OK){
+			store(loaderName, version, key, data);
+		}
+
+		return OK;
+	}
+
+};
+
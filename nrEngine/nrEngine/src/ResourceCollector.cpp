@@ -0,0 +1,53 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "ResourceCollector.h"
+#include "ResourceManager.h"
+#include "Profiler.h"
+
+namespace nrEngine{
+
+	//----------------------------------------------------------------------------------
+	ResourceCollector::ResourceCollector(ResourceManager* manager) : ITask("ResourceCollector")
+	{
+		mManager = manager;
+		mIdleFrames = 0;
+		mScanCount = 64;
+		mCursor = 0;
+		mCollected = 0;
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceCollector::~ResourceCollector()
+	{
+
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceCollector::taskUpdate()
+	{
+		// Profiling of the engine
+		_nrEngineProfile("ResourceCollector.taskUpdate");
+
+		mManager->nextFrame();
+		if (mIdleFrames == 0) return OK;
+
+		mCollected += mManager->collectIdle(mCursor, mScanCount, mManager->getFrame(), mIdleFrames);
+		return OK;
+	}
+
+};
+
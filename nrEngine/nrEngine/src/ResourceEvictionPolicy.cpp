@@ -0,0 +1,129 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "ResourceEvictionPolicy.h"
+#include "ResourceStatistics.h"
+#include <algorithm>
+
+namespace nrEngine{
+
+	//----------------------------------------------------------------------------------
+	void ResourceEvictionPolicy::selectVictims(CandidateList& candidates, std::size_t bytesToFree, std::vector<ResourceHandle>& victims)
+	{
+		if (bytesToFree == 0) return;
+
+		// sort the candidates, so the first should be unloaded first
+		Compare cmp;
+		cmp.policy = this;
+		std::sort(candidates.begin(), candidates.end(), cmp);
+
+		// unload until we have enough memory
+		std::size_t freed = 0;
+		for (uint32 i=0; i < candidates.size() && freed < bytesToFree; i++){
+			if (candidates[i].locked) continue;
+			victims.push_back(candidates[i].handle);
+			freed += candidates[i].size;
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	bool LeastUsedEvictionPolicy::less(const ResourceEvictionCandidate& a, const ResourceEvictionCandidate& b) const
+	{
+		return a.accessCount < b.accessCount;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool PriorityEvictionPolicy::less(const ResourceEvictionCandidate& a, const ResourceEvictionCandidate& b) const
+	{
+		// greater priority number means less important
+		if (a.priority != b.priority) return a.priority > b.priority;
+		return a.accessCount < b.accessCount;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool SizeWeightedEvictionPolicy::less(const ResourceEvictionCandidate& a, const ResourceEvictionCandidate& b) const
+	{
+		// compare size/access of both without division
+		return float64(a.size) * float64(b.accessCount + 1) > float64(b.size) * float64(a.accessCount + 1);
+	}
+
+	//----------------------------------------------------------------------------------
+	void GroupQuotaEvictionPolicy::setQuota(const std::string& group, std::size_t bytes)
+	{
+		if (bytes == 0)
+			mQuota.erase(group);
+		else
+			mQuota[group] = bytes;
+	}
+
+	//----------------------------------------------------------------------------------
+	std::size_t GroupQuotaEvictionPolicy::getQuota(const std::string& group) const
+	{
+		QuotaMap::const_iterator it = mQuota.find(group);
+		if (it == mQuota.end()) return 0;
+		return it->second;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool GroupQuotaEvictionPolicy::isQuotaExceeded(ResourceStatistics& statistics) const
+	{
+		// there are only a few quotas, so check each of them
+		QuotaMap::const_iterator it = mQuota.begin();
+		for (; it != mQuota.end(); it++){
+			if (statistics.getGroupUsage(it->first).memory > it->second) return true;
+		}
+		return false;
+	}
+
+	//----------------------------------------------------------------------------------
+	void GroupQuotaEvictionPolicy::selectVictims(CandidateList& candidates, std::size_t bytesToFree, std::vector<ResourceHandle>& victims)
+	{
+		// compute the memory used by each group with a quota
+		std::map<std::string, std::size_t> usage;
+		for (uint32 i=0; i < candidates.size(); i++){
+			if (mQuota.find(*candidates[i].group) != mQuota.end())
+				usage[*candidates[i].group] += candidates[i].size;
+		}
+
+		// least used resources first
+		Compare cmp;
+		cmp.policy = this;
+		std::sort(candidates.begin(), candidates.end(), cmp);
+
+		// unload resources of groups which exceed their quota
+		std::size_t freed = 0;
+		CandidateList rest;
+		for (uint32 i=0; i < candidates.size(); i++){
+			const ResourceEvictionCandidate& c = candidates[i];
+			if (c.locked) continue;
+
+			std::map<std::string, std::size_t>::iterator it = usage.find(*c.group);
+			if (it != usage.end() && it->second > mQuota[*c.group]){
+				victims.push_back(c.handle);
+				it->second -= c.size;
+				freed += c.size;
+			}else{
+				rest.push_back(c);
+			}
+		}
+
+		// if it is still not enough, so unload least used of the others
+		if (freed < bytesToFree)
+			LeastUsedEvictionPolicy::selectVictims(rest, bytesToFree - freed, victims);
+	}
+
+};
+
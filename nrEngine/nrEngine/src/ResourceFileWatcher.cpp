@@ -0,0 +1,296 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "ResourceFileWatcher.h"
+#include "ResourceManager.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "GetTime.h"
+
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+	#include <sys/inotify.h>
+	#include <unistd.h>
+	#include <limits.h>
+	#include <stdlib.h>
+
+	//! We are interested in files which are completely written or moved in
+	#define NR_WATCH_MASK (IN_CLOSE_WRITE | IN_MOVED_TO)
+#endif
+
+namespace nrEngine{
+
+	//----------------------------------------------------------------------------------
+	static uint64 getMilliseconds()
+	{
+		timeval now;
+		gettimeofday(&now, NULL);
+		return uint64(now.tv_sec) * 1000 + now.tv_usec / 1000;
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceFileWatcher::ResourceFileWatcher(ResourceManager* manager) : ITask("ResourceFileWatcher")
+	{
+		mManager = manager;
+		mFd = -1;
+		mDebounceTime = 200;
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceFileWatcher::~ResourceFileWatcher()
+	{
+		disable();
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceFileWatcher::splitPath(const ::std::string& fileName, ::std::string& dir, ::std::string& name)
+	{
+		::std::string::size_type pos = fileName.rfind('/');
+		if (pos == ::std::string::npos){
+			dir = ".";
+			name = fileName;
+		}else{
+			dir = pos == 0 ? "/" : fileName.substr(0, pos);
+			name = fileName.substr(pos + 1);
+		}
+
+		// different spellings of the same directory should give the same path
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+		char real[PATH_MAX];
+		if (realpath(dir.c_str(), real) != NULL) dir = real;
+#endif
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceFileWatcher::addWatch(const ::std::string& path, Directory& dir)
+	{
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+		dir.wd = inotify_add_watch(mFd, path.c_str(), NR_WATCH_MASK);
+		if (dir.wd < 0){
+			NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceFileWatcher: Can not watch directory %s", path.c_str());
+			return;
+		}
+		mWatch[dir.wd] = path;
+#endif
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceFileWatcher::enable()
+	{
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+		{
+			boost::mutex::scoped_lock lock(mMutex);
+			if (mFd >= 0) return OK;
+
+			mFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (mFd < 0){
+				NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourceFileWatcher: inotify could not be initialized");
+				return RES_ERROR;
+			}
+
+			// watch the directories of all files known so far
+			DirectoryMap::iterator it = mDirectory.begin();
+			for (; it != mDirectory.end(); it++){
+				addWatch(it->first, it->second);
+			}
+		}
+
+		// files of resources added while the watcher was disabled. The manager
+		// does call watch(), so the lock is not held here.
+		mManager->watchResources();
+
+		boost::mutex::scoped_lock lock(mMutex);
+		NR_Log(Log::LOG_ENGINE, "ResourceFileWatcher: Watch %lu files in %lu directories", (unsigned long)mFile.size(), (unsigned long)mWatch.size());
+		return OK;
+#else
+		NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceFileWatcher: File watching is not supported on this platform");
+		return RES_ERROR;
+#endif
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceFileWatcher::disable()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		if (mFd < 0) return;
+
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+		// closing does remove all the watches
+		close(mFd);
+#endif
+		mFd = -1;
+		mWatch.clear();
+		mChanged.clear();
+
+		DirectoryMap::iterator it = mDirectory.begin();
+		for (; it != mDirectory.end(); it++){
+			it->second.wd = -1;
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceFileWatcher::watch(ResourceHandle handle, const ::std::string& fileName, WatchEntry& entry)
+	{
+		// the path is not resolved while nobody does watch
+		if (fileName.length() == 0 || mFd < 0) return false;
+
+		::std::string dir, name;
+		splitPath(fileName, dir, name);
+
+		boost::mutex::scoped_lock lock(mMutex);
+		if (mFd < 0) return false;
+
+		::std::string path = dir + "/" + name;
+		entry = mFile.insert(FileMap::value_type(path, handle));
+
+		// watch the directory with the first file in it
+		DirectoryMap::iterator it = mDirectory.find(dir);
+		if (it == mDirectory.end()){
+			Directory d;
+			d.wd = -1;
+			d.fileCount = 0;
+			it = mDirectory.insert(DirectoryMap::value_type(dir, d)).first;
+			addWatch(dir, it->second);
+		}
+		it->second.fileCount++;
+
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceFileWatcher::unwatch(WatchEntry entry)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		::std::string path = entry->first;
+
+		// remove the resource from the file
+		mFile.erase(entry);
+
+		// stop watching the directory with its last file
+		::std::string::size_type pos = path.rfind('/');
+		::std::string dir = pos == 0 ? "/" : path.substr(0, pos);
+		DirectoryMap::iterator dt = mDirectory.find(dir);
+		if (dt == mDirectory.end() || --dt->second.fileCount > 0) return;
+
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+		if (mFd >= 0 && dt->second.wd >= 0){
+			inotify_rm_watch(mFd, dt->second.wd);
+			mWatch.erase(dt->second.wd);
+		}
+#endif
+		mDirectory.erase(dt);
+	}
+
+	//----------------------------------------------------------------------------------
+	uint32 ResourceFileWatcher::getPendingCount()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mChanged.size();
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceFileWatcher::readEvents(uint64 now)
+	{
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+		char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+		while (true){
+			ssize_t len = read(mFd, buffer, sizeof(buffer));
+			if (len <= 0) return;
+
+			for (char* ptr = buffer; ptr < buffer + len; ){
+				const inotify_event* ev = (const inotify_event*)ptr;
+				ptr += sizeof(inotify_event) + ev->len;
+
+				// too many changes, so reload everything
+				if (ev->mask & IN_Q_OVERFLOW){
+					NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceFileWatcher: Event queue overflow, reload all watched files");
+					for (FileMap::const_iterator it = mFile.begin(); it != mFile.end(); it++){
+						mChanged[it->first] = now;
+					}
+					continue;
+				}
+
+				// directory was removed
+				if (ev->mask & IN_IGNORED){
+					WatchMap::iterator it = mWatch.find(ev->wd);
+					if (it != mWatch.end()){
+						DirectoryMap::iterator dt = mDirectory.find(it->second);
+						if (dt != mDirectory.end()) dt->second.wd = -1;
+						mWatch.erase(it);
+					}
+					continue;
+				}
+
+				// only changes of files used by resources are interesting
+				WatchMap::const_iterator it = mWatch.find(ev->wd);
+				if (it == mWatch.end() || ev->len == 0) continue;
+
+				::std::string path = it->second + "/" + ev->name;
+				if (mFile.find(path) != mFile.end()){
+					mChanged[path] = now;
+				}
+			}
+		}
+#endif
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceFileWatcher::taskUpdate()
+	{
+		// Profiling of the engine
+		_nrEngineProfile("ResourceFileWatcher.taskUpdate");
+
+		::std::vector<ResourceHandle> reload;
+		{
+			boost::mutex::scoped_lock lock(mMutex);
+			if (mFd < 0) return OK;
+
+			uint64 now = getMilliseconds();
+			readEvents(now);
+
+			// get resources of files which are not changed for the debounce time
+			ChangeMap::iterator it = mChanged.begin();
+			while (it != mChanged.end()){
+				if (now - it->second < mDebounceTime){
+					it++;
+					continue;
+				}
+
+				NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "ResourceFileWatcher: File %s has changed", it->first.c_str());
+				::std::pair<FileMap::iterator, FileMap::iterator> range = mFile.equal_range(it->first);
+				for (FileMap::iterator jt = range.first; jt != range.second; jt++){
+					reload.push_back(jt->second);
+				}
+				mChanged.erase(it++);
+			}
+		}
+
+		// resources depending on the changed ones has to be reloaded too,
+		// each one after the resources it depends on
+		if (reload.size() > 0) mManager->reloadDependentsAsync(reload);
+
+		return OK;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceFileWatcher::taskStop()
+	{
+		disable();
+		return OK;
+	}
+
+};
+
@@ -0,0 +1,392 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "ResourceHeap.h"
+#include "ResourceStatistics.h"
+#include "Log.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+//! Bits of a block handle used for the index of the block
+#define NR_HEAP_BLOCK_BITS 22
+#define NR_HEAP_BLOCK_MASK ((1 << NR_HEAP_BLOCK_BITS) - 1)
+
+namespace nrEngine{
+
+	//----------------------------------------------------------------------------------
+	ResourceHeap::ResourceHeap(size_t chunkSize) : ITask("ResourceHeap")
+	{
+		mChunkSize = align(chunkSize > 0 ? chunkSize : NR_HEAP_CHUNK_SIZE);
+		mFreeBlock = 0;
+		mFootprint = 0;
+		mUsed = 0;
+		mCompactChunk = -1;
+		mCompactIndex = 0;
+		mCompactOffset = 0;
+		mCompactKept = 0;
+		mCompactMoved = false;
+		mTimeBudget = 1000;
+
+		// block 0 is no block
+		Block b;
+		b.chunk = -1;
+		b.offset = 0;
+		b.size = 0;
+		b.locks = 0;
+		b.generation = 0;
+		b.nextFree = 0;
+		mBlock.push_back(b);
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceHeap::~ResourceHeap()
+	{
+		if (mUsed > 0){
+			NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceHeap: %lu bytes are still allocated", (unsigned long)mUsed);
+		}
+		for (uint32 i=0; i < mChunk.size(); i++){
+			delete [] mChunk[i].data;
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	HeapBlock ResourceHeap::makeHandle(uint32 index) const
+	{
+		return index | ((mBlock[index].generation << NR_HEAP_BLOCK_BITS) & ~NR_HEAP_BLOCK_MASK);
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceHeap::Block* ResourceHeap::getBlock(HeapBlock block)
+	{
+		uint32 index = block & NR_HEAP_BLOCK_MASK;
+		if (index == 0 || index >= mBlock.size()) return NULL;
+		if (mBlock[index].chunk < 0 || makeHandle(index) != block) return NULL;
+		return &mBlock[index];
+	}
+
+	//----------------------------------------------------------------------------------
+	int32 ResourceHeap::findChunk(size_t size, int32 except)
+	{
+		for (int32 i=0; i < (int32)mChunk.size(); i++){
+			if (i == except || mChunk[i].data == NULL) continue;
+			if (mChunk[i].size - mChunk[i].top >= size) return i;
+		}
+		return -1;
+	}
+
+	//----------------------------------------------------------------------------------
+	int32 ResourceHeap::createChunk(size_t size)
+	{
+		byte* data = new (::std::nothrow) byte[size];
+		if (data == NULL) return -1;
+
+		// reuse the place of a released chunk
+		int32 index = 0;
+		while (index < (int32)mChunk.size() && mChunk[index].data != NULL) index++;
+		if (index == (int32)mChunk.size()) mChunk.push_back(Chunk());
+
+		Chunk& c = mChunk[index];
+		c.data = data;
+		c.size = size;
+		c.top = 0;
+		c.used = 0;
+		c.settled = false;
+		mFootprint += size;
+
+		return index;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceHeap::releaseChunk(int32 chunk)
+	{
+		Chunk& c = mChunk[chunk];
+		mFootprint -= c.size;
+		delete [] c.data;
+		c.data = NULL;
+		c.size = 0;
+		c.top = 0;
+		c.used = 0;
+		::std::vector<uint32>().swap(c.blocks);
+	}
+
+	//----------------------------------------------------------------------------------
+	HeapBlock ResourceHeap::allocate(size_t size)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		size_t aligned = align(size > 0 ? size : 1);
+
+		// the chunk beeing defragmented should get empty
+		int32 chunk = findChunk(aligned, mCompactChunk);
+		if (chunk < 0) chunk = createChunk(::std::max(mChunkSize, aligned));
+		if (chunk < 0){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourceHeap: Can not allocate %lu bytes", (unsigned long)size);
+			return 0;
+		}
+
+		// get a free block
+		uint32 index = mFreeBlock;
+		if (index != 0){
+			mFreeBlock = mBlock[index].nextFree;
+		}else{
+			if (mBlock.size() > NR_HEAP_BLOCK_MASK){
+				NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourceHeap: There are too many blocks");
+				return 0;
+			}
+			index = mBlock.size();
+			mBlock.push_back(Block());
+			mBlock[index].generation = 0;
+		}
+
+		Chunk& c = mChunk[chunk];
+		Block& b = mBlock[index];
+		b.chunk = chunk;
+		b.offset = c.top;
+		b.size = size;
+		b.locks = 0;
+		b.nextFree = 0;
+
+		c.top += aligned;
+		c.used += aligned;
+		c.blocks.push_back(index);
+		mUsed += aligned;
+
+		return makeHandle(index);
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceHeap::free(HeapBlock block)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+
+		Block* b = getBlock(block);
+		if (b == NULL) return;
+		if (b->locks > 0){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourceHeap: Can not free a locked block");
+			return;
+		}
+
+		uint32 index = block & NR_HEAP_BLOCK_MASK;
+		size_t aligned = align(b->size > 0 ? b->size : 1);
+		Chunk& c = mChunk[b->chunk];
+
+		// remove the block from its chunk, the defragmentation does not see it anymore
+		::std::vector<uint32>::iterator it = ::std::find(c.blocks.begin(), c.blocks.end(), index);
+		if (b->chunk == mCompactChunk){
+			uint32 pos = it - c.blocks.begin();
+			if (pos < mCompactKept) mCompactKept--;
+			if (pos < mCompactIndex) mCompactIndex--;
+		}
+		c.blocks.erase(it);
+		c.used -= aligned;
+		c.settled = false;
+		mUsed -= aligned;
+
+		b->chunk = -1;
+		b->generation++;
+		b->nextFree = mFreeBlock;
+		mFreeBlock = index;
+	}
+
+	//----------------------------------------------------------------------------------
+	void* ResourceHeap::lock(HeapBlock block)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+
+		Block* b = getBlock(block);
+		if (b == NULL) return NULL;
+		b->locks++;
+		return mChunk[b->chunk].data + b->offset;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceHeap::unlock(HeapBlock block)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+
+		Block* b = getBlock(block);
+		if (b == NULL || b->locks == 0) return;
+		b->locks--;
+
+		// the block could be moved now
+		if (b->locks == 0) mChunk[b->chunk].settled = false;
+	}
+
+	//----------------------------------------------------------------------------------
+	size_t ResourceHeap::getSize(HeapBlock block)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+
+		Block* b = getBlock(block);
+		return b != NULL ? b->size : 0;
+	}
+
+	//----------------------------------------------------------------------------------
+	size_t ResourceHeap::getFootprint()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mFootprint;
+	}
+
+	//----------------------------------------------------------------------------------
+	size_t ResourceHeap::getUsedBytes()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mUsed;
+	}
+
+	//----------------------------------------------------------------------------------
+	size_t ResourceHeap::getOverhead()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mFootprint - mUsed;
+	}
+
+	//----------------------------------------------------------------------------------
+	size_t ResourceHeap::trim()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+
+		size_t freed = 0;
+		for (int32 i=0; i < (int32)mChunk.size(); i++){
+			if (mChunk[i].data == NULL || mChunk[i].blocks.size() > 0 || i == mCompactChunk) continue;
+			freed += mChunk[i].size;
+			releaseChunk(i);
+		}
+		return freed;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceHeap::beginCompaction()
+	{
+		// choose the chunk with the most unused memory, which has either
+		// holes or could be moved completely into an other chunk
+		int32 chunk = -1;
+		size_t wasted = 0;
+		for (int32 i=0; i < (int32)mChunk.size(); i++){
+			Chunk& c = mChunk[i];
+			if (c.data == NULL || c.settled) continue;
+			if (c.top == c.used && findChunk(c.used, i) < 0){
+				c.settled = true;
+				continue;
+			}
+			if (chunk < 0 || c.size - c.used > wasted){
+				chunk = i;
+				wasted = c.size - c.used;
+			}
+		}
+
+		mCompactChunk = chunk;
+		mCompactIndex = 0;
+		mCompactOffset = 0;
+		mCompactKept = 0;
+		mCompactMoved = false;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceHeap::compactStep()
+	{
+		Chunk& c = mChunk[mCompactChunk];
+		if (mCompactIndex >= c.blocks.size()){
+			endCompaction();
+			return false;
+		}
+
+		uint32 index = c.blocks[mCompactIndex++];
+		Block& b = mBlock[index];
+		size_t aligned = align(b.size > 0 ? b.size : 1);
+
+		// locked blocks stay where they are
+		if (b.locks > 0){
+			c.blocks[mCompactKept++] = index;
+			mCompactOffset = b.offset + aligned;
+			return true;
+		}
+
+		// move into the free space of an other chunk
+		int32 target = findChunk(aligned, mCompactChunk);
+		if (target >= 0){
+			Chunk& t = mChunk[target];
+			memcpy(t.data + t.top, c.data + b.offset, b.size);
+			b.chunk = target;
+			b.offset = t.top;
+			t.top += aligned;
+			t.used += aligned;
+			t.blocks.push_back(index);
+			c.used -= aligned;
+			mCompactMoved = true;
+			return true;
+		}
+
+		// move to the begin of the chunk
+		if (b.offset != mCompactOffset){
+			memmove(c.data + mCompactOffset, c.data + b.offset, b.size);
+			b.offset = mCompactOffset;
+			mCompactMoved = true;
+		}
+		c.blocks[mCompactKept++] = index;
+		mCompactOffset += aligned;
+
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceHeap::endCompaction()
+	{
+		Chunk& c = mChunk[mCompactChunk];
+		c.blocks.resize(mCompactKept);
+		c.top = mCompactOffset;
+
+		// do not try again until a block of the chunk is freed or unlocked
+		c.settled = !mCompactMoved;
+
+		if (c.blocks.size() == 0) releaseChunk(mCompactChunk);
+		mCompactChunk = -1;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceHeap::compact(uint64 budget)
+	{
+		uint64 start = ResourceStatistics::getMicroseconds();
+
+		while (true){
+			{
+				boost::mutex::scoped_lock lock(mMutex);
+				if (mCompactChunk < 0) beginCompaction();
+				if (mCompactChunk < 0) break;
+
+				// other threads could use the heap between the steps
+				compactStep();
+			}
+
+			// the rest is done in the next update
+			if (budget > 0 && ResourceStatistics::getMicroseconds() - start >= budget) break;
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceHeap::taskUpdate()
+	{
+		// Profiling of the engine
+		_nrEngineProfile("ResourceHeap.taskUpdate");
+
+		if (mTimeBudget > 0) compact(mTimeBudget);
+		return OK;
+	}
+
+};
+
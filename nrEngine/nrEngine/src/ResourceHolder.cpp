@@ -19,7 +19,31 @@
 #include "ResourceSystem.h"
 #include "Log.h"
 
+#include <boost/pool/singleton_pool.hpp>
+
 namespace nrEngine{
+
+	//! Tag of the pool used to allocate holders
+	struct ResourceHolderPoolTag{};
+	typedef boost::singleton_pool<ResourceHolderPoolTag, sizeof(ResourceHolder)> ResourceHolderPool;
+
+	//----------------------------------------------------------------------------------
+	void* ResourceHolder::operator new(size_t size){
+		if (size != sizeof(ResourceHolder)) return ::operator new(size);
+
+		void* p = ResourceHolderPool::malloc();
+		if (p == NULL) throw std::bad_alloc();
+		return p;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceHolder::operator delete(void* p, size_t size){
+		if (p == NULL) return;
+		if (size != sizeof(ResourceHolder))
+			::operator delete(p);
+		else
+			ResourceHolderPool::free(p);
+	}
 	
 	//----------------------------------------------------------------------------------
 	ResourceHolder::~ResourceHolder(){
@@ -27,13 +51,7 @@ namespace nrEngine{
 	}
 		
 	//----------------------------------------------------------------------------------
-	ResourceHolder::ResourceHolder(): countAccess(0){
-		
-		// empty the lock stack
-		for (int32 i=0; i < NR_RESOURCE_LOCK_STACK; i++)
-			mLockStack[i] = false;
-			
-		mLockStackTop = 0;
+	ResourceHolder::ResourceHolder(): countAccess(0), mPinFrame(0), mLockDepth(0){
 	
 	}
 		
@@ -41,20 +59,22 @@ namespace nrEngine{
 	bool ResourceHolder::lockPure(){
 
 		// check whenever we've got the maximum, so do not lock
-		if (mLockStackTop >= NR_RESOURCE_LOCK_STACK){
-			if (mResource.get()){
-				NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, 
-					"Can not lock %s anymore. Lock state stack is full!", mResource->getResName().c_str());	
-			}else{
-				NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, 
-					"Can not lock anymore. Lock state stack is full!");
+		uint32 depth = mLockDepth.load();
+		do{
+			if (depth >= (uint32)NR_RESOURCE_LOCK_STACK){
+				if (mResource.get()){
+					NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, 
+						"Can not lock %s anymore. Maximal lock depth is reached!", mResource->getResName().c_str());	
+				}else{
+					NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, 
+						"Can not lock anymore. Maximal lock depth is reached!");
+				}
+				
+				return false;
 			}
-			
-			return false;
-		}else{		
-			// lock it
-			mLockStack[mLockStackTop++] = true;
-		}
+
+		// lock it, other threads could lock at the same time
+		}while (!mLockDepth.compare_exchange_weak(depth, depth + 1));
 		
 		return true;
 	}	
@@ -62,11 +82,9 @@ namespace nrEngine{
 	//----------------------------------------------------------------------------------
 	void ResourceHolder::unlockPure(){
 	
-		// check whenever we've got right top position
-		if (mLockStackTop > 0){
-			// unlock it
-			mLockStack[--mLockStackTop] = false;
-		}
+		// check whenever we are locked and unlock it
+		uint32 depth = mLockDepth.load();
+		while (depth > 0 && !mLockDepth.compare_exchange_weak(depth, depth - 1));
 	}
 		
 	//----------------------------------------------------------------------------------
@@ -87,27 +105,11 @@ namespace nrEngine{
 
 	
 	//----------------------------------------------------------------------------------
-	IResource* ResourceHolder::getEmpty(){
-		return mEmptyResource.get();
-	}
-	
-		
-	//----------------------------------------------------------------------------------
-	IResource* ResourceHolder::getResource(){
-		
-		// touch the resource
-		touchResource();
-			
-		// get resource only if it is exists and loaded or if it exists and locked
-		if (mResource.get()!=NULL){
-			if (mResource->isResLoaded() || isLocked()){
-				return mResource.get();
-			}
-		}
-		
-		NR_ASSERT(getEmpty() != NULL && "Here empty resource should be defined");
-		
-		return getEmpty();
+	IResource* ResourceHolder::pin(uint32 frame){
+
+		// pinned resources are counted once per frame
+		if (mPinFrame.exchange(frame, ::boost::memory_order_relaxed) != frame) touchResource();
+		return selectResource();
 	}
 
 };
@@ -0,0 +1,337 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "ResourceLoadQueue.h"
+#include "Log.h"
+#include "Profiler.h"
+#include <boost/bind.hpp>
+#include <algorithm>
+
+namespace nrEngine{
+
+	//----------------------------------------------------------------------------------
+	ResourceLoadQueue::ResourceLoadQueue(ResourceManager* manager, uint32 threadCount) : ITask("ResourceLoadQueue")
+	{
+		mManager = manager;
+		mOrder = 0;
+		mThreadCount = threadCount > 0 ? threadCount : 1;
+		mTimeBudget = 2000;
+		mStarted = false;
+		mShutdown = false;
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceLoadQueue::~ResourceLoadQueue()
+	{
+		shutdown();
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceLoadQueue::push(IResource* res, ResourceLoader loader, Priority priority, int32 level)
+	{
+		NR_ASSERT(res != NULL && loader != NULL);
+
+		Request req;
+		req.resource = res;
+		req.loader = loader;
+		req.handle = res->getResHandle();
+		req.level = level;
+		req.result = OK;
+		req.loaded = false;
+		req.loadTime = 0;
+
+		boost::mutex::scoped_lock lock(mMutex);
+		RequestKey key(uint32(priority), mOrder++);
+
+		mIndex.insert(RequestIndex::value_type(req.handle, key));
+
+		// such resources has to be loaded in the main thread
+		if (!loader->isThreadSafe()){
+			mFinished[key] = req;
+			return;
+		}
+
+		// start the threads with the first request
+		if (!mStarted){
+			NR_Log(Log::LOG_ENGINE, "ResourceLoadQueue: Start %d loader threads", mThreadCount);
+			for (uint32 i=0; i < mThreadCount; i++)
+				mThreads.create_thread(boost::bind(&ResourceLoadQueue::run, this));
+			mStarted = true;
+		}
+
+		mQueued[key] = req;
+		mQueueSignal.notify_one();
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceLoadQueue::isRunning(ResourceHandle handle) const
+	{
+		for (uint32 i=0; i < mRunning.size(); i++)
+			if (mRunning[i].first == handle) return true;
+		return false;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceLoadQueue::eraseRequest(RequestMap& map, ResourceHandle handle)
+	{
+		bool found = false;
+		::std::pair<RequestIndex::iterator, RequestIndex::iterator> range = mIndex.equal_range(handle);
+		RequestIndex::iterator it = range.first;
+		while (it != range.second){
+			RequestMap::iterator req = map.find(it->second);
+			if (req != map.end()){
+				if (req->second.level < 0) found = true;
+				map.erase(req);
+				it = mIndex.erase(it);
+			}else
+				it++;
+		}
+		return found;
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceLoadQueue::RequestMap::iterator ResourceLoadQueue::findRequest(RequestMap& map, ResourceHandle handle, bool levels)
+	{
+		::std::pair<RequestIndex::iterator, RequestIndex::iterator> range = mIndex.equal_range(handle);
+		for (; range.first != range.second; range.first++){
+			RequestMap::iterator it = map.find(range.first->second);
+			if (it != map.end() && (it->second.level >= 0) == levels) return it;
+		}
+		return map.end();
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceLoadQueue::removeRequest(RequestMap& map, RequestMap::iterator it)
+	{
+		::std::pair<RequestIndex::iterator, RequestIndex::iterator> range = mIndex.equal_range(it->second.handle);
+		for (; range.first != range.second; range.first++){
+			if (range.first->second == it->first){
+				mIndex.erase(range.first);
+				break;
+			}
+		}
+		map.erase(it);
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceLoadQueue::clearRequests(RequestMap& map)
+	{
+		while (map.size() > 0) removeRequest(map, map.begin());
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceLoadQueue::cancel(ResourceHandle handle)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+
+		// remove the queued request
+		bool found = eraseRequest(mQueued, handle);
+
+		// wait until the loader thread has finished
+		while (isRunning(handle)){
+			mFinishSignal.wait(lock);
+		}
+
+		// drop the result
+		return eraseRequest(mFinished, handle) || found;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceLoadQueue::isPending(ResourceHandle handle, bool levels)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+
+		if (findRequest(mQueued, handle, levels) != mQueued.end()) return true;
+		if (findRequest(mFinished, handle, levels) != mFinished.end()) return true;
+
+		for (uint32 i=0; i < mRunning.size(); i++)
+			if (mRunning[i].first == handle && (mRunning[i].second >= 0) == levels) return true;
+
+		return false;
+	}
+
+	//----------------------------------------------------------------------------------
+	uint32 ResourceLoadQueue::getPendingCount()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mQueued.size() + mRunning.size() + mFinished.size();
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceLoadQueue::waitAll()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		while (mStarted && !mShutdown && (mQueued.size() > 0 || mRunning.size() > 0)){
+			mFinishSignal.wait(lock);
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceLoadQueue::shutdown()
+	{
+		{
+			boost::mutex::scoped_lock lock(mMutex);
+			if (!mStarted) return;
+
+			mShutdown = true;
+			clearRequests(mQueued);
+			mQueueSignal.notify_all();
+			mFinishSignal.notify_all();
+		}
+
+		// wait until all threads are finished
+		mThreads.join_all();
+
+		boost::mutex::scoped_lock lock(mMutex);
+		clearRequests(mFinished);
+		mStarted = false;
+		mShutdown = false;
+		NR_Log(Log::LOG_ENGINE, "ResourceLoadQueue: Loader threads stopped");
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceLoadQueue::run()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+
+		while (true){
+
+			// wait for a request
+			while (!mShutdown && mQueued.size() == 0){
+				mQueueSignal.wait(lock);
+			}
+			if (mShutdown) return;
+
+			// get the most important one
+			RequestKey key = mQueued.begin()->first;
+			Request req = mQueued.begin()->second;
+			mQueued.erase(mQueued.begin());
+			mRunning.push_back(RunningKey(req.handle, req.level));
+
+			// load the resource, the list is not locked while loading
+			lock.unlock();
+			uint64 start = ResourceStatistics::getMicroseconds();
+			if (req.level < 0)
+				req.result = mManager->getCache()->load(req.loader, req.resource);
+			else
+				req.result = req.loader->loadResourceLevel(req.resource, uint32(req.level));
+			req.loadTime = ResourceStatistics::getMicroseconds() - start;
+			req.loaded = true;
+			lock.lock();
+
+			// store the result
+			mRunning.erase(::std::find(mRunning.begin(), mRunning.end(), RunningKey(req.handle, req.level)));
+			mFinished[key] = req;
+			mFinishSignal.notify_all();
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceLoadQueue::finish(ResourceHandle handle)
+	{
+		Request req;
+		bool found = false;
+		{
+			boost::mutex::scoped_lock lock(mMutex);
+
+			// take the queued request, so it is loaded here
+			RequestMap::iterator it = findRequest(mQueued, handle, false);
+			if (it != mQueued.end()){
+				req = it->second;
+				removeRequest(mQueued, it);
+				found = true;
+			}
+
+			// otherwise wait for the loader thread and take its result
+			while (!found && isRunning(handle)){
+				mFinishSignal.wait(lock);
+			}
+			if (!found && (it = findRequest(mFinished, handle, false)) != mFinished.end()){
+				req = it->second;
+				removeRequest(mFinished, it);
+				found = true;
+			}
+		}
+
+		if (found) finalize(req);
+		return found;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceLoadQueue::finalize(Request& req)
+	{
+		// load resources of loaders which are not thread safe now
+		uint64 finalizeStart = ResourceStatistics::getMicroseconds();
+		if (!req.loaded){
+			if (req.level < 0)
+				req.result = mManager->getCache()->load(req.loader, req.resource);
+			else
+				req.result = req.loader->loadResourceLevel(req.resource, uint32(req.level));
+		}
+
+		// do the main thread work and hand the resource back to the manager
+		if (req.level < 0){
+			if (req.result == OK){
+				req.result = req.loader->finalizeResource(req.resource);
+			}
+			uint64 now = ResourceStatistics::getMicroseconds();
+			mManager->finishAsyncLoad(req.handle, req.result, req.loadTime + now - finalizeStart);
+		}else{
+			if (req.result == OK){
+				req.result = req.loader->finalizeResourceLevel(req.resource, uint32(req.level));
+			}
+			mManager->finishLevelLoad(req.handle, uint32(req.level), req.result);
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceLoadQueue::taskUpdate()
+	{
+		// Profiling of the engine
+		_nrEngineProfile("ResourceLoadQueue.taskUpdate");
+
+		uint64 start = ResourceStatistics::getMicroseconds();
+
+		while (true){
+
+			// get the most important finished request
+			Request req;
+			{
+				boost::mutex::scoped_lock lock(mMutex);
+				if (mFinished.size() == 0) break;
+				req = mFinished.begin()->second;
+				removeRequest(mFinished, mFinished.begin());
+			}
+
+			finalize(req);
+			uint64 now = ResourceStatistics::getMicroseconds();
+
+			// the rest is done in the next update
+			if (mTimeBudget > 0 && now - start >= mTimeBudget) break;
+		}
+
+		return OK;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceLoadQueue::taskStop()
+	{
+		shutdown();
+		return OK;
+	}
+
+};
+
@@ -44,6 +44,13 @@ namespace nrEngine{
 		res->mResIsEmpty = b;
 	}
 
+	//----------------------------------------------------------------------------------
+	void IResourceLoader::declareDependency(IResource* res, const std::string& name, const std::string& resourceType,
+								const std::string& fileName, const std::string& group){
+		NR_ASSERT(res != NULL);
+		res->declareResDependency(name, resourceType, fileName, group);
+	}
+
 	//----------------------------------------------------------------------------------
 	Result IResourceLoader::loadResource(IResource* resource)
 	{
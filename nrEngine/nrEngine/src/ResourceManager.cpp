@@ -14,52 +14,144 @@
 // Includes
 //----------------------------------------------------------------------------------
 #include "ResourceManager.h"
+#include "EventManager.h"
+#include "events/ResourceEvent.h"
 #include "Log.h"
+#include <algorithm>
+#include <set>
+
+//! Number of bits of the resource handle used for the slot index, the rest is the generation
+#define NR_RESOURCE_SLOT_BITS 24
+#define NR_RESOURCE_SLOT_MASK ((1 << NR_RESOURCE_SLOT_BITS) - 1)
+
+//! Marks the end of the free slot list
+#define NR_RESOURCE_NO_SLOT 0xFFFFFFFF
+
+//! Number of slots allocated at once, the slots are never moved
+#define NR_RESOURCE_PAGE_BITS 10
+#define NR_RESOURCE_PAGE_SIZE (1 << NR_RESOURCE_PAGE_BITS)
 
 namespace nrEngine{
 
+	//! Slot of the resource database, a handle is the slot index and its generation
+	struct ResourceManager::ResourceSlot{
+		//! Holder stored in the slot (NULL if the slot is free)
+		SharedPtr<ResourceHolder> holder;
+
+		//! Generation of the slot, increased on each removing. 0 if the slot is retired.
+		uint32 generation;
+
+		//! Next free slot if this one is free
+		uint32 nextFree;
+
+		//! Access count of the holder seen by the collector
+		uint64 seenAccess;
+
+		//! Frame of the collector in which the access count did change
+		uint32 seenFrame;
+
+		//! State of the resource recorded by the statistics
+		ResourceStatistics::Entry statistics;
+
+		//! True if the file of the resource is watched
+		bool watched;
+
+		//! Entry of the resource in the file watcher
+		ResourceFileWatcher::WatchEntry watchEntry;
+
+		//! Previous and next slot in the group of the resource
+		uint32 groupPrev;
+		uint32 groupNext;
+	};
+
 	//----------------------------------------------------------------------------------
 	ResourceManager::ResourceManager(){
-		mLastHandle = 1;
+		// pages are allocated on demand, the page table does never grow
+		mSlotPage.resize(((NR_RESOURCE_SLOT_MASK + 1) >> NR_RESOURCE_PAGE_BITS), NULL);
+		for (uint32 i=0; i < NR_RESOURCE_SHARDS; i++){
+			mShard[i].slotCount = 0;
+			mShard[i].freeSlot = NR_RESOURCE_NO_SLOT;
+		}
+
+		// slot 0 is never used, so 0 is never a valid handle
+		mSlotPage[0] = new ResourceSlot[NR_RESOURCE_PAGE_SIZE];
+		mShard[0].slotCount = 1;
+		getSlot(0).generation = 0;
+
 		mMemBudget = 0;
-		mMemUsage = 0;
+		mGroupConcurrency = 8;
+		mStatistics.reset(new ResourceStatistics());
+		mEvictionPolicy.reset(new LeastUsedEvictionPolicy());
+		mLoadQueue.reset(new ResourceLoadQueue(this));
+		mFileWatcher.reset(new ResourceFileWatcher(this));
+		mCache.reset(new ResourceCache(this));
+		mReclaimQueue.reset(new ResourceReclaimQueue());
+		mPreloader.reset(new ResourcePreloader(this));
+		mCollector.reset(new ResourceCollector(this));
+		mHeap.reset(new ResourceHeap());
+		mFrame.store(1);
 	}
 
 
 	//----------------------------------------------------------------------------------
 	ResourceManager::~ResourceManager(){
 
-		// unload all resources
+		// stop loading in the background
+		mLoadQueue->shutdown();
+		mFileWatcher->disable();
+
+		// unload all resources, deferred releases has to be done before the loaders are removed
 		removeAllRes();
+		mReclaimQueue->shutdown();
 
 		// remove all loaders
 		removeAllLoaders();
 
-
+		// release the slot pages
+		for (uint32 i=0; i < mSlotPage.size(); i++){
+			delete [] mSlotPage[i];
+		}
 	}
 
 	//----------------------------------------------------------------------------------
 	void ResourceManager::removeAllRes(){
 
-		// iterate through each resource and remove it
-		res_hdl_map::const_iterator it;
+		// remove the grouped resources group by group
+		::std::vector<ResourceHandle> handles;
+		{
+			::boost::mutex::scoped_lock lock(mGroupMutex);
+			res_grp_map::const_iterator it = mResourceGroup.begin();
+			for (; it != mResourceGroup.end(); it++){
+				for (uint32 slot = it->second.first; slot != NR_RESOURCE_NO_SLOT; slot = getSlot(slot).groupNext){
+					handles.push_back(makeHandle(slot));
+				}
+			}
+		}
+		for (uint32 i=0; i < handles.size(); i++){
+			remove(handles[i]);
+		}
 
-		for (it = mResource.begin(); it != mResource.end(); it++){
-			ResourceHandle hdl = it->first;
-			remove(hdl);
+		// collect the handles of the remaining resources and remove them
+		handles.clear();
+		for (uint32 k=0; k < NR_RESOURCE_SHARDS; k++){
+			ReadLock lock(mShard[k].lock);
+			for (uint32 i=0; i < mShard[k].slotCount; i++){
+				uint32 slot = i * NR_RESOURCE_SHARDS + k;
+				if (getSlot(slot).holder != NULL) handles.push_back(makeHandle(slot));
+			}
+		}
+		for (uint32 i=0; i < handles.size(); i++){
+			remove(handles[i]);
 		}
-		mResource.clear();
 
 
 		// iterate through each empty resource and remove it
+		::boost::mutex::scoped_lock lock(mEmptyMutex);
 		res_empty_map::iterator jt;
 
 		for (jt = mEmptyResource.begin(); jt != mEmptyResource.end(); jt++){
-			SharedPtr<IResource>& res = jt->second;
-
-			NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "ResourceManager: Remove empty resource of type %s", res->getResType().c_str());
-			res.reset();
-			mEmptyResource.erase(jt);
+			NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "ResourceManager: Remove empty resource of type %s", jt->second->getResType().c_str());
+			jt->second.reset();
 		}
 		mEmptyResource.clear();
 
@@ -68,11 +160,15 @@ namespace nrEngine{
 	//----------------------------------------------------------------------------------
 	void ResourceManager::removeAllLoaders(){
 
-		// iterate through all loaders
-		loader_map::const_iterator it;
-
-		for (it = mLoader.begin(); it != mLoader.end(); it++){
-			removeLoader(it->first);
+		// remove the loaders one by one, removing does invalidate the iterators
+		while (true){
+			::std::string name;
+			{
+				ReadLock lock(mLoaderMutex);
+				if (mLoader.size() == 0) break;
+				name = mLoader.begin()->first;
+			}
+			removeLoader(name);
 		}
 
 	}
@@ -91,27 +187,42 @@ namespace nrEngine{
 
 	//----------------------------------------------------------------------------------
 	size_t ResourceManager::getMemoryUsage() const{
-		return mMemUsage;
+		return mStatistics->getMemoryUsage() + mHeap->getOverhead();
 	}
 
 	//----------------------------------------------------------------------------------
-	Result ResourceManager::registerLoader(const ::std::string& name, ResourceLoader loader){
+	void ResourceManager::setEvictionPolicy(SharedPtr<ResourceEvictionPolicy> policy){
+		mEvictionPolicy = policy;
+	}
 
-		// check whenver such a loader already exists
-		if (mLoader.find(name) != mLoader.end()){
-			NR_Log(Log::LOG_ENGINE, "ResourceManager: %s loader already registered", name.c_str());
-			return RES_LOADER_ALREADY_EXISTS;
-		}
+	//----------------------------------------------------------------------------------
+	SharedPtr<ResourceEvictionPolicy> ResourceManager::getEvictionPolicy() const{
+		return mEvictionPolicy;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceManager::registerLoader(const ::std::string& name, ResourceLoader loader){
 
 		// check for bad parameters
 		if (loader == NULL || name.length() == 0){
 			return BAD_PARAMETERS;
 		}
 
-		NR_Log(Log::LOG_ENGINE, "ResourceManager: Register new resource loader %s", name.c_str());
+		{
+			WriteLock lock(mLoaderMutex);
+
+			// check whenver such a loader already exists
+			if (mLoader.find(name) != mLoader.end()){
+				NR_Log(Log::LOG_ENGINE, "ResourceManager: %s loader already registered", name.c_str());
+				return RES_LOADER_ALREADY_EXISTS;
+			}
+
+			NR_Log(Log::LOG_ENGINE, "ResourceManager: Register new resource loader %s", name.c_str());
 
-		// register the loader
-		mLoader[name] = loader;
+			// register the loader
+			mLoader[name] = loader;
+			addLoaderTypes(loader);
+		}
 
 		// Give some log information about supported filetypes and resource types
 		try{
@@ -140,6 +251,8 @@ namespace nrEngine{
 	//----------------------------------------------------------------------------------
 	Result ResourceManager::removeLoader(const ::std::string& name){
 
+		WriteLock lock(mLoaderMutex);
+
 		// get id of the loader
 		loader_map::const_iterator jt = mLoader.find(name);
 		if (jt == mLoader.end()){
@@ -150,17 +263,43 @@ namespace nrEngine{
 
 		mLoader.erase(name);
 
+		// rebuild the lookup tables, so other loaders could take the types
+		mLoaderByFileType.clear();
+		mLoaderByResType.clear();
+		for (jt = mLoader.begin(); jt != mLoader.end(); jt++){
+			addLoaderTypes(jt->second);
+		}
+
 		return OK;
 	}
 
 	//----------------------------------------------------------------------------------
-	ResourceLoader ResourceManager::getLoaderByFile(const ::std::string& fileType){
+	void ResourceManager::addLoaderTypes(ResourceLoader loader){
+
+		// the first registered loader of a type does stay in the table
+		::std::vector< ::std::string>::const_iterator it;
+
+		const ::std::vector< ::std::string>&	fileTypes = loader->getSupportedFileTypes();
+		for (it = fileTypes.begin(); it != fileTypes.end(); it++){
+			if (!mLoaderByFileType.insert(loader_type_map::value_type(*it, loader)).second)
+				NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceManager: There is already a loader for *.%s files", it->c_str());
+		}
+
+		const ::std::vector< ::std::string>&	resTypes = loader->getSupportedResourceTypes();
+		for (it = resTypes.begin(); it != resTypes.end(); it++){
+			if (!mLoaderByResType.insert(loader_type_map::value_type(*it, loader)).second)
+				NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceManager: There is already a loader for %s resources", it->c_str());
+		}
+	}
 
-		// scan through all loaders and ask them if they do support this kind of file type
-		loader_map::const_iterator it;
+	//----------------------------------------------------------------------------------
+	ResourceLoader ResourceManager::getLoaderByFile(const ::std::string& fileType){
 
-		for (it = mLoader.begin(); it != mLoader.end(); it++){
-			if (it->second->supportFileType(fileType)){
+		// get the loader from the table
+		{
+			ReadLock lock(mLoaderMutex);
+			loader_type_map::const_iterator it = mLoaderByFileType.find(fileType);
+			if (it != mLoaderByFileType.end()){
 				return it->second;
 			}
 		}
@@ -174,25 +313,24 @@ namespace nrEngine{
 	//----------------------------------------------------------------------------------
 	ResourceLoader ResourceManager::getLoader(const ::std::string& name){
 
-		loader_map::iterator it = mLoader.find(name);
+		ReadLock lock(mLoaderMutex);
+		loader_map::const_iterator it = mLoader.find(name);
 
 		if (it == mLoader.end()){
 			return ResourceLoader();
 		}
 
-		return mLoader[name];
+		return it->second;
 	}
 
 	//----------------------------------------------------------------------------------
 	ResourceLoader ResourceManager::getLoaderByResource(const ::std::string& resType){
 
-		// scan through all loaders and ask them if they do support this kind of file type
-		loader_map::const_iterator it;
-
-		for (it = mLoader.begin(); it != mLoader.end(); it++){
-			if (it->second->supportResourceType(resType)){
-				return it->second;
-			}
+		// get the loader from the table
+		ReadLock lock(mLoaderMutex);
+		loader_type_map::const_iterator it = mLoaderByResType.find(resType);
+		if (it != mLoaderByResType.end()){
+			return it->second;
 		}
 
 		return ResourceLoader();
@@ -219,7 +357,8 @@ namespace nrEngine{
 		}
 
 		// create new handle
-		ResourceHandle handle = mLastHandle++;
+		ResourceHandle handle = createHandle(name);
+		if (handle == 0) return IResourcePtr();
 		NR_Log(Log::LOG_ENGINE, "ResourceManager: Create new empty resource %s, id=%d", name.c_str(), handle);
 
 		// create resource through implicit creation function
@@ -229,6 +368,7 @@ namespace nrEngine{
 			res = creator->createResourceInstance(resourceType, params);
 			if (res == NULL){
 				NR_Log(Log::LOG_ENGINE, "ResourceManager: Resource instance could not be created. Abort.");
+				releaseHandle(handle);
 				return IResourcePtr();
 			}
 		}
@@ -242,20 +382,19 @@ namespace nrEngine{
 		holder->resetRes(res);
 		holder->setEmptyResource(empty);
 
-		// store the resource in database
-		mResourceGroup[group].push_back(handle);
-		mResource[handle] = holder;
-		mResourceName[name] = handle;
-
 		res->mResGroup = group;
 		res->mResName = name;
 		res->mResHandle = handle;
 		res->mResLoader = creator;
 		res->mParentManager = this;
 
-		// check for memory usage
-		mMemUsage += res->getResDataSize();
+		// store the resource in database
+		insertResource(handle, name, group, holder);
+
+		// check for memory usage, the new resource should not be unloaded
+		holder->lockPure();
 		Result ret = checkMemoryUsage();
+		holder->unlockPure();
 
 		if (ret != OK){
 			NR_Log(Log::LOG_ENGINE, "ResourceManager: Could not rearrange memory");
@@ -273,22 +412,30 @@ namespace nrEngine{
 								const ::std::string& resourceType,
 								const ::std::string& fileName,
 								NameValuePairs* params,
-								ResourceLoader loader){
+								ResourceLoader manualLoader){
 
 		// check whenever right parameters are specified
 		NR_ASSERT(name.length() > 0  && fileName.length() > 0 && resourceType.length() > 0);
 
-		::std::string type = "";
-		ResourceHandle handle;
 		IResource* res = NULL;
-		bool isManualSpecified = (loader != NULL);
 
-		// get appropriate loader for the specified resource type
-		if (resourceType.length() > 0){
-			loader = getLoaderByResource(resourceType);
-			if (loader == NULL){
-				NR_Log(Log::LOG_ENGINE, "ResourceManager::loadResource(): Can not create a resource %s because there is no loader for %s resource type", name.c_str(), resourceType.c_str());
-				return IResourcePtr();
+		// get appropriate loader for the file or the resource type
+		ResourceLoader loader = findLoader(resourceType, fileName, manualLoader);
+		if (loader == NULL){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourceManager: No loader found for %s (%s) and no manual loader was specified, give up!", fileName.c_str(), resourceType.c_str());
+			return IResourcePtr();
+		}
+
+		// remember the resource for the next start
+		if (params == NULL && manualLoader == NULL) mPreloader->record(name, resourceType, fileName, group);
+
+		// preloaded resource has only to be finished, if it is still loaded in the background
+		SharedPtr<ResourceHolder> preloaded = getHolderByName(name);
+		if (preloaded != NULL && mPreloader->takePreloaded(name) && preloaded->mResource->getResFileName() == fileName){
+			ResourceHandle hdl = preloaded->mResource->getResHandle();
+			mLoadQueue->finish(hdl);
+			if (preloaded->mResource->isResLoaded() || reload(hdl) == OK){
+				return IResourcePtr(preloaded);
 			}
 		}
 
@@ -297,39 +444,21 @@ namespace nrEngine{
 		if (!pRes.isNull()){
 			NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceManager: Resource %s already loaded", name.c_str());
 			pRes->unloadRes();
-		}else{
-
-			// detect the file type by reading out it's last characters
-			for (uint32 i = fileName.length()-1; i >= 0; i--){
-				if (fileName[i] == '.'){
-					break;
-				}
-				type = fileName[i] + type;
-			}
-
-			if (type.length() == 0 && loader == NULL){
-				NR_Log(Log::LOG_ENGINE, "ResourceManager: Could not detect filetype of %s", fileName.c_str());
-				return IResourcePtr();
-			}
-		}
-		
-		// get appropriate loader for that filetype
-		if (!isManualSpecified){
-			loader = getLoaderByFile(type);
-		}
-		if (loader == NULL){
-			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourceManager: Loader for *.%s was not found or no manual loader was specified, give up!", type.c_str());
-			return IResourcePtr();
 		}
 
+		// create new handle
+		ResourceHandle handle = createHandle(name);
+		if (handle == 0) return IResourcePtr();
+
 		// load resource through implicit loading function
 		res = loadResourceImpl(handle, name, group, resourceType, fileName, params, loader);
 
 		// create an instance
 		if (res == NULL){
-			res = loader->createResourceInstance(resourceType, params);
+			res = loader->createResourceInstance(resourceType, fileName, params);
 			if (res == NULL){
 				NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourceManager: Resource instance could not be created. Abort.");
+				releaseHandle(handle);
 				return IResourcePtr();
 			}
 		}
@@ -338,8 +467,6 @@ namespace nrEngine{
 		SharedPtr<IResource> empty;
 		checkEmptyResource(resourceType, empty, loader);
 
-		// create new handle
-		handle = mLastHandle++;
 		NR_Log(Log::LOG_ENGINE, "ResourceManager: Load resource %s (%s) from %s", name.c_str(), group.c_str(), fileName.c_str());
 
 		// load the resource
@@ -349,11 +476,18 @@ namespace nrEngine{
 		res->mResName = name;
 		res->mResHandle = handle;
 		res->mParentManager = this;
-		Result ret = loader->loadResource(res);
+		uint64 start = ResourceStatistics::getMicroseconds();
+		Result ret = mCache->load(loader, res);
+		if (ret == OK) ret = loader->finalizeResource(res);
+		uint64 loadTime = ResourceStatistics::getMicroseconds() - start;
 		if (ret != OK){
 			NR_Log(Log::LOG_ENGINE, "ResourceManager: Could not load resource");
+			releaseHandle(handle);
+			delete res;
 			return IResourcePtr();
 		}
+		res->mResIsLoaded = true;
+		res->mResLevel = 0;
 
 		// create a holder for that resource
 		SharedPtr<ResourceHolder> holder(new ResourceHolder());
@@ -361,22 +495,326 @@ namespace nrEngine{
 		holder->setEmptyResource(empty);
 
 		// store the resource in database
-		mResourceGroup[group].push_back(handle);
-		mResource[handle] = holder;
-		mResourceName[name] = handle;
+		insertResource(handle, name, group, holder);
+		addLoadTime(handle, loadTime);
 
-		// check for memory usage
-		mMemUsage += holder->getResource()->getResDataSize();
+		// check for memory usage, the new resource should not be unloaded
+		holder->lockPure();
 		ret = checkMemoryUsage();
+		holder->unlockPure();
 		if (ret != OK){
 			NR_Log(Log::LOG_ENGINE, "ResourceManager: Could not rearrange memory");
 			return IResourcePtr();
 		}
 
+		// load the resources needed by this one
+		resolveDependencies(handle, false);
+
+		// the coarsest level is loaded, finer ones are streamed in the background
+		streamLevels(handle, res->getResPriority());
+
 		// return a pointer to that resource
 		return IResourcePtr(holder);
 	}
 
+	//----------------------------------------------------------------------------------
+	ResourceLoader ResourceManager::findLoader(const ::std::string& resourceType, const ::std::string& fileName, ResourceLoader manualLoader){
+
+		// manual loader overloads all registered loaders
+		if (manualLoader != NULL) return manualLoader;
+
+		ReadLock lock(mLoaderMutex);
+
+		// detect the file type by the characters after the last dot
+		::std::string::size_type pos = fileName.rfind('.');
+		if (pos != ::std::string::npos && pos + 1 < fileName.length()){
+			loader_type_map::const_iterator it = mLoaderByFileType.find(fileName.substr(pos + 1));
+			if (it != mLoaderByFileType.end()) return it->second;
+		}
+
+		// use the loader of the resource type
+		loader_type_map::const_iterator it = mLoaderByResType.find(resourceType);
+		if (it != mLoaderByResType.end()) return it->second;
+
+		return ResourceLoader();
+	}
+
+	//----------------------------------------------------------------------------------
+	IResourcePtr ResourceManager::loadResourceAsync(
+								const ::std::string& name,
+								const ::std::string& group,
+								const ::std::string& resourceType,
+								const ::std::string& fileName,
+								NameValuePairs* params,
+								ResourceLoader manualLoader,
+								Priority priority){
+
+		// check whenever right parameters are specified
+		NR_ASSERT(name.length() > 0  && fileName.length() > 0 && resourceType.length() > 0);
+
+		// remember the resource for the next start
+		if (params == NULL && manualLoader == NULL) mPreloader->record(name, resourceType, fileName, group);
+
+		// check whenever such a resource already exists
+		IResourcePtr pRes = getByName(name);
+		if (!pRes.isNull()){
+			if (!mPreloader->takePreloaded(name))
+				NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceManager: Resource %s already exists", name.c_str());
+			return pRes;
+		}
+
+		SharedPtr<ResourceHolder> holder = createAsyncResource(name, group, resourceType, fileName, params, manualLoader);
+		if (holder == NULL) return IResourcePtr();
+
+		// let the loader threads do the work
+		IResource* res = holder->mResource.get();
+		NR_Log(Log::LOG_ENGINE, "ResourceManager: Queue resource %s (%s) from %s", name.c_str(), group.c_str(), fileName.c_str());
+		mLoadQueue->push(res, res->mResLoader, priority);
+
+		return IResourcePtr(holder);
+	}
+
+	//----------------------------------------------------------------------------------
+	SharedPtr<ResourceHolder> ResourceManager::createAsyncResource(
+								const ::std::string& name,
+								const ::std::string& group,
+								const ::std::string& resourceType,
+								const ::std::string& fileName,
+								NameValuePairs* params,
+								ResourceLoader manualLoader){
+
+		// check whenever such a resource already exists
+		SharedPtr<ResourceHolder> existing = getHolderByName(name);
+		if (existing != NULL) return existing;
+
+		// get appropriate loader
+		ResourceLoader loader = findLoader(resourceType, fileName, manualLoader);
+		if (loader == NULL){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourceManager: No loader found for %s (%s), give up!", fileName.c_str(), resourceType.c_str());
+			return SharedPtr<ResourceHolder>();
+		}
+
+		// create new handle
+		ResourceHandle handle = createHandle(name);
+		if (handle == 0) return SharedPtr<ResourceHolder>();
+
+		// create an instance
+		IResource* res = createEmptyImpl(handle, name, group, resourceType, params);
+		if (res == NULL){
+			res = loader->createResourceInstance(resourceType, fileName, params);
+			if (res == NULL){
+				NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourceManager: Resource instance could not be created. Abort.");
+				releaseHandle(handle);
+				return SharedPtr<ResourceHolder>();
+			}
+		}
+
+		// check now if a empty resource of that type already exists and load it if not
+		SharedPtr<IResource> empty;
+		checkEmptyResource(resourceType, empty, loader);
+
+		res->mResLoader = loader;
+		res->mResFileName = fileName;
+		res->mResGroup = group;
+		res->mResName = name;
+		res->mResHandle = handle;
+		res->mParentManager = this;
+
+		// create a holder, it gives the empty resource until the resource is loaded
+		SharedPtr<ResourceHolder> holder(new ResourceHolder());
+		holder->resetRes(res);
+		holder->setEmptyResource(empty);
+
+		// store the resource in database
+		insertResource(handle, name, group, holder);
+
+		return holder;
+	}
+
+	//----------------------------------------------------------------------------------
+	uint32 ResourceManager::collectIdle(uint32& cursor, uint32 count, uint32 frame, uint32 idleFrames){
+
+		// number of slots used by the shards
+		uint32 slotCount = 0;
+		for (uint32 k=0; k < NR_RESOURCE_SHARDS; k++){
+			ReadLock lock(mShard[k].lock);
+			slotCount = ::std::max(slotCount, mShard[k].slotCount * NR_RESOURCE_SHARDS);
+		}
+		if (slotCount == 0) return 0;
+
+		// find the resources which were not accessed for long time
+		::std::vector<ResourceHandle> idle;
+		for (uint32 n=0; n < count && n < slotCount; n++){
+			uint32 slot = cursor++ % slotCount;
+			if (cursor >= slotCount) cursor = 0;
+
+			uint32 k = slot & (NR_RESOURCE_SHARDS - 1);
+			ReadLock lock(mShard[k].lock);
+			if (slot / NR_RESOURCE_SHARDS >= mShard[k].slotCount) continue;
+
+			ResourceSlot& s = getSlot(slot);
+			ResourceHolder* holder = s.holder.get();
+			if (holder == NULL) continue;
+
+			// only the collector does write the seen values, so the read lock is enough
+			// the idle time does start as soon as the resource is loaded
+			IResource* res = holder->mResource.get();
+			uint64 access = holder->getAccessCount();
+			if (access != s.seenAccess || !res->isResLoaded() || res->isResEmpty() || holder->isInUse(getFrame())){
+				s.seenAccess = access;
+				s.seenFrame = frame;
+				continue;
+			}
+
+			if (frame - s.seenFrame >= idleFrames) idle.push_back(makeHandle(slot));
+		}
+
+		uint32 collected = 0;
+		for (uint32 i=0; i < idle.size(); i++){
+			SharedPtr<ResourceHolder> holder = getHolderByHandle(idle[i]);
+			if (holder == NULL || holder->isInUse(getFrame()) || mLoadQueue->isPending(idle[i])) continue;
+
+			// loaded resources could still need this one
+			if (isNeeded(idle[i])) continue;
+
+			NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "ResourceManager: Resource %s was not used for %d frames, unload it", holder->mResource->getResName().c_str(), idleFrames);
+			if (unload(idle[i]) == OK) collected++;
+		}
+
+		return collected;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceManager::isNeeded(ResourceHandle handle){
+
+		::std::vector<ResourceHandle> dependents;
+		getDependents(handle, dependents);
+		for (uint32 i=0; i < dependents.size(); i++){
+			SharedPtr<ResourceHolder> dep = getHolderByHandle(dependents[i]);
+			if (dep != NULL && dep->mResource->isResLoaded()) return true;
+		}
+		return false;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceManager::isPayloadLoaded(ResourceHandle handle){
+
+		SharedPtr<ResourceHolder> holder = getHolderByHandle(handle);
+		if (holder == NULL) return false;
+
+		// resources with levels are streamed, so their payload does change
+		SharedPtr<IResource> res = holder->mResource;
+		return res != NULL && res->isResLoaded() && !res->isResEmpty() && res->getResLevelCount() == 1;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceManager::sharePayload(ResourceHandle source, IResource* res){
+
+		SharedPtr<ResourceHolder> holder = getHolderByHandle(source);
+		if (holder == NULL || !isPayloadLoaded(source)) return false;
+
+		// the source is not deleted while its payload is taken
+		SharedPtr<IResource> src = holder->mResource;
+		if (src->getResType() != res->getResType() || !res->shareResPayload(src.get())) return false;
+
+		// the content is the same, so the same resources are needed
+		res->mResDependency = src->mResDependency;
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceManager::preload(const ResourceDependency& resource, Priority priority){
+
+		if (getHolderByName(resource.name) != NULL) return false;
+
+		SharedPtr<ResourceHolder> holder = createAsyncResource(resource.name, resource.group,
+									resource.resourceType, resource.fileName, NULL, ResourceLoader());
+		if (holder == NULL) return false;
+
+		IResource* res = holder->mResource.get();
+		mLoadQueue->push(res, res->mResLoader, priority);
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::finishAsyncLoad(ResourceHandle handle, Result result, uint64 loadTime){
+
+		// resource could be removed in the meantime
+		SharedPtr<ResourceHolder> holder = getHolderByHandle(handle);
+		if (holder == NULL) return;
+
+		IResource* res = holder->mResource.get();
+		if (result == OK){
+			NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "ResourceManager: Resource %s loaded in the background", res->getResName().c_str());
+
+			// from now on the holder gives the real resource
+			res->mResIsLoaded = true;
+			res->mResLevel = 0;
+
+			// check for memory usage, the new resource should not be unloaded
+			updateUsage(handle, res);
+			addLoadTime(handle, loadTime);
+			holder->lockPure();
+			checkMemoryUsage();
+			holder->unlockPure();
+
+			// the coarsest level is usable, finer ones are streamed
+			streamLevels(handle, res->getResPriority());
+
+			// load the needed resources in parallel, the resource is complete if they are loaded
+			uint32 waiting = resolveDependencies(handle, true);
+			if (waiting > 0){
+				::boost::mutex::scoped_lock lock(mDependencyMutex);
+				DependencyNode& node = mDependency[handle];
+				node.waiting = waiting;
+				node.result = OK;
+				return;
+			}
+		}else{
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourceManager: Could not load resource %s in the background", res->getResName().c_str());
+		}
+
+		completeAsyncLoad(handle, result);
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::completeAsyncLoad(ResourceHandle handle, Result result){
+
+		// notify the application
+		SharedPtr<ResourceHolder> holder = getHolderByHandle(handle);
+		if (holder != NULL && EventManager::isValid()){
+			SharedPtr<Event> msg(new ResourceLoadedEvent(holder->mResource->getResName(), handle, result));
+			EventManager::GetSingleton().emit(NR_RESOURCE_EVENT_CHANNEL, msg);
+		}
+
+		// group operations could go on
+		finishGroupRequest(handle, result);
+
+		// dependents reloaded after this one could be queued now
+		continueReload(handle);
+
+		// resources waiting for this one could be complete now
+		::std::vector< ::std::pair<ResourceHandle, Result> > complete;
+		{
+			::boost::mutex::scoped_lock lock(mDependencyMutex);
+			res_dep_map::iterator it = mDependency.find(handle);
+			if (it == mDependency.end()) return;
+
+			for (uint32 i=0; i < it->second.dependents.size(); i++){
+				DependencyNode& node = mDependency[it->second.dependents[i]];
+				if (node.waiting == 0) continue;
+				if (result != OK) node.result = result;
+				if (--node.waiting == 0){
+					complete.push_back(::std::make_pair(it->second.dependents[i], node.result));
+				}
+			}
+		}
+
+		for (uint32 i=0; i < complete.size(); i++){
+			completeAsyncLoad(complete[i].first, complete[i].second);
+		}
+	}
+
 	//----------------------------------------------------------------------------------
 	Result ResourceManager::checkEmptyResource(const ::std::string resourceType,
 													SharedPtr<IResource>& empty,
@@ -384,6 +822,7 @@ namespace nrEngine{
 	{
 
 		// check now if a empty resource of that type already exists and load it if not
+		::boost::mutex::scoped_lock lock(mEmptyMutex);
 		res_empty_map::iterator it = mEmptyResource.find(resourceType);
 		if (it == mEmptyResource.end()){
 			NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG,
@@ -411,19 +850,8 @@ namespace nrEngine{
 	//----------------------------------------------------------------------------------
 	Result ResourceManager::unload(const ::std::string& name){
 
-		ResourcePtr<IResource> res = getByName(name);
-
-		if (res.isNull()){
-			return RES_NOT_FOUND;
-		}
-
-		lockPure(res);
-			NR_Log(Log::LOG_ENGINE, "ResourceManager: Unload resource %s",
-				res->getResName().c_str(), res->getResHandle());
-			Result ret = res->unloadRes();
-		unlockPure(res);
-
-		return ret;
+		IResourcePtr res = getByName(name);
+		return unload(res);
 	}
 
 	//----------------------------------------------------------------------------------
@@ -434,10 +862,27 @@ namespace nrEngine{
 		}
 
 		lockPure(res);
+			ResourceHandle hdl = res->getResHandle();
+			bool cancelled = mLoadQueue->cancel(hdl);
 			NR_Log(Log::LOG_ENGINE, "ResourceManager: Unload resource %s",
 				res->getResName().c_str(), res->getResHandle());
 			Result ret = res->unloadRes();
 		unlockPure(res);
+		updateUsage(hdl);
+
+		// resources waiting for this one will not get it
+		{
+			::boost::mutex::scoped_lock lock(mDependencyMutex);
+			res_dep_map::iterator it = mDependency.find(hdl);
+			if (it != mDependency.end() && it->second.waiting > 0){
+				it->second.waiting = 0;
+				cancelled = true;
+			}
+		}
+		if (cancelled) completeAsyncLoad(hdl, RES_NOT_FOUND);
+
+		// resources needed only by this one are not needed anymore
+		if (ret == OK) releaseDependencies(hdl, false);
 
 		return ret;
 	}
@@ -445,71 +890,354 @@ namespace nrEngine{
 	//----------------------------------------------------------------------------------
 	Result ResourceManager::unload(ResourceHandle& handle){
 
-		ResourcePtr<IResource> res = getByHandle(handle);
-
-		if (res.isNull()){
-			return RES_NOT_FOUND;
-		}
-
-		lockPure(res);
-			NR_Log(Log::LOG_ENGINE, "ResourceManager: Unload resource %s",
-				res->getResName().c_str(), res->getResHandle());
-			Result ret = res->unloadRes();
-		unlockPure(res);
-
-		return ret;
+		IResourcePtr res = getByHandle(handle);
+		return unload(res);
 	}
 
 	//----------------------------------------------------------------------------------
 	Result ResourceManager::reload(const ::std::string& name){
 
-		ResourcePtr<IResource> res = getByName(name);
-
-		if (res.isNull()){
-			return RES_NOT_FOUND;
-		}
-
-		lockPure(res);
-			NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "ResourceManager: Reload resource %s",
-				res->getResName().c_str(), res->getResHandle());
-			Result ret = res->reloadRes();
-		unlockPure(res);
-
-		return ret;
+		IResourcePtr res = getByName(name);
+		return reload(res);
 	}
 
 	//----------------------------------------------------------------------------------
 	Result ResourceManager::reload(ResourceHandle& handle){
 
-		ResourcePtr<IResource> res = getByHandle(handle);
+		IResourcePtr res = getByHandle(handle);
+		return reload(res);
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceManager::reload(IResourcePtr& res){
 
 		if (res.isNull()){
 			return RES_NOT_FOUND;
 		}
 
 		lockPure(res);
+			ResourceHandle hdl = res->getResHandle();
+			mLoadQueue->cancel(hdl);
 			NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "ResourceManager: Reload resource %s",
 				res->getResName().c_str(), res->getResHandle());
+			uint64 start = ResourceStatistics::getMicroseconds();
 			Result ret = res->reloadRes();
+			if (ret == OK) addLoadTime(hdl, ResourceStatistics::getMicroseconds() - start);
 		unlockPure(res);
+		updateUsage(hdl);
+
+		// the resource could need other resources now
+		if (ret == OK){
+			resolveDependencies(hdl, false);
+			streamLevels(hdl, res->getResPriority());
+		}
 
 		return ret;
 	}
 
 	//----------------------------------------------------------------------------------
-	Result ResourceManager::reload(IResourcePtr& res){
+	Result ResourceManager::reloadAsync(ResourceHandle handle, Priority priority){
 
-		if (res.isNull()){
+		SharedPtr<ResourceHolder> holder = getHolderByHandle(handle);
+		if (holder == NULL){
 			return RES_NOT_FOUND;
 		}
 
-		lockPure(res);
-			NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "ResourceManager: Reload resource %s",
-				res->getResName().c_str(), res->getResHandle());
-			Result ret = res->reloadRes();
-		unlockPure(res);
+		IResource* res = holder->mResource.get();
+		if (res->mResLoader == NULL){
+			return RES_LOADER_NOT_EXISTS;
+		}
 
-		return ret;
+		// the empty resource is used until the loader threads are ready
+		holder->lockPure();
+			mLoadQueue->cancel(handle);
+			NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "ResourceManager: Reload resource %s in the background", res->getResName().c_str());
+			Result ret = res->unloadRes();
+		holder->unlockPure();
+		updateUsage(handle, res);
+		if (ret != OK) return ret;
+
+		mLoadQueue->push(res, res->mResLoader, priority);
+
+		return OK;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::reloadDependentsAsync(const ::std::vector<ResourceHandle>& handles, Priority priority){
+
+		// collect the changed resources and all resources depending on them
+		::std::vector<ResourceHandle> reload;
+		::std::set<ResourceHandle> done;
+		for (uint32 i=0; i < handles.size(); i++){
+			if (done.insert(handles[i]).second) reload.push_back(handles[i]);
+		}
+		for (uint32 i=0; i < reload.size(); i++){
+			::std::vector<ResourceHandle> dependents;
+			getDependents(reload[i], dependents);
+			for (uint32 j=0; j < dependents.size(); j++){
+				if (done.insert(dependents[j]).second) reload.push_back(dependents[j]);
+			}
+		}
+
+		// a resource has to wait for its dependencies which are reloaded too
+		::std::vector<ResourceHandle> ready;
+		{
+			::boost::mutex::scoped_lock lock(mDependencyMutex);
+			for (uint32 i=0; i < reload.size(); i++){
+				uint32 waiting = 0;
+				res_dep_map::iterator it = mDependency.find(reload[i]);
+				if (it != mDependency.end()){
+					for (uint32 j=0; j < it->second.dependsOn.size(); j++){
+						if (done.find(it->second.dependsOn[j]) != done.end()) waiting++;
+					}
+					it->second.reloadWaiting = waiting;
+					it->second.reloadPriority = priority;
+				}
+				if (waiting == 0) ready.push_back(reload[i]);
+			}
+		}
+
+		// the others are queued by continueReload() as soon as their dependencies are loaded
+		for (uint32 i=0; i < ready.size(); i++){
+			if (reloadAsync(ready[i], priority) != OK) continueReload(ready[i]);
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::continueReload(ResourceHandle handle){
+
+		::std::vector< ::std::pair<ResourceHandle, Priority> > ready;
+		{
+			::boost::mutex::scoped_lock lock(mDependencyMutex);
+			res_dep_map::iterator it = mDependency.find(handle);
+			if (it == mDependency.end()) return;
+
+			for (uint32 i=0; i < it->second.dependents.size(); i++){
+				res_dep_map::iterator jt = mDependency.find(it->second.dependents[i]);
+				if (jt == mDependency.end() || jt->second.reloadWaiting == 0) continue;
+				if (--jt->second.reloadWaiting == 0){
+					ready.push_back(::std::make_pair(jt->first, jt->second.reloadPriority));
+				}
+			}
+		}
+
+		// a resource which could not be reloaded does not hold back the others
+		for (uint32 i=0; i < ready.size(); i++){
+			if (reloadAsync(ready[i].first, ready[i].second) != OK) continueReload(ready[i].first);
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceManager::streamLevels(ResourceHandle handle, Priority priority){
+
+		SharedPtr<ResourceHolder> holder = getHolderByHandle(handle);
+		if (holder == NULL){
+			return RES_NOT_FOUND;
+		}
+
+		IResource* res = holder->mResource.get();
+		if (!res->isResLoaded()){
+			return RES_IS_EMPTY;
+		}
+
+		// levels are loaded one after another, the next one is queued by finishLevelLoad()
+		if (res->isResComplete() || res->mResLoader == NULL || mLoadQueue->isPending(handle, true)){
+			return OK;
+		}
+
+		mLoadQueue->push(res, res->mResLoader, priority, int32(res->getResLevel() + 1));
+
+		return OK;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::finishLevelLoad(ResourceHandle handle, uint32 level, Result result){
+
+		// resource could be removed in the meantime
+		SharedPtr<ResourceHolder> holder = getHolderByHandle(handle);
+		if (holder == NULL) return;
+
+		// resource could be unloaded or its levels dropped in the meantime
+		IResource* res = holder->mResource.get();
+		if (!res->isResLoaded() || res->getResLevel() + 1 != level) return;
+
+		if (result != OK){
+			NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceManager: Could not load level %d of resource %s", level, res->getResName().c_str());
+			return;
+		}
+
+		NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "ResourceManager: Level %d of resource %s loaded in the background", level, res->getResName().c_str());
+		res->mResLevel = level;
+
+		// check for memory usage, the new level should not be dropped
+		updateUsage(handle, res);
+		holder->lockPure();
+		checkMemoryUsage();
+		holder->unlockPure();
+
+		// stop streaming if the budget is exceeded, other resources would loose their levels
+		if (mMemBudget > 0 && getMemoryUsage() > mMemBudget) return;
+
+		streamLevels(handle, res->getResPriority());
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceManager::addDependency(ResourceHandle resource, ResourceHandle dependency){
+
+		if (getHolderByHandle(resource) == NULL || getHolderByHandle(dependency) == NULL){
+			return RES_NOT_FOUND;
+		}
+
+		::boost::mutex::scoped_lock lock(mDependencyMutex);
+
+		// the graph has to stay acyclic
+		if (resource == dependency || isDependent(dependency, resource)){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourceManager: Dependency %d of %d would give a cycle", dependency, resource);
+			return BAD_PARAMETERS;
+		}
+
+		// each dependency is counted only once
+		::std::vector<ResourceHandle>& deps = mDependency[resource].dependsOn;
+		if (::std::find(deps.begin(), deps.end(), dependency) != deps.end()) return OK;
+
+		deps.push_back(dependency);
+		mDependency[dependency].dependents.push_back(resource);
+
+		return OK;
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourceManager::isDependent(ResourceHandle a, ResourceHandle b){
+
+		// shared dependencies are visited only once, so the walk is linear in the graph size
+		::std::vector<ResourceHandle> stack(1, a);
+		::std::set<ResourceHandle> visited;
+		while (stack.size() > 0){
+			ResourceHandle handle = stack.back();
+			stack.pop_back();
+			if (!visited.insert(handle).second) continue;
+
+			res_dep_map::const_iterator it = mDependency.find(handle);
+			if (it == mDependency.end()) continue;
+
+			for (uint32 i=0; i < it->second.dependsOn.size(); i++){
+				if (it->second.dependsOn[i] == b) return true;
+				stack.push_back(it->second.dependsOn[i]);
+			}
+		}
+		return false;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::getDependencies(ResourceHandle handle, ::std::vector<ResourceHandle>& dependencies){
+
+		::boost::mutex::scoped_lock lock(mDependencyMutex);
+		res_dep_map::const_iterator it = mDependency.find(handle);
+		if (it == mDependency.end()) return;
+
+		dependencies.insert(dependencies.end(), it->second.dependsOn.begin(), it->second.dependsOn.end());
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::getDependents(ResourceHandle handle, ::std::vector<ResourceHandle>& dependents){
+
+		::boost::mutex::scoped_lock lock(mDependencyMutex);
+		res_dep_map::const_iterator it = mDependency.find(handle);
+		if (it == mDependency.end()) return;
+
+		dependents.insert(dependents.end(), it->second.dependents.begin(), it->second.dependents.end());
+	}
+
+	//----------------------------------------------------------------------------------
+	uint32 ResourceManager::resolveDependencies(ResourceHandle handle, bool async){
+
+		SharedPtr<ResourceHolder> holder = getHolderByHandle(handle);
+		if (holder == NULL) return 0;
+
+		// copy the list, because resolving could load other resources
+		::std::vector<ResourceDependency> deps = holder->mResource->getResDependencies();
+		uint32 waiting = 0;
+
+		for (uint32 i=0; i < deps.size(); i++){
+			const ResourceDependency& dep = deps[i];
+
+			// share the resource if it already exists, otherwise load it
+			bool automatic = false;
+			SharedPtr<ResourceHolder> depHolder = getHolderByName(dep.name);
+			if (depHolder == NULL){
+				NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "ResourceManager: Load %s needed by %s", dep.name.c_str(), holder->mResource->getResName().c_str());
+				if (async){
+					loadResourceAsync(dep.name, dep.group, dep.resourceType, dep.fileName);
+				}else{
+					loadResource(dep.name, dep.group, dep.resourceType, dep.fileName);
+				}
+				depHolder = getHolderByName(dep.name);
+				automatic = true;
+			}
+			if (depHolder == NULL){
+				NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourceManager: Resource %s needed by %s could not be loaded", dep.name.c_str(), holder->mResource->getResName().c_str());
+				continue;
+			}
+
+			ResourceHandle depHandle = depHolder->mResource->getResHandle();
+			if (addDependency(handle, depHandle) != OK) continue;
+
+			// shared resource could be unloaded in the meantime
+			IResource* depRes = depHolder->mResource.get();
+			if (!depRes->isResLoaded() && !mLoadQueue->isPending(depHandle)){
+				if (async) reloadAsync(depHandle); else reload(depHandle);
+			}
+
+			::boost::mutex::scoped_lock lock(mDependencyMutex);
+			DependencyNode& node = mDependency[depHandle];
+			if (automatic) node.automatic = true;
+
+			// count the dependencies which are still loaded in the background
+			if (async && (mLoadQueue->isPending(depHandle) || node.waiting > 0)) waiting++;
+		}
+
+		return waiting;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::releaseDependencies(ResourceHandle handle, bool remove){
+
+		// find the dependencies which are not needed anymore
+		::std::vector<ResourceHandle> unused;
+		{
+			::boost::mutex::scoped_lock lock(mDependencyMutex);
+			res_dep_map::iterator it = mDependency.find(handle);
+			if (it == mDependency.end()) return;
+
+			for (uint32 i=0; i < it->second.dependsOn.size(); i++){
+				ResourceHandle dep = it->second.dependsOn[i];
+				DependencyNode& node = mDependency[dep];
+				if (remove){
+					node.dependents.erase(::std::remove(node.dependents.begin(), node.dependents.end(), handle), node.dependents.end());
+				}
+				if (!node.automatic) continue;
+
+				// unloaded dependents does not need the resource to be loaded
+				bool needed = false;
+				for (uint32 j=0; j < node.dependents.size() && !needed; j++){
+					SharedPtr<ResourceHolder> holder = getHolderByHandle(node.dependents[j]);
+					needed = remove || (holder != NULL && holder->mResource->isResLoaded());
+				}
+				if (!needed) unused.push_back(dep);
+			}
+
+			// the links are kept until the resource is removed, so reloading does find them again
+			if (remove) it->second.dependsOn.clear();
+		}
+
+		// release them, this does cascade through the graph
+		for (uint32 i=0; i < unused.size(); i++){
+			if (remove){
+				this->remove(unused[i]);
+			}else{
+				unload(unused[i]);
+			}
+		}
 	}
 
 	//----------------------------------------------------------------------------------
@@ -530,19 +1258,26 @@ namespace nrEngine{
 				return RES_NOT_FOUND;
 			}
 
-			// first unload it
+			// release the resources needed by this one, then unload it
+			releaseDependencies(hdl, true);
 			unload(resPtr);
 
 			NR_Log(Log::LOG_ENGINE, "ResourceManager: Remove resource %s (%s)", name.c_str(), grp.c_str());
 
-			// remove the handle from the group list
-			if (grp.length() > 0){
+			// remove the handle from the group list, the slot does know its neighbours
+			{
+				::boost::mutex::scoped_lock lock(mGroupMutex);
 				res_grp_map::iterator jt = mResourceGroup.find(grp);
 				if (jt != mResourceGroup.end()){
-					jt->second.remove(hdl);
+					ResourceSlot& s = getSlot(hdl & NR_RESOURCE_SLOT_MASK);
+					if (s.groupPrev == NR_RESOURCE_NO_SLOT) jt->second.first = s.groupNext;
+					else getSlot(s.groupPrev).groupNext = s.groupNext;
+					if (s.groupNext == NR_RESOURCE_NO_SLOT) jt->second.last = s.groupPrev;
+					else getSlot(s.groupNext).groupPrev = s.groupPrev;
+					jt->second.count--;
 
 					// check whenever group contains nomore elements, and delete it
-					if (jt->second.size() == 0){
+					if (jt->second.count == 0){
 						mResourceGroup.erase(grp);
 						NR_Log(Log::LOG_ENGINE, "ResourceManager: %s's group \"%s\" does not contain elements, so remove it", name.c_str(), grp.c_str());
 					}else{
@@ -556,9 +1291,21 @@ namespace nrEngine{
 		// unlock it back
 		unlockPure(resPtr);
 
+		// remove the resource from the dependency graph
+		{
+			::boost::mutex::scoped_lock lock(mDependencyMutex);
+			res_dep_map::iterator it = mDependency.find(hdl);
+			if (it != mDependency.end()){
+				for (uint32 i=0; i < it->second.dependents.size(); i++){
+					::std::vector<ResourceHandle>& deps = mDependency[it->second.dependents[i]].dependsOn;
+					deps.erase(::std::remove(deps.begin(), deps.end(), hdl), deps.end());
+				}
+				mDependency.erase(it);
+			}
+		}
+
 		// clear the database
-		mResourceName.erase(name);
-		mResource.erase(hdl);
+		releaseHandle(hdl, name);
 
 		return OK;
 	}
@@ -602,53 +1349,336 @@ namespace nrEngine{
 	}
 
 	//----------------------------------------------------------------------------------
-	SharedPtr<ResourceHolder>* ResourceManager::getHolderByName(const ::std::string& name)
+	uint32 ResourceManager::getShard(const ::std::string& name) const
 	{
+		return ::boost::hash< ::std::string>()(name) & (NR_RESOURCE_SHARDS - 1);
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceManager::ResourceSlot& ResourceManager::getSlot(uint32 slot)
+	{
+		return mSlotPage[slot >> NR_RESOURCE_PAGE_BITS][slot & (NR_RESOURCE_PAGE_SIZE - 1)];
+	}
+
+	//----------------------------------------------------------------------------------
+	const ResourceManager::ResourceSlot& ResourceManager::getSlot(uint32 slot) const
+	{
+		return mSlotPage[slot >> NR_RESOURCE_PAGE_BITS][slot & (NR_RESOURCE_PAGE_SIZE - 1)];
+	}
+
+	//----------------------------------------------------------------------------------
+	SharedPtr<ResourceHolder> ResourceManager::getHolderByName(const ::std::string& name)
+	{
+		ResourceShard& shard = mShard[getShard(name)];
+		ReadLock lock(shard.lock);
+
 		// find the handle
-		res_str_map::iterator it = mResourceName.find(name);
-		if (it == mResourceName.end()){
-			return NULL;
+		res_str_map::const_iterator it = shard.names.find(name);
+		if (it == shard.names.end()){
+			return SharedPtr<ResourceHolder>();
+		}
+
+		// the slot of the handle is in the same shard
+		const ResourceSlot& s = getSlot(it->second & NR_RESOURCE_SLOT_MASK);
+		NR_ASSERT(s.holder != NULL && "Fatal Error in the Database !!!");
+		return s.holder;
+	}
+
+	//----------------------------------------------------------------------------------
+	SharedPtr<ResourceHolder> ResourceManager::getHolderByHandle(const ResourceHandle& handle)
+	{
+		uint32 slot = handle & NR_RESOURCE_SLOT_MASK;
+		ResourceShard& shard = mShard[slot & (NR_RESOURCE_SHARDS - 1)];
+		ReadLock lock(shard.lock);
+
+		// the slot does only match if the generation of the handle is the current one
+		if (slot / NR_RESOURCE_SHARDS >= shard.slotCount || makeHandle(slot) != handle){
+			return SharedPtr<ResourceHolder>();
 		}
+		return getSlot(slot).holder;
+	}
 
-		// get through the handle the holder
-		res_hdl_map::iterator jt = mResource.find(it->second);
-		NR_ASSERT(jt != mResource.end() && "Fatal Error in the Database !!!");
-		return &(jt->second);
+	//----------------------------------------------------------------------------------
+	ResourceHandle ResourceManager::makeHandle(uint32 slot) const
+	{
+		return slot | ((getSlot(slot).generation << NR_RESOURCE_SLOT_BITS) & ~NR_RESOURCE_SLOT_MASK);
 	}
 
 	//----------------------------------------------------------------------------------
-	SharedPtr<ResourceHolder>* ResourceManager::getHolderByHandle(const ResourceHandle& handle)
+	ResourceHandle ResourceManager::createHandle(const ::std::string& name)
 	{
-		// find through the handle
-		res_hdl_map::iterator it = mResource.find(handle);
-		if (it == mResource.end()){
-			return NULL;
+		uint32 k = getShard(name);
+		ResourceShard& shard = mShard[k];
+		WriteLock lock(shard.lock);
+
+		// reuse a free slot of the shard or append a new one
+		uint32 slot = shard.freeSlot;
+		if (slot != NR_RESOURCE_NO_SLOT){
+			shard.freeSlot = getSlot(slot).nextFree;
+		}else{
+			slot = shard.slotCount * NR_RESOURCE_SHARDS + k;
+			if (slot > NR_RESOURCE_SLOT_MASK){
+				NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourceManager: There is no free slot for resource %s, the database is full", name.c_str());
+				return 0;
+			}
+
+			// allocate the page if it is the first slot in it
+			uint32 page = slot >> NR_RESOURCE_PAGE_BITS;
+			{
+				::boost::mutex::scoped_lock pageLock(mPageMutex);
+				if (mSlotPage[page] == NULL) mSlotPage[page] = new ResourceSlot[NR_RESOURCE_PAGE_SIZE];
+			}
+			getSlot(slot).generation = 1;
+			getSlot(slot).watched = false;
+			shard.slotCount++;
 		}
-		return &(it->second);
+		getSlot(slot).nextFree = NR_RESOURCE_NO_SLOT;
+
+		return makeHandle(slot);
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::releaseHandle(ResourceHandle handle, const ::std::string& name)
+	{
+		uint32 slot = handle & NR_RESOURCE_SLOT_MASK;
+		uint32 k = slot & (NR_RESOURCE_SHARDS - 1);
+		ResourceShard& shard = mShard[k];
+		SharedPtr<ResourceHolder> holder;
+		{
+			WriteLock lock(shard.lock);
+			if (slot == 0 || slot / NR_RESOURCE_SHARDS >= shard.slotCount || makeHandle(slot) != handle) return;
+
+			// remove the name, if it still belongs to this handle
+			if (name.length() > 0){
+				res_str_map::iterator it = shard.names.find(name);
+				if (it != shard.names.end() && it->second == handle) shard.names.erase(it);
+			}
+
+			// old handles of this slot get invalid. If the generation would wrap, so
+			// the slot is retired, otherwise an old handle could get valid again.
+			// Generation 0 is never given out, so retired slots does not match any handle.
+			ResourceSlot& s = getSlot(slot);
+			holder.swap(s.holder);
+			mStatistics->remove(s.statistics);
+			if (s.watched){
+				mFileWatcher->unwatch(s.watchEntry);
+				s.watched = false;
+			}
+			s.generation++;
+			if (((s.generation << NR_RESOURCE_SLOT_BITS) & ~NR_RESOURCE_SLOT_MASK) == 0){
+				NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "ResourceManager: Slot %d has used all generations, retire it", slot);
+				s.generation = 0;
+			}else{
+				s.nextFree = shard.freeSlot;
+				shard.freeSlot = slot;
+			}
+		}
+
+		// holder is released outside of the lock, the resource object is deleted by
+		// the main thread later, if the queue does hold the last reference to it
+		if (holder){
+			size_t size = holder->mResource ? holder->mResource->getResDataSize() : 0;
+			mReclaimQueue->pushData(holder, size, false);
+		}
+		holder.reset();
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::insertResource(ResourceHandle handle, const ::std::string& name, const ::std::string& group, SharedPtr<ResourceHolder> holder)
+	{
+		// handle was created by the shard of the name
+		uint32 slot = handle & NR_RESOURCE_SLOT_MASK;
+		ResourceShard& shard = mShard[slot & (NR_RESOURCE_SHARDS - 1)];
+		IResource* res = holder->mResource.get();
+		::std::string loaderName = getLoaderName(res->mResLoader);
+		{
+			WriteLock lock(shard.lock);
+			ResourceSlot& s = getSlot(slot);
+			s.holder = holder;
+			s.seenAccess = ~uint64(0);
+			s.seenFrame = 0;
+			shard.names[name] = handle;
+
+			// account the memory of the resource
+			mStatistics->insert(s.statistics, group, res->getResType(), loaderName);
+			mStatistics->update(s.statistics, res);
+
+			// resources loaded from files are reloaded when the files are changed
+			s.watched = mFileWatcher->watch(handle, res->getResFileName(), s.watchEntry);
+		}
+
+		// append the slot to the list of its group
+		::boost::mutex::scoped_lock lock(mGroupMutex);
+		res_grp_map::iterator it = mResourceGroup.find(group);
+		if (it == mResourceGroup.end()){
+			GroupList list;
+			list.first = list.last = NR_RESOURCE_NO_SLOT;
+			list.count = 0;
+			it = mResourceGroup.insert(res_grp_map::value_type(group, list)).first;
+		}
+
+		ResourceSlot& s = getSlot(slot);
+		s.groupPrev = it->second.last;
+		s.groupNext = NR_RESOURCE_NO_SLOT;
+		if (it->second.last == NR_RESOURCE_NO_SLOT) it->second.first = slot;
+		else getSlot(it->second.last).groupNext = slot;
+		it->second.last = slot;
+		it->second.count++;
 	}
 
 	//----------------------------------------------------------------------------------
 	IResourcePtr ResourceManager::getByName(const ::std::string& name){
-		SharedPtr<ResourceHolder>* holder = getHolderByName(name);
+		SharedPtr<ResourceHolder> holder = getHolderByName(name);
 		if (holder == NULL){
 			return IResourcePtr();
 		}
 
-		return IResourcePtr(*holder);
+		return IResourcePtr(holder);
 	}
 
 	//----------------------------------------------------------------------------------
 	IResourcePtr ResourceManager::getByHandle(const ResourceHandle& handle){
-		SharedPtr<ResourceHolder>* holder = getHolderByHandle(handle);
+		SharedPtr<ResourceHolder> holder = getHolderByHandle(handle);
 		if (holder == NULL){
 			return IResourcePtr();
 		}
-		return IResourcePtr(*holder);
+		return IResourcePtr(holder);
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::getEvictionCandidates(::std::vector<ResourceEvictionCandidate>& candidates, bool levelsOnly){
+
+		for (uint32 k=0; k < NR_RESOURCE_SHARDS; k++){
+			ReadLock lock(mShard[k].lock);
+			for (uint32 i=0; i < mShard[k].slotCount; i++){
+				uint32 slot = i * NR_RESOURCE_SHARDS + k;
+				ResourceHolder* holder = getSlot(slot).holder.get();
+				if (holder == NULL) continue;
+				IResource* res = holder->mResource.get();
+				if (res == NULL || !res->isResLoaded() || res->isResEmpty()) continue;
+				if (levelsOnly && (res->getResLevel() == 0 || holder->isInUse(getFrame()))) continue;
+
+				ResourceEvictionCandidate c;
+				c.handle = makeHandle(slot);
+				c.size = res->getResDataSize();
+				c.accessCount = holder->getAccessCount();
+				c.priority = res->getResPriority();
+				c.group = &res->getResGroup();
+				c.locked = holder->isInUse(getFrame());
+				candidates.push_back(c);
+			}
+		}
+
+		// resources needed by loaded ones are unloaded together with them, dropping
+		// their levels does not harm. The shards are not locked anymore here.
+		if (levelsOnly) return;
+		uint32 count = 0;
+		for (uint32 i=0; i < candidates.size(); i++){
+			if (!isNeeded(candidates[i].handle)) candidates[count++] = candidates[i];
+		}
+		candidates.resize(count);
+	}
+
+	//----------------------------------------------------------------------------------
+	size_t ResourceManager::dropLevels(size_t bytesToFree){
+
+		size_t freed = 0;
+		while (freed < bytesToFree){
+
+			// resources with resident levels, the policy gives the order
+			ResourceEvictionPolicy::CandidateList candidates;
+			getEvictionCandidates(candidates, true);
+			if (candidates.size() == 0) break;
+
+			::std::vector<ResourceHandle> victims;
+			mEvictionPolicy->selectVictims(candidates, bytesToFree - freed, victims);
+
+			// drop the finest level of each victim, repeat if it was not enough
+			bool dropped = false;
+			for (uint32 i=0; i < victims.size() && freed < bytesToFree; i++){
+				SharedPtr<ResourceHolder> holder = getHolderByHandle(victims[i]);
+				if (holder == NULL || holder->isInUse(getFrame())) continue;
+
+				// a level beeing loaded would not fit to the resident ones anymore
+				if (mLoadQueue->isPending(victims[i], true)) continue;
+
+				IResource* res = holder->mResource.get();
+				uint32 level = res->getResLevel();
+				if (level == 0) continue;
+
+				size_t size = res->getResDataSize();
+				if (res->mResLoader->unloadResourceLevel(res, level) != OK){
+					NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceManager: Could not drop level %d of resource %s", level, res->getResName().c_str());
+					continue;
+				}
+				res->mResLevel = level - 1;
+				dropped = true;
+
+				NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "ResourceManager: Drop level %d of resource %s", level, res->getResName().c_str());
+				if (res->getResDataSize() < size) freed += size - res->getResDataSize();
+				updateUsage(victims[i], res);
+			}
+			if (!dropped) break;
+		}
+
+		return freed;
 	}
 
 	//----------------------------------------------------------------------------------
 	Result ResourceManager::checkMemoryUsage(){
-		// TODO: Has to be implemented
+
+		// check whenever we have to free some memory
+		size_t bytesToFree = 0;
+		size_t usage = getMemoryUsage();
+		if (mMemBudget > 0 && usage > mMemBudget) bytesToFree = usage - mMemBudget;
+
+		// empty chunks of the heap are given back before anything is unloaded
+		if (bytesToFree > 0){
+			size_t freed = mHeap->trim();
+			bytesToFree = freed < bytesToFree ? bytesToFree - freed : 0;
+		}
+		if (!mEvictionPolicy) return OK;
+
+		// the resources are only collected if the budget or a quota of the policy is exceeded
+		bool quotaExceeded = mEvictionPolicy->isQuotaExceeded(*mStatistics);
+		if (bytesToFree == 0 && !quotaExceeded) return OK;
+
+		// drop fine levels first, whole resources are unloaded only if this is not enough
+		if (bytesToFree > 0){
+			size_t freed = dropLevels(bytesToFree);
+			bytesToFree = freed < bytesToFree ? bytesToFree - freed : 0;
+			if (bytesToFree == 0 && !mEvictionPolicy->isQuotaExceeded(*mStatistics)) return OK;
+		}
+
+		// collect all loaded resources
+		ResourceEvictionPolicy::CandidateList candidates;
+		getEvictionCandidates(candidates, false);
+
+		// let the policy decide which resources to unload
+		::std::vector<ResourceHandle> victims;
+		mEvictionPolicy->selectVictims(candidates, bytesToFree, victims);
+
+		// unload them as unload() does, so the holders will give empty resources back,
+		// waiting dependents are notified and unused dependencies are released
+		for (uint32 i=0; i < victims.size(); i++){
+			SharedPtr<ResourceHolder> holder = getHolderByHandle(victims[i]);
+			if (holder == NULL || holder->isInUse(getFrame())) continue;
+
+			IResource* res = holder->mResource.get();
+			size_t size = res->getResDataSize();
+
+			NR_Log(Log::LOG_ENGINE, Log::LL_DEBUG, "ResourceManager: Evict resource %s (%lu bytes)", res->getResName().c_str(), (unsigned long)size);
+			IResourcePtr ptr(holder);
+			if (unload(ptr) != OK){
+				NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceManager: Could not evict resource %s", res->getResName().c_str());
+			}
+		}
+
+		usage = getMemoryUsage();
+		if (mMemBudget > 0 && usage > mMemBudget){
+			NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourceManager: Memory budget exceeded (%lu of %lu bytes), remaining resources are locked", (unsigned long)usage, (unsigned long)mMemBudget);
+		}
+
 		return OK;
 	}
 
@@ -667,7 +1697,8 @@ namespace nrEngine{
 			return OK;
 		}
 
-		ResourceHandle handle = mLastHandle++;
+		ResourceHandle handle = createHandle(name);
+		if (handle == 0) return RES_DATABASE_IS_FULL;
 		NR_Log(Log::LOG_ENGINE, "ResourceManager: Add resource %s id=%d to the database from outside", name.c_str(), handle);
 
 		// check now if a empty resource of that type already exists and load it if not
@@ -679,19 +1710,18 @@ namespace nrEngine{
 		holder->resetRes(res);
 		holder->setEmptyResource(empty);
 
-		// store the resource in database
-		mResourceGroup[group].push_back(handle);
-		mResource[handle] = holder;
-		mResourceName[name] = handle;
-
 		res->mResGroup = group;
 		res->mResName = name;
 		res->mResHandle = handle;
 		res->mParentManager = this;
 
-		// check for memory usage
-		mMemUsage += holder->getResource()->getResDataSize();
+		// store the resource in database
+		insertResource(handle, name, group, holder);
+
+		// check for memory usage, the new resource should not be unloaded
+		holder->lockPure();
 		Result ret = checkMemoryUsage();
+		holder->unlockPure();
 
 		if (ret != OK){
 			NR_Log(Log::LOG_ENGINE, "ResourceManager: Could not rearrange memory");
@@ -739,11 +1769,11 @@ namespace nrEngine{
 	Result ResourceManager::unlockPure(const ::std::string& name){
 
 		// get appropriate holder
-		SharedPtr<ResourceHolder>* holder = getHolderByName(name);
+		SharedPtr<ResourceHolder> holder = getHolderByName(name);
 
 		if (holder != NULL){
 			// lock the resource through the holder
-			(*holder)->unlockPure();
+			holder->unlockPure();
 		}else{
 			return RES_NOT_FOUND;
 		}
@@ -756,11 +1786,11 @@ namespace nrEngine{
 	Result ResourceManager::unlockPure(ResourceHandle& handle){
 
 		// get appropriate holder
-		SharedPtr<ResourceHolder>* holder = getHolderByHandle(handle);
+		SharedPtr<ResourceHolder> holder = getHolderByHandle(handle);
 
 		if (holder != NULL){
 			// lock the resource through the holder
-			(*holder)->unlockPure();
+			holder->unlockPure();
 		}else{
 			return RES_NOT_FOUND;
 		}
@@ -784,11 +1814,26 @@ namespace nrEngine{
 	}
 
 	//----------------------------------------------------------------------------------
-	Result ResourceManager::unloadGroup(const ::std::string& group){
+	bool ResourceManager::getGroupHandles(const ::std::string& group, ::std::list<ResourceHandle>& handles){
+		::boost::mutex::scoped_lock lock(mGroupMutex);
 
-		// check whenever such a group exists
 		res_grp_map::const_iterator it = mResourceGroup.find(group);
-		if (it == mResourceGroup.end()){
+		if (it == mResourceGroup.end()) return false;
+
+		// slots of the group does not change while the lock is held
+		handles.clear();
+		for (uint32 slot = it->second.first; slot != NR_RESOURCE_NO_SLOT; slot = getSlot(slot).groupNext){
+			handles.push_back(makeHandle(slot));
+		}
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceManager::unloadGroup(const ::std::string& group){
+
+		// check whenever such a group exists, the handles are copied because the group could change
+		::std::list<ResourceHandle> handles;
+		if (!getGroupHandles(group, handles)){
 			NR_Log(Log::LOG_ENGINE, "ResourceManager: Can not unload group \"%s\" because not found in database", group.c_str());
 			return RES_GROUP_NOT_FOUND;
 		}
@@ -796,8 +1841,8 @@ namespace nrEngine{
 		NR_Log(Log::LOG_ENGINE, "ResourceManager: Unload the group \"%s\"", group.c_str());
 
 		// scan through all elements
-		::std::list<ResourceHandle>::iterator jt = mResourceGroup[group].begin();
-		for (; jt != mResourceGroup[group].end(); jt++){
+		::std::list<ResourceHandle>::iterator jt = handles.begin();
+		for (; jt != handles.end(); jt++){
 			Result ret = unload(*jt);
 			if (ret != OK) return ret;
 		}
@@ -809,9 +1854,9 @@ namespace nrEngine{
 	//----------------------------------------------------------------------------------
 	Result ResourceManager::reloadGroup(const ::std::string& group){
 
-		// check whenever such a group exists
-		res_grp_map::const_iterator it = mResourceGroup.find(group);
-		if (it == mResourceGroup.end()){
+		// check whenever such a group exists, the handles are copied because the group could change
+		::std::list<ResourceHandle> handles;
+		if (!getGroupHandles(group, handles)){
 			NR_Log(Log::LOG_ENGINE, "ResourceManager: Can not reload group \"%s\" because not found in database", group.c_str());
 			return RES_GROUP_NOT_FOUND;
 		}
@@ -819,8 +1864,8 @@ namespace nrEngine{
 		NR_Log(Log::LOG_ENGINE, "ResourceManager: Reload the group \"%s\"", group.c_str());
 
 		// scan through all elements
-		::std::list<ResourceHandle>::iterator jt = mResourceGroup[group].begin();
-		for (; jt != mResourceGroup[group].end(); jt++){
+		::std::list<ResourceHandle>::iterator jt = handles.begin();
+		for (; jt != handles.end(); jt++){
 			Result ret = reload(*jt);
 			if (ret != OK) return ret;
 		}
@@ -833,9 +1878,9 @@ namespace nrEngine{
 	//----------------------------------------------------------------------------------
 	Result ResourceManager::removeGroup(const ::std::string& group){
 
-		// check whenever such a group exists
-		res_grp_map::const_iterator it = mResourceGroup.find(group);
-		if (it == mResourceGroup.end()){
+		// check whenever such a group exists, the handles are copied because the group could change
+		::std::list<ResourceHandle> handles;
+		if (!getGroupHandles(group, handles)){
 			NR_Log(Log::LOG_ENGINE, "ResourceManager: Can not remove group \"%s\" because not found in database", group.c_str());
 			return RES_GROUP_NOT_FOUND;
 		}
@@ -843,28 +1888,223 @@ namespace nrEngine{
 		NR_Log(Log::LOG_ENGINE, "ResourceManager: Remove all elements from the group \"%s\"", group.c_str());
 
 		// scan through all elements
-		::std::list<ResourceHandle>::iterator jt = mResourceGroup[group].begin();
-		for (; jt != mResourceGroup[group].end(); jt++){
+		::std::list<ResourceHandle>::iterator jt = handles.begin();
+		for (; jt != handles.end(); jt++){
 			Result ret = remove(*jt);
 			if (ret != OK) return ret;
 		}
 
-		// remove the group
-		mResourceGroup.erase(group);
-
-		// OK
+		// OK, the group was removed together with its last resource
 		return OK;
 
 	}
 
 	//----------------------------------------------------------------------------------
-	void ResourceManager::_notifyResourceLoaded(ResourceHandle& handle){
+	ResourceManager::GroupFuture ResourceManager::loadGroup(const ::std::string& group, const ::std::string& manifest, Priority priority){
+
+		::std::vector<ResourceDependency> resources;
+		if (ResourcePreloader::readManifest(manifest, resources) != OK){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourceManager: Can not read manifest %s of group \"%s\"", manifest.c_str(), group.c_str());
+			::boost::promise<Result> failed;
+			failed.set_value(FILE_ERROR);
+			return GroupFuture(failed.get_future());
+		}
 
+		return loadGroup(group, resources, priority);
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceManager::GroupFuture ResourceManager::loadGroup(const ::std::string& group, const ::std::vector<ResourceDependency>& resources, Priority priority){
+
+		SharedPtr<GroupOperation> op(new GroupOperation());
+		op->waiting = 0;
+		op->reload = false;
+		op->done = false;
+		op->priority = priority;
+		op->result = OK;
+		GroupFuture future(op->promise.get_future());
+
+		NR_Log(Log::LOG_ENGINE, "ResourceManager: Load %lu resources into the group \"%s\"", (unsigned long)resources.size(), group.c_str());
+
+		// the resources are usable at once, they give their empty resources until they are loaded
+		for (uint32 i=0; i < resources.size(); i++){
+			SharedPtr<ResourceHolder> holder = createAsyncResource(resources[i].name, group,
+										resources[i].resourceType, resources[i].fileName, NULL, ResourceLoader());
+			if (holder == NULL){
+				op->result = RES_ERROR;
+				continue;
+			}
+			op->remaining.push_back(holder->mResource->getResHandle());
+		}
+
+		runGroupOperation(op);
+		return future;
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceManager::GroupFuture ResourceManager::reloadGroupAsync(const ::std::string& group, Priority priority){
+
+		SharedPtr<GroupOperation> op(new GroupOperation());
+		op->waiting = 0;
+		op->reload = true;
+		op->done = false;
+		op->priority = priority;
+		op->result = OK;
+		GroupFuture future(op->promise.get_future());
+
+		if (!getGroupHandles(group, op->remaining)){
+			NR_Log(Log::LOG_ENGINE, "ResourceManager: Can not reload group \"%s\" because not found in database", group.c_str());
+			op->result = RES_GROUP_NOT_FOUND;
+		}else{
+			NR_Log(Log::LOG_ENGINE, "ResourceManager: Reload the group \"%s\" in the background", group.c_str());
+		}
+
+		runGroupOperation(op);
+		return future;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::runGroupOperation(SharedPtr<GroupOperation> op){
+
+		while (true){
+
+			// start the next resource, if not too much of them are loaded at now
+			ResourceHandle handle;
+			{
+				::boost::mutex::scoped_lock lock(mGroupOperationMutex);
+				if (op->remaining.size() == 0 || op->waiting >= mGroupConcurrency) break;
+				handle = op->remaining.front();
+				op->remaining.pop_front();
+			}
+
+			SharedPtr<ResourceHolder> holder = getHolderByHandle(handle);
+			if (holder == NULL){
+				::boost::mutex::scoped_lock lock(mGroupOperationMutex);
+				op->result = RES_NOT_FOUND;
+				continue;
+			}
+
+			// resources which are loaded or queued by someone else are not queued again
+			IResource* res = holder->mResource.get();
+			bool pending = mLoadQueue->isPending(handle);
+			if (res->isResLoaded() && !op->reload && !pending) continue;
+
+			{
+				::boost::mutex::scoped_lock lock(mGroupOperationMutex);
+				mGroupOperation[handle].push_back(op);
+				op->waiting++;
+			}
+			if (pending && !op->reload) continue;
+
+			// the load queue does complete the request in its finalisation stage
+			Result ret = reloadAsync(handle, op->priority);
+			if (ret != OK){
+				::boost::mutex::scoped_lock lock(mGroupOperationMutex);
+				::std::vector< SharedPtr<GroupOperation> >& ops = mGroupOperation[handle];
+				ops.erase(::std::find(ops.begin(), ops.end(), op));
+				if (ops.size() == 0) mGroupOperation.erase(handle);
+				op->waiting--;
+				op->result = ret;
+			}
+		}
+
+		// all resources are complete
+		::boost::mutex::scoped_lock lock(mGroupOperationMutex);
+		if (!op->done && op->remaining.size() == 0 && op->waiting == 0){
+			op->done = true;
+			op->promise.set_value(op->result);
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::finishGroupRequest(ResourceHandle handle, Result result){
+
+		::std::vector< SharedPtr<GroupOperation> > ops;
+		{
+			::boost::mutex::scoped_lock lock(mGroupOperationMutex);
+			group_op_map::iterator it = mGroupOperation.find(handle);
+			if (it == mGroupOperation.end()) return;
+			ops.swap(it->second);
+			mGroupOperation.erase(it);
+
+			for (uint32 i=0; i < ops.size(); i++){
+				ops[i]->waiting--;
+				if (result != OK && ops[i]->result == OK) ops[i]->result = result;
+			}
+		}
+
+		// start the next resources of the operations
+		for (uint32 i=0; i < ops.size(); i++){
+			runGroupOperation(ops[i]);
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::_notifyResourceLoaded(ResourceHandle& handle){
+		updateUsage(handle);
 	}
 
 	//----------------------------------------------------------------------------------
 	void ResourceManager::_notifyResourceUnloaded(ResourceHandle& handle){
+		updateUsage(handle);
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::updateUsage(ResourceHandle handle){
+
+		SharedPtr<ResourceHolder> holder = getHolderByHandle(handle);
+		if (holder != NULL) updateUsage(handle, holder->mResource.get());
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::updateUsage(ResourceHandle handle, IResource* res)
+	{
+		uint32 slot = handle & NR_RESOURCE_SLOT_MASK;
+		ResourceShard& shard = mShard[slot & (NR_RESOURCE_SHARDS - 1)];
+		ReadLock lock(shard.lock);
+
+		// the entry does only belong to the resource while its handle is valid
+		if (slot / NR_RESOURCE_SHARDS >= shard.slotCount || makeHandle(slot) != handle) return;
+		mStatistics->update(getSlot(slot).statistics, res);
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::addLoadTime(ResourceHandle handle, uint64 microseconds)
+	{
+		uint32 slot = handle & NR_RESOURCE_SLOT_MASK;
+		ResourceShard& shard = mShard[slot & (NR_RESOURCE_SHARDS - 1)];
+		ReadLock lock(shard.lock);
+
+		if (slot / NR_RESOURCE_SHARDS >= shard.slotCount || makeHandle(slot) != handle) return;
+		mStatistics->addLoadTime(getSlot(slot).statistics, microseconds);
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceManager::watchResources()
+	{
+		for (uint32 k=0; k < NR_RESOURCE_SHARDS; k++){
+			ResourceShard& shard = mShard[k];
+			WriteLock lock(shard.lock);
+			for (uint32 i=0; i < shard.slotCount; i++){
+				uint32 slot = i * NR_RESOURCE_SHARDS + k;
+				ResourceSlot& s = getSlot(slot);
+				if (s.holder == NULL || s.watched) continue;
+				s.watched = mFileWatcher->watch(makeHandle(slot), s.holder->mResource->getResFileName(), s.watchEntry);
+			}
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	::std::string ResourceManager::getLoaderName(ResourceLoader loader){
+
+		ReadLock lock(mLoaderMutex);
+		loader_map::const_iterator it = mLoader.begin();
+		for (; it != mLoader.end(); it++){
+			if (it->second == loader) return it->first;
+		}
 
+		// loader given by the user
+		return "Unregistered";
 	}
 
 };
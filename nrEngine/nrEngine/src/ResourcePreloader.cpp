@@ -0,0 +1,243 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "ResourcePreloader.h"
+#include "ResourceManager.h"
+#include "Log.h"
+#include "Profiler.h"
+
+#include <fstream>
+#include <cctype>
+
+namespace nrEngine{
+
+	//----------------------------------------------------------------------------------
+	ResourcePreloader::ResourcePreloader(ResourceManager* manager) : ITask("ResourcePreloader")
+	{
+		mManager = manager;
+		mRecording = false;
+		mStopTime = 0;
+		mPreloadCount = 0;
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourcePreloader::~ResourcePreloader()
+	{
+		stop();
+	}
+
+	//----------------------------------------------------------------------------------
+	// Read the next field of a manifest line, fields with spaces are quoted
+	//----------------------------------------------------------------------------------
+	static bool readField(const ::std::string& line, ::std::string::size_type& pos, ::std::string& field)
+	{
+		field.clear();
+		while (pos < line.length() && isspace((unsigned char)line[pos])) pos++;
+
+		// the rest of the line is a comment
+		if (pos >= line.length() || line.compare(pos, 2, "//") == 0) return false;
+
+		if (line[pos] != '"'){
+			::std::string::size_type end = pos;
+			while (end < line.length() && !isspace((unsigned char)line[end])) end++;
+			field = line.substr(pos, end - pos);
+			pos = end;
+			return true;
+		}
+
+		// quoted field, \\ and \" are escaped
+		for (pos++; pos < line.length() && line[pos] != '"'; pos++){
+			if (line[pos] == '\\' && pos + 1 < line.length()) pos++;
+			field += line[pos];
+		}
+		pos++;
+		return true;
+	}
+
+	//----------------------------------------------------------------------------------
+	// Quote a field if it could not be readed back otherwise
+	//----------------------------------------------------------------------------------
+	static ::std::string writeField(const ::std::string& field)
+	{
+		bool quote = field.empty() || field[0] == '"' || field.find("//") != ::std::string::npos;
+		for (uint32 i=0; i < field.length() && !quote; i++)
+			quote = isspace((unsigned char)field[i]) != 0;
+		if (!quote) return field;
+
+		::std::string str = "\"";
+		for (uint32 i=0; i < field.length(); i++){
+			if (field[i] == '"' || field[i] == '\\') str += '\\';
+			str += field[i];
+		}
+		return str + "\"";
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourcePreloader::readManifest(const ::std::string& fileName, ::std::vector<ResourceDependency>& resources)
+	{
+		::std::ifstream file(fileName.c_str());
+		if (!file.good()) return FILE_ERROR;
+
+		// each line does describe one resource
+		::std::string line;
+		while (::std::getline(file, line)){
+			ResourceDependency res;
+			::std::string::size_type pos = 0;
+			if (!readField(line, pos, res.name)) continue;
+			if (!readField(line, pos, res.resourceType) || !readField(line, pos, res.fileName)){
+				NR_Log(Log::LOG_ENGINE, Log::LL_WARNING, "ResourcePreloader: Manifest %s has a bad line: %s", fileName.c_str(), line.c_str());
+				continue;
+			}
+			readField(line, pos, res.group);
+			resources.push_back(res);
+		}
+
+		return OK;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourcePreloader::writeManifest(const ::std::string& fileName, const ::std::vector<ResourceDependency>& resources)
+	{
+		::std::ofstream file(fileName.c_str(), ::std::ios::trunc);
+		file << "// name type file group" << ::std::endl;
+		for (uint32 i=0; i < resources.size(); i++){
+			const ResourceDependency& res = resources[i];
+			file << writeField(res.name) << " " << writeField(res.resourceType) << " " << writeField(res.fileName);
+			if (res.group.length() > 0) file << " " << writeField(res.group);
+			file << ::std::endl;
+		}
+		file.close();
+
+		if (file.fail()){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "ResourcePreloader: Can not write manifest %s", fileName.c_str());
+			return FILE_ERROR;
+		}
+		return OK;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourcePreloader::start(const ::std::string& manifest, float32 seconds, Priority priority)
+	{
+		// finish the last recording
+		stop();
+
+		// there is no manifest at the first run
+		::std::vector<ResourceDependency> resources;
+		Result ret = OK;
+		if (::std::ifstream(manifest.c_str()).good()){
+			ret = readManifest(manifest, resources);
+		}else{
+			NR_Log(Log::LOG_ENGINE, "ResourcePreloader: There is no manifest %s, only record", manifest.c_str());
+		}
+
+		// give all resources to the loader threads, they are loaded in parallel
+		uint32 count = 0;
+		for (uint32 i=0; i < resources.size(); i++){
+			if (!mManager->preload(resources[i], priority)) continue;
+
+			boost::mutex::scoped_lock lock(mMutex);
+			mPreloaded.insert(resources[i].name);
+			count++;
+		}
+
+		NR_Log(Log::LOG_ENGINE, "ResourcePreloader: Preload %d resources, record the next %.1f seconds to %s", count, seconds, manifest.c_str());
+
+		boost::mutex::scoped_lock lock(mMutex);
+		mPreloadCount = count;
+		mFileName = manifest;
+		mRecorded.clear();
+		mRecordedNames.clear();
+		mStopTime = ResourceStatistics::getMicroseconds() + uint64(seconds * 1000000.0f);
+		mRecording = true;
+
+		return ret;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourcePreloader::stop()
+	{
+		::std::vector<ResourceDependency> resources;
+		::std::string fileName;
+		{
+			boost::mutex::scoped_lock lock(mMutex);
+			if (!mRecording) return OK;
+			mRecording = false;
+			resources.swap(mRecorded);
+			mRecordedNames.clear();
+			fileName = mFileName;
+		}
+
+		NR_Log(Log::LOG_ENGINE, "ResourcePreloader: Write %lu recorded resources to %s", (unsigned long)resources.size(), fileName.c_str());
+		return writeManifest(fileName, resources);
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourcePreloader::isRecording()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mRecording;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourcePreloader::record(const ::std::string& name, const ::std::string& resourceType,
+						const ::std::string& fileName, const ::std::string& group)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		if (!mRecording || ResourceStatistics::getMicroseconds() > mStopTime) return;
+
+		// only the first request does count
+		if (!mRecordedNames.insert(name).second) return;
+
+		ResourceDependency res;
+		res.name = name;
+		res.resourceType = resourceType;
+		res.fileName = fileName;
+		res.group = group;
+		mRecorded.push_back(res);
+	}
+
+	//----------------------------------------------------------------------------------
+	bool ResourcePreloader::takePreloaded(const ::std::string& name)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mPreloaded.erase(name) > 0;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourcePreloader::taskUpdate()
+	{
+		// Profiling of the engine
+		_nrEngineProfile("ResourcePreloader.taskUpdate");
+
+		bool finished = false;
+		{
+			boost::mutex::scoped_lock lock(mMutex);
+			finished = mRecording && ResourceStatistics::getMicroseconds() > mStopTime;
+		}
+		if (finished) stop();
+
+		return OK;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourcePreloader::taskStop()
+	{
+		stop();
+		return OK;
+	}
+
+};
+
@@ -90,15 +90,9 @@ namespace nrEngine{
 	}
 	
 	//----------------------------------------------------------------------------------
-	IResource* IResourcePtr::operator->() const{
+	IResource* IResourcePtr::pin() const{
 		NR_ASSERT(mHolder.get() != NULL && "Holder does not contain valid data");
-		return mHolder->getResource();
-	}
-
-	//----------------------------------------------------------------------------------
-	IResource& IResourcePtr::operator*() const{
-		NR_ASSERT(mHolder.get() != NULL && "Holder does not contain valid data");
-		return *mHolder->getResource();
+		return mHolder->pin(ResourceManager::GetSingleton().getFrame());
 	}
 
 		
@@ -0,0 +1,222 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "ResourceReclaimQueue.h"
+#include "ResourceStatistics.h"
+#include "Log.h"
+#include "Profiler.h"
+#include <boost/bind.hpp>
+
+#if NR_PLATFORM == NR_PLATFORM_LINUX
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+namespace nrEngine{
+
+	//----------------------------------------------------------------------------------
+	ResourceReclaimQueue::ResourceReclaimQueue(size_t byteLimit) : ITask("ResourceReclaimQueue")
+	{
+		mPendingBytes = 0;
+		mByteLimit = byteLimit;
+		mTimeBudget = 1000;
+		mRunning = false;
+		mStarted = false;
+		mShutdown = false;
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceReclaimQueue::~ResourceReclaimQueue()
+	{
+		shutdown();
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceReclaimQueue::release(Entry& entry)
+	{
+		entry.release();
+
+		// data held by the function is freed here too
+		entry.release.clear();
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceReclaimQueue::push(const Release& release, size_t size, bool threadSafe)
+	{
+		Entry entry;
+		entry.release = release;
+		entry.size = size;
+
+		{
+			boost::mutex::scoped_lock lock(mMutex);
+
+			// release at once if there is already too much waiting
+			if (mShutdown || mPendingBytes + size > mByteLimit){
+				lock.unlock();
+				ResourceReclaimQueue::release(entry);
+				return;
+			}
+
+			mPendingBytes += size;
+			if (!threadSafe){
+				mMainQueued.push_back(entry);
+				return;
+			}
+
+			// start the thread with the first release
+			if (!mStarted){
+				mThread.reset(new boost::thread(boost::bind(&ResourceReclaimQueue::run, this)));
+				mStarted = true;
+
+				// the thread should only use the time not needed by the others
+#if NR_PLATFORM == NR_PLATFORM_LINUX && defined(SCHED_IDLE)
+				struct sched_param param;
+				param.sched_priority = 0;
+				pthread_setschedparam(mThread->native_handle(), SCHED_IDLE, &param);
+#endif
+			}
+
+			mQueued.push_back(entry);
+			mQueueSignal.notify_one();
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceReclaimQueue::flush()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+
+		// do the releases of the thread too, so they are done now
+		while (mMainQueued.size() > 0 || mQueued.size() > 0){
+			EntryList& list = mMainQueued.size() > 0 ? mMainQueued : mQueued;
+			Entry entry = list.front();
+			list.pop_front();
+
+			lock.unlock();
+			release(entry);
+			lock.lock();
+			mPendingBytes -= entry.size;
+		}
+
+		// wait for the release done by the thread at now
+		while (mRunning){
+			mDoneSignal.wait(lock);
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceReclaimQueue::shutdown()
+	{
+		flush();
+
+		{
+			boost::mutex::scoped_lock lock(mMutex);
+			if (!mStarted) return;
+			mShutdown = true;
+			mQueueSignal.notify_all();
+		}
+
+		mThread->join();
+
+		boost::mutex::scoped_lock lock(mMutex);
+		mThread.reset();
+		mStarted = false;
+		mShutdown = false;
+	}
+
+	//----------------------------------------------------------------------------------
+	size_t ResourceReclaimQueue::getPendingBytes()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mPendingBytes;
+	}
+
+	//----------------------------------------------------------------------------------
+	uint32 ResourceReclaimQueue::getPendingCount()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mQueued.size() + mMainQueued.size() + (mRunning ? 1 : 0);
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceReclaimQueue::run()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+
+		while (true){
+
+			// wait for a release
+			while (!mShutdown && mQueued.size() == 0){
+				mQueueSignal.wait(lock);
+			}
+			if (mQueued.size() == 0) return;
+
+			Entry entry = mQueued.front();
+			mQueued.pop_front();
+			mRunning = true;
+
+			// the list is not locked while releasing
+			lock.unlock();
+			release(entry);
+			lock.lock();
+
+			mPendingBytes -= entry.size;
+			mRunning = false;
+			mDoneSignal.notify_all();
+		}
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceReclaimQueue::taskUpdate()
+	{
+		// Profiling of the engine
+		_nrEngineProfile("ResourceReclaimQueue.taskUpdate");
+
+		uint64 start = ResourceStatistics::getMicroseconds();
+
+		while (true){
+
+			Entry entry;
+			{
+				boost::mutex::scoped_lock lock(mMutex);
+				if (mMainQueued.size() == 0) break;
+				entry = mMainQueued.front();
+				mMainQueued.pop_front();
+			}
+
+			release(entry);
+
+			{
+				boost::mutex::scoped_lock lock(mMutex);
+				mPendingBytes -= entry.size;
+			}
+
+			// the rest is done in the next update
+			if (mTimeBudget > 0 && ResourceStatistics::getMicroseconds() - start >= mTimeBudget) break;
+		}
+
+		return OK;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceReclaimQueue::taskStop()
+	{
+		shutdown();
+		return OK;
+	}
+
+};
+
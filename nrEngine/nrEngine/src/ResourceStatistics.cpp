@@ -0,0 +1,252 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "ResourceStatistics.h"
+#include "Log.h"
+#include "GetTime.h"
+
+namespace nrEngine{
+
+	//----------------------------------------------------------------------------------
+	ResourceUsage::ResourceUsage() : memory(0), peakMemory(0), loadedCount(0), emptyCount(0), loadCount(0), loadTime(0)
+	{
+		for (int32 i=0; i < NR_RESOURCE_LOAD_TIME_BUCKETS; i++)
+			loadTimeHistogram[i] = 0;
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceStatistics::ResourceStatistics() : ITask("ResourceStatistics")
+	{
+		mLogInterval = 0;
+		mLastLog = getMicroseconds();
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceStatistics::~ResourceStatistics()
+	{
+
+	}
+
+	//----------------------------------------------------------------------------------
+	uint64 ResourceStatistics::getMicroseconds()
+	{
+		timeval now;
+		gettimeofday(&now, NULL);
+		return uint64(now.tv_sec) * 1000000 + now.tv_usec;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceStatistics::change(ResourceUsage& usage, const Entry& entry, std::size_t size, bool loaded)
+	{
+		// remove the old state
+		if (entry.recorded){
+			usage.memory -= entry.size < usage.memory ? entry.size : usage.memory;
+			if (entry.loaded) usage.loadedCount--; else usage.emptyCount--;
+		}
+
+		// add the new one
+		usage.memory += size;
+		if (loaded) usage.loadedCount++; else usage.emptyCount++;
+		if (usage.memory > usage.peakMemory) usage.peakMemory = usage.memory;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceStatistics::addTime(ResourceUsage& usage, uint64 microseconds)
+	{
+		usage.loadCount++;
+		usage.loadTime += microseconds;
+
+		// find the bucket
+		uint64 ms = microseconds / 1000;
+		int32 bucket = 0;
+		while (bucket < NR_RESOURCE_LOAD_TIME_BUCKETS - 1 && ms >= (uint64(1) << bucket)) bucket++;
+		usage.loadTimeHistogram[bucket]++;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceStatistics::insert(Entry& e, const std::string& group, const std::string& resourceType, const std::string& loader)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+
+		e.group = group;
+		e.type = resourceType;
+		e.loader = loader;
+		e.size = 0;
+		e.inserted = true;
+		e.loaded = false;
+		e.recorded = false;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceStatistics::update(Entry& e, IResource* res)
+	{
+		NR_ASSERT(res != NULL);
+		std::size_t size = res->getResDataSize();
+		bool loaded = res->isResLoaded();
+
+		boost::mutex::scoped_lock lock(mMutex);
+		if (!e.inserted) return;
+
+		// nothing has changed
+		if (e.recorded && e.size == size && e.loaded == loaded) return;
+
+		change(mTotal, e, size, loaded);
+		change(mGroup[e.group], e, size, loaded);
+		change(mType[e.type], e, size, loaded);
+		change(mLoader[e.loader], e, size, loaded);
+
+		e.size = size;
+		e.loaded = loaded;
+		e.recorded = true;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceStatistics::addLoadTime(Entry& e, uint64 microseconds)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		if (!e.inserted) return;
+
+		addTime(mTotal, microseconds);
+		addTime(mGroup[e.group], microseconds);
+		addTime(mType[e.type], microseconds);
+		addTime(mLoader[e.loader], microseconds);
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceStatistics::remove(Entry& e)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		if (!e.inserted) return;
+
+		// the resource does not use anything anymore
+		if (e.recorded){
+			ResourceUsage* usage[4] = {&mTotal, &mGroup[e.group], &mType[e.type], &mLoader[e.loader]};
+			for (int32 i=0; i < 4; i++){
+				usage[i]->memory -= e.size < usage[i]->memory ? e.size : usage[i]->memory;
+				if (e.loaded) usage[i]->loadedCount--; else usage[i]->emptyCount--;
+			}
+		}
+
+		e = Entry();
+	}
+
+	//----------------------------------------------------------------------------------
+	std::size_t ResourceStatistics::getMemoryUsage()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mTotal.memory;
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceUsage ResourceStatistics::getTotalUsage()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mTotal;
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceUsage ResourceStatistics::find(const UsageMap& map, const std::string& name)
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+
+		UsageMap::const_iterator it = map.find(name);
+		if (it == map.end()) return ResourceUsage();
+		return it->second;
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceUsage ResourceStatistics::getGroupUsage(const std::string& group)
+	{
+		return find(mGroup, group);
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceUsage ResourceStatistics::getTypeUsage(const std::string& resourceType)
+	{
+		return find(mType, resourceType);
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceUsage ResourceStatistics::getLoaderUsage(const std::string& loader)
+	{
+		return find(mLoader, loader);
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceStatistics::UsageMap ResourceStatistics::getGroupUsage()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mGroup;
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceStatistics::UsageMap ResourceStatistics::getTypeUsage()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mType;
+	}
+
+	//----------------------------------------------------------------------------------
+	ResourceStatistics::UsageMap ResourceStatistics::getLoaderUsage()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		return mLoader;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceStatistics::logUsage(const std::string& name, const ResourceUsage& usage)
+	{
+		// histogram as list of counts
+		std::string hist;
+		for (int32 i=0; i < NR_RESOURCE_LOAD_TIME_BUCKETS; i++){
+			hist += boost::lexical_cast<std::string>(usage.loadTimeHistogram[i]) + " ";
+		}
+
+		NR_Log(Log::LOG_ENGINE, "ResourceStatistics: %s: %lu bytes (peak %lu), %d loaded, %d empty, %d loads in %d ms, histogram: %s",
+			name.c_str(), (unsigned long)usage.memory, (unsigned long)usage.peakMemory, usage.loadedCount, usage.emptyCount,
+			usage.loadCount, uint32(usage.loadTime / 1000), hist.c_str());
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceStatistics::logStatistics()
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+
+		UsageMap::const_iterator it;
+		logUsage("Total", mTotal);
+		for (it = mGroup.begin(); it != mGroup.end(); it++)
+			logUsage("Group \"" + it->first + "\"", it->second);
+		for (it = mType.begin(); it != mType.end(); it++)
+			logUsage("Type " + it->first, it->second);
+		for (it = mLoader.begin(); it != mLoader.end(); it++)
+			logUsage("Loader " + it->first, it->second);
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceStatistics::taskUpdate()
+	{
+		if (mLogInterval == 0) return OK;
+
+		uint64 now = getMicroseconds();
+		if (now - mLastLog < uint64(mLogInterval) * 1000000) return OK;
+		mLastLog = now;
+
+		logStatistics();
+		return OK;
+	}
+
+};
+
@@ -18,6 +18,8 @@
 #include "ScriptEngine.h"
 #include "Clock.h"
 #include "Log.h"
+#include "ResourceManager.h"
+#include "ResourceReclaimQueue.h"
 
 namespace nrEngine {
 
@@ -37,6 +39,27 @@ namespace nrEngine {
 	}
 
 
+	//----------------------------------------------------------------------------------
+	Result Script::unloadRes()
+	{
+		if (!mResIsLoaded) return OK;
+		Result ret = IScript::unloadRes();
+
+		// the commands are parsed again by loading, so release them in the background
+		SharedPtr<Payload> payload(new Payload());
+		payload->content.swap(mContent);
+		payload->command.swap(mCommand);
+		payload->timedCommand.swap(mTimedCommand);
+		mCommandFifo.clear();
+		mTimedCommandFifo.clear();
+
+		size_t size = payload->content.size() + (payload->command.size() + payload->timedCommand.size()) * sizeof(Command);
+		if (ResourceManager::isValid())
+			ResourceManager::GetSingleton().getReclaimQueue()->pushData(payload, size);
+
+		return ret;
+	}
+
 	//----------------------------------------------------------------------------------
 	Result Script::loadFromString(const std::string& str)
 	{
@@ -151,6 +174,113 @@ namespace nrEngine {
 		
 	}
 
+	//------------------------------------------------------------------------------
+	static void cookUint(uint32 value, std::vector<byte>& data)
+	{
+		const byte* b = (const byte*)&value;
+		data.insert(data.end(), b, b + sizeof(uint32));
+	}
+
+	//------------------------------------------------------------------------------
+	static void cookString(const std::string& str, std::vector<byte>& data)
+	{
+		cookUint(str.length(), data);
+		data.insert(data.end(), str.begin(), str.end());
+	}
+
+	//------------------------------------------------------------------------------
+	static bool loadCookedUint(uint32& value, const byte*& data, const byte* end)
+	{
+		if (end - data < (int32)sizeof(uint32)) return false;
+		memcpy(&value, data, sizeof(uint32));
+		data += sizeof(uint32);
+		return true;
+	}
+
+	//------------------------------------------------------------------------------
+	static bool loadCookedString(std::string& str, const byte*& data, const byte* end)
+	{
+		uint32 length;
+		if (!loadCookedUint(length, data, end) || uint32(end - data) < length) return false;
+		str.assign((const char*)data, length);
+		data += length;
+		return true;
+	}
+
+	//------------------------------------------------------------------------------
+	void Script::cookCommand(const Command& cmd, std::vector<byte>& data)
+	{
+		uint32 timestamp;
+		memcpy(&timestamp, &cmd.timestamp, sizeof(uint32));
+		cookUint(timestamp, data);
+		cookString(cmd.cmd, data);
+		cookUint(cmd.args.size(), data);
+		for (uint32 i=0; i < cmd.args.size(); i++)
+			cookString(cmd.args[i], data);
+	}
+
+	//------------------------------------------------------------------------------
+	bool Script::loadCookedCommand(Command& cmd, const byte*& data, const byte* end)
+	{
+		uint32 timestamp, count;
+		if (!loadCookedUint(timestamp, data, end)) return false;
+		memcpy(&cmd.timestamp, &timestamp, sizeof(uint32));
+		cmd.estimatedStart = 0;
+
+		if (!loadCookedString(cmd.cmd, data, end) || !loadCookedUint(count, data, end)) return false;
+
+		// each argument does need at least its length
+		if (count > uint32(end - data) / sizeof(uint32)) return false;
+		cmd.args.resize(count);
+		for (uint32 i=0; i < count; i++)
+			if (!loadCookedString(cmd.args[i], data, end)) return false;
+		return true;
+	}
+
+	//------------------------------------------------------------------------------
+	Result Script::cook(std::vector<byte>& data) const
+	{
+		// the commands are stored as they are after parsing
+		data.clear();
+		cookUint(mLoop, data);
+		cookUint(mTimedCommand.size(), data);
+		for (uint32 i=0; i < mTimedCommand.size(); i++)
+			cookCommand(mTimedCommand[i], data);
+		cookUint(mCommand.size(), data);
+		for (uint32 i=0; i < mCommand.size(); i++)
+			cookCommand(mCommand[i], data);
+		return OK;
+	}
+
+	//------------------------------------------------------------------------------
+	Result Script::loadCooked(const byte* data, size_t size)
+	{
+		const byte* end = data + size;
+		uint32 loop, count;
+		std::vector<Command> timed, seq;
+
+		bool ok = loadCookedUint(loop, data, end) && loadCookedUint(count, data, end);
+		for (uint32 i=0; ok && i < count; i++){
+			timed.push_back(Command());
+			ok = loadCookedCommand(timed.back(), data, end);
+		}
+		ok = ok && loadCookedUint(count, data, end);
+		for (uint32 i=0; ok && i < count; i++){
+			seq.push_back(Command());
+			ok = loadCookedCommand(seq.back(), data, end);
+		}
+
+		if (!ok || data != end){
+			NR_Log(Log::LOG_ENGINE, Log::LL_ERROR, "Script: Cooked script %s is damaged", getResName().c_str());
+			return SCRIPT_PARSE_ERROR;
+		}
+
+		mLoop = loop;
+		mTimedCommand.swap(timed);
+		mCommand.swap(seq);
+		return OK;
+	}
+
 	//------------------------------------------------------------------------------
 	bool Script::setParameter(const std::string& param){
 
@@ -73,11 +73,6 @@ namespace nrEngine{
 
 			// load the script from a string
 			ret = scr->loadFromString(str);
-
-			// now because each script is also a task, we add this script
-			// as a task to the kernel
-			SharedPtr<ITask> task (scr);
-			Kernel::GetSingleton().AddTask(task);
 		}
 		delete fStream;
 
@@ -87,6 +82,51 @@ namespace nrEngine{
 	}
 
 
+	//----------------------------------------------------------------------------------
+	Result ScriptLoader::cookResource(IResource* resource, std::vector<byte>& data)
+	{
+		// only our own scripts could be cooked
+		Script* scr = dynamic_cast<Script*>(resource);
+		if (scr == NULL) return RES_TYPE_NOT_SUPPORTED;
+
+		return scr->cook(data);
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ScriptLoader::loadCookedResource(IResource* resource, const byte* data, size_t size)
+	{
+		// check for errors
+		Result ret = IResourceLoader::loadResource(resource);
+		if (ret != OK) return ret;
+
+		Script* scr = dynamic_cast<Script*>(resource);
+		if (scr == NULL) return RES_TYPE_NOT_SUPPORTED;
+
+		return scr->loadCooked(data, size);
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ScriptLoader::finalizeResource(IResource* resource)
+	{
+		IScript* scr = dynamic_cast<IScript*>(resource);
+		if (scr == NULL) return RES_TYPE_NOT_SUPPORTED;
+
+		// name the task as the resource, so that scripts are unique in the kernel
+		scr->setTaskName(std::string("Script_") + scr->getResName());
+
+		// reloaded scripts are still in the kernel, the kernel must not get
+		// a second pointer owning the same script
+		if (Kernel::GetSingleton().getTaskByName(scr->taskGetName()).get() != NULL)
+			return OK;
+
+		// now because each script is also a task, we add this script
+		// as a task to the kernel
+		SharedPtr<ITask> task (scr);
+		Kernel::GetSingleton().AddTask(task);
+
+		return OK;
+	}
+
 	//----------------------------------------------------------------------------------
 	IResource* ScriptLoader::createResourceInstance(const ::std::string& resourceType, NameValuePairs* params) const
 	{
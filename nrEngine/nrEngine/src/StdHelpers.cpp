@@ -15,6 +15,8 @@
 //----------------------------------------------------------------------------------
 #include "StdHelpers.h"
 
+#include <boost/thread/mutex.hpp>
+
 #include <time.h>
 #if NR_PLATFORM != NR_PLATFORM_WIN32
 #    include <sys/time.h>
@@ -94,5 +96,65 @@ namespace nrEngine{
 		return res;
 	}
 
+	//-------------------------------------------------------------------------
+	// The pool is created at first use, so it could be used by static objects
+	//-------------------------------------------------------------------------
+	InternedString::Pool* InternedString::sPool = NULL;
+
+	static boost::mutex& internMutex()
+	{
+		static boost::mutex* mutex = new boost::mutex();
+		return *mutex;
+	}
+
+	//-------------------------------------------------------------------------
+	InternedString::PoolString* InternedString::acquire(const std::string& str)
+	{
+		if (str.length() == 0) return NULL;
+
+		boost::mutex::scoped_lock lock(internMutex());
+		if (sPool == NULL) sPool = new Pool();
+
+		Pool::iterator it = sPool->find(str);
+		if (it == sPool->end()){
+			PoolString* s = new PoolString();
+			s->str = str;
+			s->refs = 0;
+			it = sPool->insert(Pool::value_type(str, s)).first;
+		}
+		it->second->refs++;
+		return it->second;
+	}
+
+	//-------------------------------------------------------------------------
+	void InternedString::release(PoolString* str)
+	{
+		if (str == NULL) return;
+
+		// other references does keep the string, so the pool is not locked
+		uint32 refs = str->refs.load();
+		while (refs > 1){
+			if (str->refs.compare_exchange_weak(refs, refs - 1)) return;
+		}
+
+		// the last one could be taken again by acquire() in the meantime
+		boost::mutex::scoped_lock lock(internMutex());
+		if (--str->refs > 0) return;
+
+		sPool->erase(str->str);
+		delete str;
+		if (sPool->size() == 0){
+			delete sPool;
+			sPool = NULL;
+		}
+	}
+
+	//-------------------------------------------------------------------------
+	const std::string& InternedString::empty()
+	{
+		static const std::string* str = new std::string();
+		return *str;
+	}
+
 }; // end namespace
 
@@ -0,0 +1,85 @@
+/***************************************************************************
+ *                                                                         *
+ *   (c) Art Tevs, MPI Informatik Saarbruecken                             *
+ *       mailto: <tevs@mpi-sb.mpg.de>                                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+//----------------------------------------------------------------------------------
+// Includes
+//----------------------------------------------------------------------------------
+#include "events/ResourceEvent.h"
+
+namespace nrEngine{
+
+	//----------------------------------------------------------------------------------
+	const char* ResourceLoadedEvent::getFlatType() const
+	{
+		return "ResourceLoadedEvent";
+	}
+
+	//----------------------------------------------------------------------------------
+	uint32 ResourceLoadedEvent::writeFlat(byte* buffer, uint32 size) const
+	{
+		// handle, result, length of the name and the name itself
+		uint32 length = mResName.length();
+		uint32 total = sizeof(ResourceHandle) + sizeof(int32) + sizeof(uint32) + length;
+		if (total > size) return 0;
+
+		int32 result = mResult;
+		memcpy(buffer, &mResHandle, sizeof(ResourceHandle)); buffer += sizeof(ResourceHandle);
+		memcpy(buffer, &result, sizeof(int32)); buffer += sizeof(int32);
+		memcpy(buffer, &length, sizeof(uint32)); buffer += sizeof(uint32);
+		memcpy(buffer, mResName.data(), length);
+
+		return total;
+	}
+
+	//----------------------------------------------------------------------------------
+	Result ResourceLoadedEvent::readFlat(const byte* buffer, uint32 size)
+	{
+		uint32 head = sizeof(ResourceHandle) + sizeof(int32) + sizeof(uint32);
+		if (size < head) return EVENT_NOT_FLAT;
+
+		int32 result = 0;
+		uint32 length = 0;
+		memcpy(&mResHandle, buffer, sizeof(ResourceHandle)); buffer += sizeof(ResourceHandle);
+		memcpy(&result, buffer, sizeof(int32)); buffer += sizeof(int32);
+		memcpy(&length, buffer, sizeof(uint32)); buffer += sizeof(uint32);
+		if (length > size - head) return EVENT_NOT_FLAT;
+
+		mResult = (Result)result;
+		mResName.assign((const char*)buffer, length);
+		return OK;
+	}
+
+	//----------------------------------------------------------------------------------
+	void ResourceEventFactory::fillSupported()
+	{
+		declareSupportedType("ResourceLoadedEvent");
+	}
+
+	//----------------------------------------------------------------------------------
+	SharedPtr<Event> ResourceEventFactory::create(const std::string& eventType)
+	{
+		if (eventType == "ResourceLoadedEvent")
+			return SharedPtr<Event>(new ResourceLoadedEvent("", 0, OK));
+		return SharedPtr<Event>();
+	}
+
+	//----------------------------------------------------------------------------------
+	SharedPtr<Event> ResourceEventFactory::create(EventTypeID eventType)
+	{
+		// there is only one type, so no name has to be compared
+		if (isSupported(eventType))
+			return SharedPtr<Event>(new ResourceLoadedEvent("", 0, OK));
+		return SharedPtr<Event>();
+	}
+
+}; // end namespace
+